@@ -0,0 +1,491 @@
+#ifndef FAST_MATH_H_INCLUDED
+#define FAST_MATH_H_INCLUDED
+
+#include <cmath>
+#include <cfloat>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/* Vectorized transcendental functions over arrays.
+ *
+ * exp: range reduction x = n ln2 + r, |r| <= ln2/2, and a (3,3) Pade
+ * approximation of exp(r) (Cephes), scaled by 2^n. The relative error is
+ * below 2 ulp over the normal range. The SIMD path and the scalar version
+ * (used for the remainder of the arrays) perform the same operations.
+ *
+ * log: x = m 2^e, m in [sqrt(1/2), sqrt(2)), log(m) by a (5,5) rational
+ * approximation of log(1+f) (Cephes). Relative error below 2 ulp for
+ * positive x, log(0) = -inf, negative x give NaN.
+ *
+ * tanh: |x| < 0.625 a (2,3) rational approximation (Cephes), above
+ * 1 - 2/(exp(2|x|) + 1). Relative error below 2 ulp on the whole axis.
+ *
+ * sigmoid: 1/(1 + exp(-x)). Relative error below 3 ulp for x > -709,
+ * below that the result (< 1e-308) is flushed to zero.
+ *
+ * atanh: |x| < 0.5 a (4,5) rational approximation (Cephes), above
+ * log((1+x)/(1-x))/2. Relative error below 2 ulp on (-1,1),
+ * atanh(+-1) = +-inf.
+ *
+ * sin: range reduction x = k pi/2 + r, |r| <= pi/4 (three-part pi/2),
+ * and the polynomials of sin(r) and cos(r) (Cephes), selected by the
+ * quadrant k. Absolute error at most DBL_EPSILON for |x| < 1e8, e.g. angles of
+ * simulations, above and for inf/NaN libm is used.
+ *
+ * The learners select between these and libm per instance (Mode),
+ * arrays of other types than double are converted element-wise.
+ */
+
+namespace fast_math {
+
+/* exact: libm, fast: the approximations of this module */
+enum class Mode { exact, fast };
+
+namespace exp_constants {
+    const double lo    = -745.13; // below: 0
+    const double hi    =  709.78; // above: inf
+    const double log2e =  1.4426950408889634073599;
+    const double c1    =  6.93145751953125E-1;  // ln2 = c1 + c2, n*c1 is exact
+    const double c2    =  1.42860682030941723212E-6;
+    const double p0    =  1.26177193074810590878E-4;
+    const double p1    =  3.02994407707441961300E-2;
+    const double p2    =  9.99999999999999999910E-1;
+    const double q0    =  3.00198505138664455042E-6;
+    const double q1    =  2.52448340349684104192E-3;
+    const double q2    =  2.27265548208155028766E-1;
+    const double q3    =  2.00000000000000000009E0;
+}
+
+namespace log_constants {
+    const double sqrth = 0.70710678118654752440;
+    const double c1    = 0.693359375;               // ln2 = c1 - c2, e*c1 is exact
+    const double c2    = 2.121944400546905827679E-4;
+    const double two54 = 18014398509481984.0;       // scales subnormals
+    const double p0    = 1.01875663804580931796E-4;
+    const double p1    = 4.97494994976747001425E-1;
+    const double p2    = 4.70579119878881725854E0;
+    const double p3    = 1.44989225341610930846E1;
+    const double p4    = 1.79368678507819816313E1;
+    const double p5    = 7.70838733755885391666E0;
+    const double q0    = 1.12873587189167450590E1;  // q(x) is monic
+    const double q1    = 4.52279145837532221105E1;
+    const double q2    = 8.29875266912776603211E1;
+    const double q3    = 7.11544750618563894466E1;
+    const double q4    = 2.31251620126765340583E1;
+}
+
+namespace tanh_constants {
+    const double small = 0.625;
+    const double p0    = -9.64399179425052238628E-1;
+    const double p1    = -9.92877231001918586564E1;
+    const double p2    = -1.61468768441708447952E3;
+    const double q0    =  1.12811678491632931402E2; // q(x) is monic
+    const double q1    =  2.23548839060100448583E3;
+    const double q2    =  4.84406305325125486048E3;
+}
+
+namespace atanh_constants {
+    const double small = 0.5;
+    const double p0    = -8.54074331929669305196E-1;
+    const double p1    =  1.20426861384072379242E1;
+    const double p2    = -4.61252884198732692637E1;
+    const double p3    =  6.54566728676544377376E1;
+    const double p4    = -3.09092539379866942570E1;
+    const double q0    = -1.95638849376911654834E1; // q(x) is monic
+    const double q1    =  1.08938092147140262656E2;
+    const double q2    = -2.49839401325893582852E2;
+    const double q3    =  2.52006675691344555838E2;
+    const double q4    = -9.27277618139601130017E1;
+}
+
+namespace sin_constants {
+    const double max_arg     = 1e8; // above: libm
+    const double two_over_pi = 0.63661977236758134308;
+    const double c1          = 1.57079625129699707031E0;  // pi/2 = c1 + c2 + c3, k*c1 is exact
+    const double c2          = 7.54978941586159635335E-8;
+    const double c3          = 5.39030285815811905290E-15;
+    const double s0          = 1.58962301576546568060E-10;
+    const double s1          = -2.50507477628578072866E-8;
+    const double s2          = 2.75573136213857245213E-6;
+    const double s3          = -1.98412698295895385996E-4;
+    const double s4          = 8.33333333332211858878E-3;
+    const double s5          = -1.66666666666666307295E-1;
+    const double k0          = -1.13585365213876817300E-11;
+    const double k1          = 2.08757008419747316778E-9;
+    const double k2          = -2.75573141792967388112E-7;
+    const double k3          = 2.48015872888517045348E-5;
+    const double k4          = -1.38888888888730564116E-3;
+    const double k5          = 4.16666666666665929218E-2;
+}
+
+/* 2^k for k in [-1022, 1023] */
+inline double pow2(int k) {
+    const uint64_t bits = static_cast<uint64_t>(k + 1023) << 52;
+    double result;
+    std::memcpy(&result, &bits, sizeof(result));
+    return result;
+}
+
+inline double exp(double x)
+{
+    using namespace exp_constants;
+    if (x != x) return x;
+    if (x < lo) return .0;
+    if (x > hi) return INFINITY;
+
+    const int n = static_cast<int>(std::nearbyint(x * log2e));
+    const double nd = n;
+    double r = x - nd * c1;
+    r = r - nd * c2;
+    const double rr = r * r;
+    const double p = r * ((p0 * rr + p1) * rr + p2);
+    const double q = ((q0 * rr + q1) * rr + q2) * rr + q3;
+    const double e = 1.0 + 2.0 * p / (q - p);
+
+    /* scale in two steps, so that results near over- and underflow work */
+    const int n1 = n >> 1;
+    return e * pow2(n1) * pow2(n - n1);
+}
+
+inline double log(double x)
+{
+    using namespace log_constants;
+    if (x != x or x < .0) return NAN;
+    if (x == .0) return -INFINITY;
+    if (x == INFINITY) return x;
+
+    double e = -1022.0;
+    if (x < DBL_MIN) { x *= two54; e -= 54.0; }
+
+    /* split into mantissa in [0.5,1) and exponent */
+    uint64_t bits;
+    std::memcpy(&bits, &x, sizeof(bits));
+    e += static_cast<double>(static_cast<int>(bits >> 52));
+    bits = (bits & 0x000fffffffffffffull) | 0x3fe0000000000000ull;
+    double m;
+    std::memcpy(&m, &bits, sizeof(m));
+
+    if (m < sqrth) { e -= 1.0; m = (m + m) - 1.0; }
+    else           { m = m - 1.0; }
+
+    const double z = m * m;
+    const double p = ((((p0 * m + p1) * m + p2) * m + p3) * m + p4) * m + p5;
+    const double q = ((((m + q0) * m + q1) * m + q2) * m + q3) * m + q4;
+    double y = m * (z * p / q);
+    y = y - e * c2;
+    y = y - 0.5 * z;
+    return (m + y) + e * c1;
+}
+
+inline double tanh(double x)
+{
+    using namespace tanh_constants;
+    const double z = std::abs(x);
+    if (z >= small) {
+        const double r = 1.0 - 2.0 / (exp(z + z) + 1.0);
+        return std::copysign(r, x);
+    }
+    const double s = x * x;
+    const double p = (p0 * s + p1) * s + p2;
+    const double q = ((s + q0) * s + q1) * s + q2;
+    return x + x * (s * p / q);
+}
+
+inline double sigmoid(double x) { return 1.0 / (1.0 + exp(-x)); }
+
+inline double atanh(double x)
+{
+    using namespace atanh_constants;
+    if (std::abs(x) >= small)
+        return 0.5 * log((1.0 + x) / (1.0 - x));
+    const double s = x * x;
+    const double p = (((p0 * s + p1) * s + p2) * s + p3) * s + p4;
+    const double q = ((((s + q0) * s + q1) * s + q2) * s + q3) * s + q4;
+    return x + x * (s * p / q);
+}
+
+inline double sin(double x)
+{
+    using namespace sin_constants;
+    if (not (std::abs(x) <= max_arg)) return std::sin(x);
+    if (x == 0.0) return x; // keeps the sign of zero
+
+    const double k = std::nearbyint(x * two_over_pi);
+    double r = x - k * c1;
+    r = r - k * c2;
+    r = r - k * c3;
+    const double z = r * r;
+    const double ps = ((((s0 * z + s1) * z + s2) * z + s3) * z + s4) * z + s5;
+    const double pc = ((((k0 * z + k1) * z + k2) * z + k3) * z + k4) * z + k5;
+    const double sr = r + r * (z * ps);
+    const double cr = (1.0 - 0.5 * z) + z * (z * pc);
+
+    const int q = static_cast<int>(k);
+    const double y = (q & 1) ? cr : sr;
+    return (q & 2) ? -y : y;
+}
+
+#if defined(__SSE2__)
+namespace detail {
+
+    inline __m128d pow2_pd(__m128i k) { // k in the lower two int32
+        k = _mm_add_epi32(k, _mm_set1_epi32(1023));
+        k = _mm_unpacklo_epi32(k, _mm_setzero_si128());
+        return _mm_castsi128_pd(_mm_slli_epi64(k, 52));
+    }
+
+    inline __m128d exp_pd(__m128d x)
+    {
+        using namespace exp_constants;
+        const __m128d nan_mask  = _mm_cmpunord_pd(x, x);
+        const __m128d zero_mask = _mm_cmplt_pd(x, _mm_set1_pd(lo));
+        const __m128d inf_mask  = _mm_cmpgt_pd(x, _mm_set1_pd(hi));
+        const __m128d xc = _mm_min_pd(_mm_max_pd(x, _mm_set1_pd(lo)), _mm_set1_pd(hi));
+
+        const __m128i n  = _mm_cvtpd_epi32(_mm_mul_pd(xc, _mm_set1_pd(log2e))); // round to nearest
+        const __m128d nd = _mm_cvtepi32_pd(n);
+        __m128d r = _mm_sub_pd(xc, _mm_mul_pd(nd, _mm_set1_pd(c1)));
+        r = _mm_sub_pd(r, _mm_mul_pd(nd, _mm_set1_pd(c2)));
+        const __m128d rr = _mm_mul_pd(r, r);
+
+        __m128d p = _mm_add_pd(_mm_mul_pd(_mm_set1_pd(p0), rr), _mm_set1_pd(p1));
+        p = _mm_mul_pd(r, _mm_add_pd(_mm_mul_pd(p, rr), _mm_set1_pd(p2)));
+        __m128d q = _mm_add_pd(_mm_mul_pd(_mm_set1_pd(q0), rr), _mm_set1_pd(q1));
+        q = _mm_add_pd(_mm_mul_pd(q, rr), _mm_set1_pd(q2));
+        q = _mm_add_pd(_mm_mul_pd(q, rr), _mm_set1_pd(q3));
+        __m128d e = _mm_div_pd(_mm_mul_pd(_mm_set1_pd(2.0), p), _mm_sub_pd(q, p));
+        e = _mm_add_pd(_mm_set1_pd(1.0), e);
+
+        const __m128i n1 = _mm_srai_epi32(n, 1);
+        e = _mm_mul_pd(_mm_mul_pd(e, pow2_pd(n1)), pow2_pd(_mm_sub_epi32(n, n1)));
+
+        e = _mm_andnot_pd(zero_mask, e);
+        e = _mm_or_pd(_mm_andnot_pd(inf_mask, e), _mm_and_pd(inf_mask, _mm_set1_pd(INFINITY)));
+        return _mm_or_pd(_mm_andnot_pd(nan_mask, e), _mm_and_pd(nan_mask, x));
+    }
+
+    inline __m128d select_pd(__m128d mask, __m128d a, __m128d b) { // mask ? a : b
+        return _mm_or_pd(_mm_and_pd(mask, a), _mm_andnot_pd(mask, b));
+    }
+
+    inline __m128d abs_pd(__m128d x) { return _mm_andnot_pd(_mm_set1_pd(-0.0), x); }
+
+    inline __m128d log_pd(__m128d x)
+    {
+        using namespace log_constants;
+        const __m128d one = _mm_set1_pd(1.0);
+        const __m128d nan_mask  = _mm_or_pd(_mm_cmpunord_pd(x, x), _mm_cmplt_pd(x, _mm_setzero_pd()));
+        const __m128d zero_mask = _mm_cmpeq_pd(x, _mm_setzero_pd());
+        const __m128d inf_mask  = _mm_cmpeq_pd(x, _mm_set1_pd(INFINITY));
+
+        const __m128d sub_mask = _mm_cmplt_pd(x, _mm_set1_pd(DBL_MIN));
+        x = select_pd(sub_mask, _mm_mul_pd(x, _mm_set1_pd(two54)), x);
+        __m128d e = _mm_sub_pd(_mm_set1_pd(-1022.0), _mm_and_pd(sub_mask, _mm_set1_pd(54.0)));
+
+        /* split into mantissa in [0.5,1) and exponent */
+        const __m128i bits = _mm_castpd_si128(x);
+        const __m128i k = _mm_shuffle_epi32(_mm_srli_epi64(bits, 52), _MM_SHUFFLE(3, 1, 2, 0));
+        e = _mm_add_pd(e, _mm_cvtepi32_pd(k));
+        __m128d m = _mm_castsi128_pd(_mm_or_si128(_mm_and_si128(bits, _mm_set1_epi64x(0x000fffffffffffffll))
+                                                , _mm_set1_epi64x(0x3fe0000000000000ll)));
+
+        const __m128d small_mask = _mm_cmplt_pd(m, _mm_set1_pd(sqrth));
+        e = _mm_sub_pd(e, _mm_and_pd(small_mask, one));
+        m = _mm_sub_pd(select_pd(small_mask, _mm_add_pd(m, m), m), one);
+
+        const __m128d z = _mm_mul_pd(m, m);
+        __m128d p = _mm_add_pd(_mm_mul_pd(_mm_set1_pd(p0), m), _mm_set1_pd(p1));
+        p = _mm_add_pd(_mm_mul_pd(p, m), _mm_set1_pd(p2));
+        p = _mm_add_pd(_mm_mul_pd(p, m), _mm_set1_pd(p3));
+        p = _mm_add_pd(_mm_mul_pd(p, m), _mm_set1_pd(p4));
+        p = _mm_add_pd(_mm_mul_pd(p, m), _mm_set1_pd(p5));
+        __m128d q = _mm_add_pd(m, _mm_set1_pd(q0));
+        q = _mm_add_pd(_mm_mul_pd(q, m), _mm_set1_pd(q1));
+        q = _mm_add_pd(_mm_mul_pd(q, m), _mm_set1_pd(q2));
+        q = _mm_add_pd(_mm_mul_pd(q, m), _mm_set1_pd(q3));
+        q = _mm_add_pd(_mm_mul_pd(q, m), _mm_set1_pd(q4));
+
+        __m128d y = _mm_mul_pd(m, _mm_div_pd(_mm_mul_pd(z, p), q));
+        y = _mm_sub_pd(y, _mm_mul_pd(e, _mm_set1_pd(c2)));
+        y = _mm_sub_pd(y, _mm_mul_pd(_mm_set1_pd(0.5), z));
+        __m128d r = _mm_add_pd(_mm_add_pd(m, y), _mm_mul_pd(e, _mm_set1_pd(c1)));
+
+        r = select_pd(inf_mask , _mm_set1_pd( INFINITY), r);
+        r = select_pd(zero_mask, _mm_set1_pd(-INFINITY), r);
+        return select_pd(nan_mask, _mm_set1_pd(NAN), r);
+    }
+
+    inline __m128d tanh_pd(__m128d x)
+    {
+        using namespace tanh_constants;
+        const __m128d one = _mm_set1_pd(1.0);
+        const __m128d z = abs_pd(x);
+
+        /* large arguments */
+        const __m128d ez = exp_pd(_mm_add_pd(z, z));
+        __m128d r = _mm_sub_pd(one, _mm_div_pd(_mm_set1_pd(2.0), _mm_add_pd(ez, one)));
+        r = _mm_or_pd(r, _mm_and_pd(x, _mm_set1_pd(-0.0))); // copy sign
+
+        /* small arguments */
+        const __m128d s = _mm_mul_pd(x, x);
+        __m128d p = _mm_add_pd(_mm_mul_pd(_mm_set1_pd(p0), s), _mm_set1_pd(p1));
+        p = _mm_add_pd(_mm_mul_pd(p, s), _mm_set1_pd(p2));
+        __m128d q = _mm_add_pd(s, _mm_set1_pd(q0));
+        q = _mm_add_pd(_mm_mul_pd(q, s), _mm_set1_pd(q1));
+        q = _mm_add_pd(_mm_mul_pd(q, s), _mm_set1_pd(q2));
+        const __m128d t = _mm_add_pd(x, _mm_mul_pd(x, _mm_div_pd(_mm_mul_pd(s, p), q)));
+
+        return select_pd(_mm_cmpge_pd(z, _mm_set1_pd(small)), r, t);
+    }
+
+    inline __m128d sigmoid_pd(__m128d x)
+    {
+        const __m128d one = _mm_set1_pd(1.0);
+        return _mm_div_pd(one, _mm_add_pd(one, exp_pd(_mm_sub_pd(_mm_setzero_pd(), x))));
+    }
+
+    inline __m128d atanh_pd(__m128d x)
+    {
+        using namespace atanh_constants;
+        const __m128d one = _mm_set1_pd(1.0);
+
+        /* large arguments */
+        const __m128d r = _mm_mul_pd(_mm_set1_pd(0.5), log_pd(_mm_div_pd(_mm_add_pd(one, x), _mm_sub_pd(one, x))));
+
+        /* small arguments */
+        const __m128d s = _mm_mul_pd(x, x);
+        __m128d p = _mm_add_pd(_mm_mul_pd(_mm_set1_pd(p0), s), _mm_set1_pd(p1));
+        p = _mm_add_pd(_mm_mul_pd(p, s), _mm_set1_pd(p2));
+        p = _mm_add_pd(_mm_mul_pd(p, s), _mm_set1_pd(p3));
+        p = _mm_add_pd(_mm_mul_pd(p, s), _mm_set1_pd(p4));
+        __m128d q = _mm_add_pd(s, _mm_set1_pd(q0));
+        q = _mm_add_pd(_mm_mul_pd(q, s), _mm_set1_pd(q1));
+        q = _mm_add_pd(_mm_mul_pd(q, s), _mm_set1_pd(q2));
+        q = _mm_add_pd(_mm_mul_pd(q, s), _mm_set1_pd(q3));
+        q = _mm_add_pd(_mm_mul_pd(q, s), _mm_set1_pd(q4));
+        const __m128d t = _mm_add_pd(x, _mm_mul_pd(x, _mm_div_pd(_mm_mul_pd(s, p), q)));
+
+        return select_pd(_mm_cmpge_pd(abs_pd(x), _mm_set1_pd(small)), r, t);
+    }
+
+    inline __m128d sin_pd(__m128d x)
+    {
+        using namespace sin_constants;
+        const __m128i ki = _mm_cvtpd_epi32(_mm_mul_pd(x, _mm_set1_pd(two_over_pi))); // nearest, as nearbyint
+        const __m128d k = _mm_cvtepi32_pd(ki);
+        __m128d r = _mm_sub_pd(x, _mm_mul_pd(k, _mm_set1_pd(c1)));
+        r = _mm_sub_pd(r, _mm_mul_pd(k, _mm_set1_pd(c2)));
+        r = _mm_sub_pd(r, _mm_mul_pd(k, _mm_set1_pd(c3)));
+        const __m128d z = _mm_mul_pd(r, r);
+
+        __m128d ps = _mm_add_pd(_mm_mul_pd(_mm_set1_pd(s0), z), _mm_set1_pd(s1));
+        ps = _mm_add_pd(_mm_mul_pd(ps, z), _mm_set1_pd(s2));
+        ps = _mm_add_pd(_mm_mul_pd(ps, z), _mm_set1_pd(s3));
+        ps = _mm_add_pd(_mm_mul_pd(ps, z), _mm_set1_pd(s4));
+        ps = _mm_add_pd(_mm_mul_pd(ps, z), _mm_set1_pd(s5));
+        __m128d pc = _mm_add_pd(_mm_mul_pd(_mm_set1_pd(k0), z), _mm_set1_pd(k1));
+        pc = _mm_add_pd(_mm_mul_pd(pc, z), _mm_set1_pd(k2));
+        pc = _mm_add_pd(_mm_mul_pd(pc, z), _mm_set1_pd(k3));
+        pc = _mm_add_pd(_mm_mul_pd(pc, z), _mm_set1_pd(k4));
+        pc = _mm_add_pd(_mm_mul_pd(pc, z), _mm_set1_pd(k5));
+        const __m128d sr = _mm_add_pd(r, _mm_mul_pd(r, _mm_mul_pd(z, ps)));
+        const __m128d cr = _mm_add_pd(_mm_sub_pd(_mm_set1_pd(1.0), _mm_mul_pd(_mm_set1_pd(0.5), z)), _mm_mul_pd(z, _mm_mul_pd(z, pc)));
+
+        /* quadrant bits of the lower two int32, spread to the 64 bit lanes */
+        const __m128i kk  = _mm_shuffle_epi32(ki, _MM_SHUFFLE(1,1,0,0));
+        const __m128i one = _mm_set1_epi32(1), two = _mm_set1_epi32(2);
+        const __m128d odd = _mm_castsi128_pd(_mm_cmpeq_epi32(_mm_and_si128(kk, one), one));
+        const __m128d neg = _mm_castsi128_pd(_mm_cmpeq_epi32(_mm_and_si128(kk, two), two));
+        __m128d y = select_pd(odd, cr, sr);
+        y = _mm_xor_pd(y, _mm_and_pd(neg, _mm_set1_pd(-0.0)));
+        y = _mm_or_pd(y, _mm_and_pd(_mm_cmpeq_pd(x, _mm_setzero_pd()), x)); // keeps the sign of zero
+
+        /* large arguments, inf and NaN */
+        const __m128d big = _mm_cmpnle_pd(abs_pd(x), _mm_set1_pd(max_arg));
+        if (_mm_movemask_pd(big)) {
+            double v[2], w[2];
+            _mm_storeu_pd(v, x);
+            _mm_storeu_pd(w, y);
+            for (int i = 0; i < 2; ++i)
+                if (not (std::abs(v[i]) <= max_arg)) w[i] = std::sin(v[i]);
+            y = _mm_loadu_pd(w);
+        }
+        return y;
+    }
+
+} // namespace detail
+#endif
+
+#if defined(__SSE2__)
+#define FAST_MATH_ARRAY_FUNCTION(name)                                   \
+    inline void name(const double* x, double* y, std::size_t n) {        \
+        std::size_t i = 0;                                               \
+        for (; i + 2 <= n; i += 2)                                       \
+            _mm_storeu_pd(y + i, detail::name##_pd(_mm_loadu_pd(x + i))); \
+        for (; i < n; ++i)                                               \
+            y[i] = name(x[i]);                                           \
+    }
+#else
+#define FAST_MATH_ARRAY_FUNCTION(name)                                   \
+    inline void name(const double* x, double* y, std::size_t n) {        \
+        for (std::size_t i = 0; i < n; ++i)                              \
+            y[i] = name(x[i]);                                           \
+    }
+#endif
+
+/* y[i] = f(x[i]), x and y may be the same array */
+FAST_MATH_ARRAY_FUNCTION(exp)
+FAST_MATH_ARRAY_FUNCTION(log)
+FAST_MATH_ARRAY_FUNCTION(tanh)
+FAST_MATH_ARRAY_FUNCTION(sigmoid)
+FAST_MATH_ARRAY_FUNCTION(atanh)
+FAST_MATH_ARRAY_FUNCTION(sin)
+
+#undef FAST_MATH_ARRAY_FUNCTION
+
+/* other types element-wise, e.g. float */
+template <typename T> void exp    (const T* x, T* y, std::size_t n) { for (std::size_t i = 0; i < n; ++i) y[i] = static_cast<T>(exp    (static_cast<double>(x[i]))); }
+template <typename T> void log    (const T* x, T* y, std::size_t n) { for (std::size_t i = 0; i < n; ++i) y[i] = static_cast<T>(log    (static_cast<double>(x[i]))); }
+template <typename T> void tanh   (const T* x, T* y, std::size_t n) { for (std::size_t i = 0; i < n; ++i) y[i] = static_cast<T>(tanh   (static_cast<double>(x[i]))); }
+template <typename T> void sigmoid(const T* x, T* y, std::size_t n) { for (std::size_t i = 0; i < n; ++i) y[i] = static_cast<T>(sigmoid(static_cast<double>(x[i]))); }
+template <typename T> void atanh  (const T* x, T* y, std::size_t n) { for (std::size_t i = 0; i < n; ++i) y[i] = static_cast<T>(atanh  (static_cast<double>(x[i]))); }
+template <typename T> void sin    (const T* x, T* y, std::size_t n) { for (std::size_t i = 0; i < n; ++i) y[i] = static_cast<T>(sin    (static_cast<double>(x[i]))); }
+
+/* selected by mode */
+inline double exp  (double x, Mode mode) { return (mode == Mode::fast) ? exp  (x) : std::exp  (x); }
+inline double tanh (double x, Mode mode) { return (mode == Mode::fast) ? tanh (x) : std::tanh (x); }
+inline double atanh(double x, Mode mode) { return (mode == Mode::fast) ? atanh(x) : std::atanh(x); }
+inline double sin  (double x, Mode mode) { return (mode == Mode::fast) ? sin  (x) : std::sin  (x); }
+
+template <typename T> void exp(const T* x, T* y, std::size_t n, Mode mode) {
+    if (mode == Mode::fast) exp(x, y, n);
+    else for (std::size_t i = 0; i < n; ++i) y[i] = std::exp(x[i]);
+}
+
+template <typename T> void tanh(const T* x, T* y, std::size_t n, Mode mode) {
+    if (mode == Mode::fast) tanh(x, y, n);
+    else for (std::size_t i = 0; i < n; ++i) y[i] = std::tanh(x[i]);
+}
+
+template <typename T> void sigmoid(const T* x, T* y, std::size_t n, Mode mode) {
+    if (mode == Mode::fast) sigmoid(x, y, n);
+    else for (std::size_t i = 0; i < n; ++i) y[i] = T(1) / (T(1) + std::exp(-x[i]));
+}
+
+template <typename T> void atanh(const T* x, T* y, std::size_t n, Mode mode) {
+    if (mode == Mode::fast) atanh(x, y, n);
+    else for (std::size_t i = 0; i < n; ++i) y[i] = std::atanh(x[i]);
+}
+
+template <typename T> void sin(const T* x, T* y, std::size_t n, Mode mode) {
+    if (mode == Mode::fast) sin(x, y, n);
+    else for (std::size_t i = 0; i < n; ++i) y[i] = std::sin(x[i]);
+}
+
+} // namespace fast_math
+
+#endif // FAST_MATH_H_INCLUDED
@@ -0,0 +1,146 @@
+#ifndef MATRIX_H_INCLUDED
+#define MATRIX_H_INCLUDED
+
+#include <new>
+#include <vector>
+#include <cstdlib>
+#include <cassert>
+#include <stdexcept>
+#include <algorithm>
+
+namespace common {
+
+/* allocator for over-aligned storage, e.g. for SIMD loads */
+template <typename T, std::size_t Alignment>
+struct aligned_allocator {
+    typedef T value_type;
+
+    template <typename U> struct rebind { typedef aligned_allocator<U, Alignment> other; };
+
+    aligned_allocator() = default;
+    template <typename U> aligned_allocator(aligned_allocator<U, Alignment> const&) {}
+
+    T* allocate(std::size_t n) {
+        void* ptr = nullptr;
+        if (0 != posix_memalign(&ptr, Alignment, std::max<std::size_t>(1, n * sizeof(T))))
+            throw std::bad_alloc();
+        return static_cast<T*>(ptr);
+    }
+    void deallocate(T* ptr, std::size_t) { free(ptr); }
+
+    template <typename U> bool operator==(aligned_allocator<U, Alignment> const&) const { return true;  }
+    template <typename U> bool operator!=(aligned_allocator<U, Alignment> const&) const { return false; }
+};
+
+
+/* Dense row-major matrix in one contiguous, aligned block.
+ *
+ * Each row starts at an aligned address, hence rows are padded to a
+ * multiple of the alignment ('stride'), padding elements are zero.
+ * Element access m(i,j), m[i][j] and the row and column views are
+ * unchecked in release builds and asserted in debug builds, at(i,j) is
+ * always checked. Copy and move keep the alignment.
+ */
+template <typename T = double>
+class Matrix
+{
+public:
+    static constexpr std::size_t alignment = 32; // bytes
+
+    typedef T value_type;
+    typedef std::vector<T, aligned_allocator<T, alignment>> storage_t;
+
+    /* contiguous row */
+    template <typename Elem_t>
+    class row_view {
+        Elem_t*     ptr;
+        std::size_t len;
+    public:
+        row_view(Elem_t* ptr, std::size_t len) : ptr(ptr), len(len) {}
+        std::size_t size(void) const { return len; }
+        Elem_t& operator[](std::size_t j) const { assert(j < len); return ptr[j]; }
+        Elem_t* data (void) const { return ptr; }
+        Elem_t* begin(void) const { return ptr; }
+        Elem_t* end  (void) const { return ptr + len; }
+    };
+
+    /* strided column */
+    template <typename Elem_t>
+    class col_view {
+        Elem_t*     ptr;
+        std::size_t len;
+        std::size_t stride;
+    public:
+        col_view(Elem_t* ptr, std::size_t len, std::size_t stride) : ptr(ptr), len(len), stride(stride) {}
+        std::size_t size(void) const { return len; }
+        Elem_t& operator[](std::size_t i) const { assert(i < len); return ptr[i * stride]; }
+    };
+
+    Matrix(std::size_t rows, std::size_t cols)
+    : num_rows(rows)
+    , num_cols(cols)
+    , row_stride(padded(cols))
+    , storage(rows * row_stride, T())
+    {
+        assert(rows > 0 and cols > 0);
+    }
+
+    /* element-wise converted copy, e.g. float weights from double */
+    template <typename U>
+    explicit Matrix(Matrix<U> const& other)
+    : Matrix(other.rows(), other.cols())
+    {
+        for (std::size_t i = 0; i < num_rows; ++i)
+            for (std::size_t j = 0; j < num_cols; ++j)
+                (*this)(i,j) = static_cast<T>(other(i,j));
+    }
+
+    std::size_t rows  (void) const { return num_rows;   }
+    std::size_t cols  (void) const { return num_cols;   }
+    std::size_t stride(void) const { return row_stride; }
+    std::size_t size  (void) const { return num_rows;   } // number of rows, like a vector of rows
+
+          T& operator()(std::size_t i, std::size_t j)       { assert(i < num_rows and j < num_cols); return storage[i * row_stride + j]; }
+    const T& operator()(std::size_t i, std::size_t j) const { assert(i < num_rows and j < num_cols); return storage[i * row_stride + j]; }
+
+          T& at(std::size_t i, std::size_t j)       { check(i, j); return storage[i * row_stride + j]; }
+    const T& at(std::size_t i, std::size_t j) const { check(i, j); return storage[i * row_stride + j]; }
+
+    row_view<T>       row(std::size_t i)       { assert(i < num_rows); return row_view<T>      (storage.data() + i * row_stride, num_cols); }
+    row_view<const T> row(std::size_t i) const { assert(i < num_rows); return row_view<const T>(storage.data() + i * row_stride, num_cols); }
+
+    row_view<T>       operator[](std::size_t i)       { return row(i); }
+    row_view<const T> operator[](std::size_t i) const { return row(i); }
+
+    col_view<T>       col(std::size_t j)       { assert(j < num_cols); return col_view<T>      (storage.data() + j, num_rows, row_stride); }
+    col_view<const T> col(std::size_t j) const { assert(j < num_cols); return col_view<const T>(storage.data() + j, num_rows, row_stride); }
+
+          T* data(void)       { return storage.data(); }
+    const T* data(void) const { return storage.data(); }
+
+    void fill(T const& value) {
+        for (std::size_t i = 0; i < num_rows; ++i)
+            std::fill(storage.begin() + i * row_stride, storage.begin() + i * row_stride + num_cols, value);
+    }
+
+private:
+
+    static std::size_t padded(std::size_t cols) {
+        const std::size_t block = std::max<std::size_t>(1, alignment / sizeof(T));
+        return block * ((cols + block - 1) / block);
+    }
+
+    void check(std::size_t i, std::size_t j) const {
+        if (i >= num_rows or j >= num_cols)
+            throw std::out_of_range("Matrix index out of range.");
+    }
+
+    std::size_t num_rows;
+    std::size_t num_cols;
+    std::size_t row_stride;
+    storage_t   storage;
+};
+
+} // namespace common
+
+#endif // MATRIX_H_INCLUDED
@@ -0,0 +1,339 @@
+#ifndef MATRIX_KERNELS_H_INCLUDED
+#define MATRIX_KERNELS_H_INCLUDED
+
+#include <cmath>
+#include <vector>
+#include <cassert>
+#include <common/matrix.h>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/* Dense kernels for the forward and backward passes of the networks.
+ *
+ * The instruction set is selected at compile time (-mavx2, SSE2 is the
+ * x86-64 default), otherwise portable code is used. Only dot products
+ * are reordered (several accumulators), which changes results within
+ * rounding. axpy, the transposed product and the rank-1 update add up in
+ * the same order as the plain loops and give identical results.
+ * All kernels exist for double and float, a float vector holds twice
+ * as many elements.
+ */
+
+namespace common {
+namespace kernel {
+
+inline const char* instruction_set(void) {
+#if defined(__AVX2__)
+    return "AVX2";
+#elif defined(__SSE2__)
+    return "SSE2";
+#else
+    return "portable";
+#endif
+}
+
+/* sum_j a[j] * b[j] */
+inline double dot(const double* a, const double* b, std::size_t n)
+{
+    std::size_t j = 0;
+    double sum;
+#if defined(__AVX2__)
+    __m256d s0 = _mm256_setzero_pd(), s1 = _mm256_setzero_pd();
+    for (; j + 8 <= n; j += 8) {
+        s0 = _mm256_add_pd(s0, _mm256_mul_pd(_mm256_loadu_pd(a + j    ), _mm256_loadu_pd(b + j    )));
+        s1 = _mm256_add_pd(s1, _mm256_mul_pd(_mm256_loadu_pd(a + j + 4), _mm256_loadu_pd(b + j + 4)));
+    }
+    s0 = _mm256_add_pd(s0, s1);
+    const __m128d s = _mm_add_pd(_mm256_castpd256_pd128(s0), _mm256_extractf128_pd(s0, 1));
+    sum = _mm_cvtsd_f64(_mm_add_sd(s, _mm_unpackhi_pd(s, s)));
+#elif defined(__SSE2__)
+    __m128d s0 = _mm_setzero_pd(), s1 = _mm_setzero_pd();
+    for (; j + 4 <= n; j += 4) {
+        s0 = _mm_add_pd(s0, _mm_mul_pd(_mm_loadu_pd(a + j    ), _mm_loadu_pd(b + j    )));
+        s1 = _mm_add_pd(s1, _mm_mul_pd(_mm_loadu_pd(a + j + 2), _mm_loadu_pd(b + j + 2)));
+    }
+    s0 = _mm_add_pd(s0, s1);
+    sum = _mm_cvtsd_f64(_mm_add_sd(s0, _mm_unpackhi_pd(s0, s0)));
+#else
+    double s[4] = {.0, .0, .0, .0};
+    for (; j + 4 <= n; j += 4)
+        for (std::size_t k = 0; k < 4; ++k)
+            s[k] += a[j+k] * b[j+k];
+    sum = (s[0] + s[1]) + (s[2] + s[3]);
+#endif
+    for (; j < n; ++j)
+        sum += a[j] * b[j];
+    return sum;
+}
+
+inline float dot(const float* a, const float* b, std::size_t n)
+{
+    std::size_t j = 0;
+    float sum;
+#if defined(__AVX2__)
+    __m256 s0 = _mm256_setzero_ps(), s1 = _mm256_setzero_ps();
+    for (; j + 16 <= n; j += 16) {
+        s0 = _mm256_add_ps(s0, _mm256_mul_ps(_mm256_loadu_ps(a + j    ), _mm256_loadu_ps(b + j    )));
+        s1 = _mm256_add_ps(s1, _mm256_mul_ps(_mm256_loadu_ps(a + j + 8), _mm256_loadu_ps(b + j + 8)));
+    }
+    s0 = _mm256_add_ps(s0, s1);
+    __m128 s = _mm_add_ps(_mm256_castps256_ps128(s0), _mm256_extractf128_ps(s0, 1));
+    s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+    sum = _mm_cvtss_f32(_mm_add_ss(s, _mm_shuffle_ps(s, s, 1)));
+#elif defined(__SSE2__)
+    __m128 s0 = _mm_setzero_ps(), s1 = _mm_setzero_ps();
+    for (; j + 8 <= n; j += 8) {
+        s0 = _mm_add_ps(s0, _mm_mul_ps(_mm_loadu_ps(a + j    ), _mm_loadu_ps(b + j    )));
+        s1 = _mm_add_ps(s1, _mm_mul_ps(_mm_loadu_ps(a + j + 4), _mm_loadu_ps(b + j + 4)));
+    }
+    s0 = _mm_add_ps(s0, s1);
+    s0 = _mm_add_ps(s0, _mm_movehl_ps(s0, s0));
+    sum = _mm_cvtss_f32(_mm_add_ss(s0, _mm_shuffle_ps(s0, s0, 1)));
+#else
+    float s[4] = {.0f, .0f, .0f, .0f};
+    for (; j + 4 <= n; j += 4)
+        for (std::size_t k = 0; k < 4; ++k)
+            s[k] += a[j+k] * b[j+k];
+    sum = (s[0] + s[1]) + (s[2] + s[3]);
+#endif
+    for (; j < n; ++j)
+        sum += a[j] * b[j];
+    return sum;
+}
+
+/* sum_j a[r*stride + j] * b[j] for the four rows r = 0..3, b is loaded
+   once for all rows. Each row is summed exactly like dot(), hence the
+   results are identical. Accumulators are named, not arrays, to keep
+   them in registers. */
+inline void dot4(const double* a, std::size_t stride, const double* b, std::size_t n, double* sum)
+{
+    const double *a0 = a, *a1 = a + stride, *a2 = a + 2*stride, *a3 = a + 3*stride;
+    std::size_t j = 0;
+#if defined(__AVX2__)
+    __m256d p0 = _mm256_setzero_pd(), p1 = p0, p2 = p0, p3 = p0, q0 = p0, q1 = p0, q2 = p0, q3 = p0;
+    for (; j + 8 <= n; j += 8) {
+        const __m256d b0 = _mm256_loadu_pd(b + j), b1 = _mm256_loadu_pd(b + j + 4);
+        p0 = _mm256_add_pd(p0, _mm256_mul_pd(_mm256_loadu_pd(a0 + j), b0)); q0 = _mm256_add_pd(q0, _mm256_mul_pd(_mm256_loadu_pd(a0 + j + 4), b1));
+        p1 = _mm256_add_pd(p1, _mm256_mul_pd(_mm256_loadu_pd(a1 + j), b0)); q1 = _mm256_add_pd(q1, _mm256_mul_pd(_mm256_loadu_pd(a1 + j + 4), b1));
+        p2 = _mm256_add_pd(p2, _mm256_mul_pd(_mm256_loadu_pd(a2 + j), b0)); q2 = _mm256_add_pd(q2, _mm256_mul_pd(_mm256_loadu_pd(a2 + j + 4), b1));
+        p3 = _mm256_add_pd(p3, _mm256_mul_pd(_mm256_loadu_pd(a3 + j), b0)); q3 = _mm256_add_pd(q3, _mm256_mul_pd(_mm256_loadu_pd(a3 + j + 4), b1));
+    }
+    const __m256d t[4] = { _mm256_add_pd(p0, q0), _mm256_add_pd(p1, q1), _mm256_add_pd(p2, q2), _mm256_add_pd(p3, q3) };
+    for (std::size_t r = 0; r < 4; ++r) {
+        const __m128d s = _mm_add_pd(_mm256_castpd256_pd128(t[r]), _mm256_extractf128_pd(t[r], 1));
+        sum[r] = _mm_cvtsd_f64(_mm_add_sd(s, _mm_unpackhi_pd(s, s)));
+    }
+#elif defined(__SSE2__)
+    __m128d p0 = _mm_setzero_pd(), p1 = p0, p2 = p0, p3 = p0, q0 = p0, q1 = p0, q2 = p0, q3 = p0;
+    for (; j + 4 <= n; j += 4) {
+        const __m128d b0 = _mm_loadu_pd(b + j), b1 = _mm_loadu_pd(b + j + 2);
+        p0 = _mm_add_pd(p0, _mm_mul_pd(_mm_loadu_pd(a0 + j), b0)); q0 = _mm_add_pd(q0, _mm_mul_pd(_mm_loadu_pd(a0 + j + 2), b1));
+        p1 = _mm_add_pd(p1, _mm_mul_pd(_mm_loadu_pd(a1 + j), b0)); q1 = _mm_add_pd(q1, _mm_mul_pd(_mm_loadu_pd(a1 + j + 2), b1));
+        p2 = _mm_add_pd(p2, _mm_mul_pd(_mm_loadu_pd(a2 + j), b0)); q2 = _mm_add_pd(q2, _mm_mul_pd(_mm_loadu_pd(a2 + j + 2), b1));
+        p3 = _mm_add_pd(p3, _mm_mul_pd(_mm_loadu_pd(a3 + j), b0)); q3 = _mm_add_pd(q3, _mm_mul_pd(_mm_loadu_pd(a3 + j + 2), b1));
+    }
+    const __m128d t[4] = { _mm_add_pd(p0, q0), _mm_add_pd(p1, q1), _mm_add_pd(p2, q2), _mm_add_pd(p3, q3) };
+    for (std::size_t r = 0; r < 4; ++r)
+        sum[r] = _mm_cvtsd_f64(_mm_add_sd(t[r], _mm_unpackhi_pd(t[r], t[r])));
+#else
+    for (std::size_t r = 0; r < 4; ++r)
+        sum[r] = dot(a + r*stride, b, n - n % 4); // same blockwise order
+    j = n - n % 4;
+#endif
+    for (; j < n; ++j) {
+        sum[0] += a0[j] * b[j];
+        sum[1] += a1[j] * b[j];
+        sum[2] += a2[j] * b[j];
+        sum[3] += a3[j] * b[j];
+    }
+}
+
+inline void dot4(const float* a, std::size_t stride, const float* b, std::size_t n, float* sum)
+{
+    const float *a0 = a, *a1 = a + stride, *a2 = a + 2*stride, *a3 = a + 3*stride;
+    std::size_t j = 0;
+#if defined(__AVX2__)
+    __m256 p0 = _mm256_setzero_ps(), p1 = p0, p2 = p0, p3 = p0, q0 = p0, q1 = p0, q2 = p0, q3 = p0;
+    for (; j + 16 <= n; j += 16) {
+        const __m256 b0 = _mm256_loadu_ps(b + j), b1 = _mm256_loadu_ps(b + j + 8);
+        p0 = _mm256_add_ps(p0, _mm256_mul_ps(_mm256_loadu_ps(a0 + j), b0)); q0 = _mm256_add_ps(q0, _mm256_mul_ps(_mm256_loadu_ps(a0 + j + 8), b1));
+        p1 = _mm256_add_ps(p1, _mm256_mul_ps(_mm256_loadu_ps(a1 + j), b0)); q1 = _mm256_add_ps(q1, _mm256_mul_ps(_mm256_loadu_ps(a1 + j + 8), b1));
+        p2 = _mm256_add_ps(p2, _mm256_mul_ps(_mm256_loadu_ps(a2 + j), b0)); q2 = _mm256_add_ps(q2, _mm256_mul_ps(_mm256_loadu_ps(a2 + j + 8), b1));
+        p3 = _mm256_add_ps(p3, _mm256_mul_ps(_mm256_loadu_ps(a3 + j), b0)); q3 = _mm256_add_ps(q3, _mm256_mul_ps(_mm256_loadu_ps(a3 + j + 8), b1));
+    }
+    const __m256 t[4] = { _mm256_add_ps(p0, q0), _mm256_add_ps(p1, q1), _mm256_add_ps(p2, q2), _mm256_add_ps(p3, q3) };
+    for (std::size_t r = 0; r < 4; ++r) {
+        __m128 s = _mm_add_ps(_mm256_castps256_ps128(t[r]), _mm256_extractf128_ps(t[r], 1));
+        s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+        sum[r] = _mm_cvtss_f32(_mm_add_ss(s, _mm_shuffle_ps(s, s, 1)));
+    }
+#elif defined(__SSE2__)
+    __m128 p0 = _mm_setzero_ps(), p1 = p0, p2 = p0, p3 = p0, q0 = p0, q1 = p0, q2 = p0, q3 = p0;
+    for (; j + 8 <= n; j += 8) {
+        const __m128 b0 = _mm_loadu_ps(b + j), b1 = _mm_loadu_ps(b + j + 4);
+        p0 = _mm_add_ps(p0, _mm_mul_ps(_mm_loadu_ps(a0 + j), b0)); q0 = _mm_add_ps(q0, _mm_mul_ps(_mm_loadu_ps(a0 + j + 4), b1));
+        p1 = _mm_add_ps(p1, _mm_mul_ps(_mm_loadu_ps(a1 + j), b0)); q1 = _mm_add_ps(q1, _mm_mul_ps(_mm_loadu_ps(a1 + j + 4), b1));
+        p2 = _mm_add_ps(p2, _mm_mul_ps(_mm_loadu_ps(a2 + j), b0)); q2 = _mm_add_ps(q2, _mm_mul_ps(_mm_loadu_ps(a2 + j + 4), b1));
+        p3 = _mm_add_ps(p3, _mm_mul_ps(_mm_loadu_ps(a3 + j), b0)); q3 = _mm_add_ps(q3, _mm_mul_ps(_mm_loadu_ps(a3 + j + 4), b1));
+    }
+    const __m128 t[4] = { _mm_add_ps(p0, q0), _mm_add_ps(p1, q1), _mm_add_ps(p2, q2), _mm_add_ps(p3, q3) };
+    for (std::size_t r = 0; r < 4; ++r) {
+        const __m128 s = _mm_add_ps(t[r], _mm_movehl_ps(t[r], t[r]));
+        sum[r] = _mm_cvtss_f32(_mm_add_ss(s, _mm_shuffle_ps(s, s, 1)));
+    }
+#else
+    for (std::size_t r = 0; r < 4; ++r)
+        sum[r] = dot(a + r*stride, b, n - n % 4); // same blockwise order
+    j = n - n % 4;
+#endif
+    for (; j < n; ++j) {
+        sum[0] += a0[j] * b[j];
+        sum[1] += a1[j] * b[j];
+        sum[2] += a2[j] * b[j];
+        sum[3] += a3[j] * b[j];
+    }
+}
+
+/* y[j] += alpha * x[j] */
+inline void axpy(std::size_t n, double alpha, const double* x, double* y)
+{
+    std::size_t j = 0;
+#if defined(__AVX2__)
+    const __m256d a = _mm256_set1_pd(alpha);
+    for (; j + 4 <= n; j += 4)
+        _mm256_storeu_pd(y + j, _mm256_add_pd(_mm256_loadu_pd(y + j), _mm256_mul_pd(a, _mm256_loadu_pd(x + j))));
+#elif defined(__SSE2__)
+    const __m128d a = _mm_set1_pd(alpha);
+    for (; j + 2 <= n; j += 2)
+        _mm_storeu_pd(y + j, _mm_add_pd(_mm_loadu_pd(y + j), _mm_mul_pd(a, _mm_loadu_pd(x + j))));
+#endif
+    for (; j < n; ++j)
+        y[j] += alpha * x[j];
+}
+
+inline void axpy(std::size_t n, float alpha, const float* x, float* y)
+{
+    std::size_t j = 0;
+#if defined(__AVX2__)
+    const __m256 a = _mm256_set1_ps(alpha);
+    for (; j + 8 <= n; j += 8)
+        _mm256_storeu_ps(y + j, _mm256_add_ps(_mm256_loadu_ps(y + j), _mm256_mul_ps(a, _mm256_loadu_ps(x + j))));
+#elif defined(__SSE2__)
+    const __m128 a = _mm_set1_ps(alpha);
+    for (; j + 4 <= n; j += 4)
+        _mm_storeu_ps(y + j, _mm_add_ps(_mm_loadu_ps(y + j), _mm_mul_ps(a, _mm_loadu_ps(x + j))));
+#endif
+    for (; j < n; ++j)
+        y[j] += alpha * x[j];
+}
+
+/* max_j x[j], n > 0 */
+inline double maximum(const double* x, std::size_t n)
+{
+    assert(n > 0);
+    std::size_t j = 0;
+    double result = x[0];
+#if defined(__AVX2__)
+    if (n >= 4) {
+        __m256d m = _mm256_loadu_pd(x);
+        for (j = 4; j + 4 <= n; j += 4)
+            m = _mm256_max_pd(m, _mm256_loadu_pd(x + j));
+        const __m128d h = _mm_max_pd(_mm256_castpd256_pd128(m), _mm256_extractf128_pd(m, 1));
+        result = _mm_cvtsd_f64(_mm_max_sd(h, _mm_unpackhi_pd(h, h)));
+    }
+#elif defined(__SSE2__)
+    if (n >= 2) {
+        __m128d m = _mm_loadu_pd(x);
+        for (j = 2; j + 2 <= n; j += 2)
+            m = _mm_max_pd(m, _mm_loadu_pd(x + j));
+        result = _mm_cvtsd_f64(_mm_max_sd(m, _mm_unpackhi_pd(m, m)));
+    }
+#endif
+    for (; j < n; ++j)
+        if (x[j] > result) result = x[j];
+    return result;
+}
+
+/* index of the first maximum of x, n > 0 */
+inline std::size_t argmax(const double* x, std::size_t n)
+{
+    const double m = maximum(x, n);
+    std::size_t j = 0;
+    while (j + 1 < n and x[j] != m) ++j;
+    return j;
+}
+
+struct identity { template <typename T> T operator()(T x) const { return x; } };
+struct tanh_fn  { template <typename T> T operator()(T x) const { return std::tanh(x); } };
+
+/* y[i] = f(sum_j A(i,j) x[j]), activation fused into the row loop,
+   four rows at a time share the loads of x */
+template <typename T, typename Activation_t>
+void gemv(Matrix<T> const& A, const T* x, T* y, Activation_t f)
+{
+    std::size_t i = 0;
+    for (; i + 4 <= A.rows(); i += 4) {
+        T sum[4];
+        dot4(A.row(i).data(), A.stride(), x, A.cols(), sum);
+        for (std::size_t r = 0; r < 4; ++r)
+            y[i + r] = f(sum[r]);
+    }
+    for (; i < A.rows(); ++i)
+        y[i] = f(dot(A.row(i).data(), x, A.cols()));
+}
+
+template <typename T>
+void gemv(Matrix<T> const& A, const T* x, T* y) { gemv(A, x, y, identity()); }
+
+/* y[j] = f(sum_i A(i,j) x[i]), accumulated row by row */
+template <typename T, typename Activation_t>
+void gemv_t(Matrix<T> const& A, const T* x, T* y, Activation_t f)
+{
+    for (std::size_t j = 0; j < A.cols(); ++j) y[j] = T(0);
+    for (std::size_t i = 0; i < A.rows(); ++i)
+        axpy(A.cols(), x[i], A.row(i).data(), y);
+    for (std::size_t j = 0; j < A.cols(); ++j) y[j] = f(y[j]);
+}
+
+template <typename T>
+void gemv_t(Matrix<T> const& A, const T* x, T* y) { gemv_t(A, x, y, identity()); }
+
+/* A(i,j) += (alpha * u[i]) * v[j] */
+template <typename T>
+void rank1_update(Matrix<T>& A, typename Matrix<T>::value_type alpha, const T* u, const T* v)
+{
+    for (std::size_t i = 0; i < A.rows(); ++i)
+        axpy(A.cols(), alpha * u[i], v, A.row(i).data());
+}
+
+/* contiguous copy of any indexable input vector in the kernels' scalar
+   type, vectors of that type are used in place */
+template <typename T>
+const T* contiguous(std::vector<T> const& in, std::vector<T>& /*buffer*/) { return in.data(); }
+
+template <typename T, typename Vector_t>
+const T* contiguous(Vector_t const& in, std::vector<T>& buffer) {
+    assert(buffer.size() == in.size());
+    for (std::size_t j = 0; j < in.size(); ++j) buffer[j] = in[j];
+    return buffer.data();
+}
+
+/* same for arrays, e.g. double inputs of float networks */
+template <typename T>
+const T* converted(const T* in, std::size_t /*n*/, std::vector<T>& /*buffer*/) { return in; }
+
+template <typename T, typename U>
+const T* converted(const U* in, std::size_t n, std::vector<T>& buffer) {
+    assert(buffer.size() == n);
+    for (std::size_t j = 0; j < n; ++j) buffer[j] = static_cast<T>(in[j]);
+    return buffer.data();
+}
+
+} // namespace kernel
+} // namespace common
+
+#endif // MATRIX_KERNELS_H_INCLUDED
@@ -1,6 +1,13 @@
 /* modules.cpp */
 
 #include "modules.h"
+#include <common/random_stream.h>
+
+/* stream of the innermost Random_Scope of this thread, if any */
+static thread_local common::Random_Stream* scoped_stream = nullptr;
+
+Random_Scope::Random_Scope(common::Random_Stream& stream) : previous(scoped_stream) { scoped_stream = &stream; }
+Random_Scope::~Random_Scope() { scoped_stream = previous; }
 
 /* sigmoid function */
 double
@@ -101,17 +108,21 @@ random_value(double a, double b)
         b = temp;
     }
     /* generate random value for the given interval */
+    if (scoped_stream) return (b - a) * scoped_stream->uniform() + a;
     return (b - a) * ((double) rand()) / RAND_MAX + a;
 }
 
 unsigned int
 random_index(unsigned int N)
 {
-    if (N > 0) return rand() % N;
-    else return 0;
+    if (N == 0) return 0;
+    if (scoped_stream) return static_cast<unsigned int>(scoped_stream->uniform() * N);
+    return rand() % N;
 }
 
 int random_int(int a, int b) {
+    if (scoped_stream and a != b)
+        return std::min(a, b) + static_cast<int>(scoped_stream->uniform() * (std::max(a, b) - std::min(a, b) + 1));
     if (a < b)
         return (rand() % (b - a + 1)) + a;
     else if (b < a)
@@ -121,7 +132,11 @@ int random_int(int a, int b) {
 
 /* generates a pseudo-random double between 0.0 and 0.999... */
 double
-random_value(void) { return (double) rand() / (double(RAND_MAX) + 1.0); }
+random_value(void) { return scoped_stream ? scoped_stream->uniform() : (double) rand() / (double(RAND_MAX) + 1.0); }
+
+/* second value of the last pair drawn by random_value_norm */
+static double y2;
+static int use_last = 0;
 
 /* normally distributed random value */
 double
@@ -129,11 +144,11 @@ random_value_norm(const double m, const double s, const double min, const double
 {
     /* mean m, standard deviation s */
     double x1, x2, w, y1;
-    static double y2;
-    static int use_last = 0;
 
+    if (scoped_stream) // has its own spare value
+        y1 = scoped_stream->standard_normal();
     /* use value from previous call */
-    if (use_last) {
+    else if (use_last) {
         y1 = y2;
         use_last = 0;
     }
@@ -156,6 +171,9 @@ random_value_norm(const double m, const double s, const double min, const double
     return ret;
 }
 
+/* drops the pending second value of random_value_norm */
+void reset_random_value_norm(void) { use_last = 0; }
+
 /* returns a random vector of size N with values in [a,b]*/
 std::vector<double> random_vector(std::size_t N, double a, double b) {
     std::vector<double> rvec(N);
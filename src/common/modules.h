@@ -94,6 +94,10 @@ double random_value(void);
 /* normally distributed random value */
 double random_value_norm(const double m, const double s, const double min, const double max);
 
+/* drops the pending value of random_value_norm, which draws pairs. Together
+ * with srand() the following normal values are reproduced. */
+void reset_random_value_norm(void);
+
 /* zero mean normal distributed random value with max. 3 sigma */
 inline double rand_norm_zero_mean(double sigma) { return random_value_norm(0.0, sigma, -3*sigma, 3*sigma); }
 
@@ -103,6 +107,23 @@ inline int rand_sign(void) { return (random_index(2) == 0) ? -1 : 1; }
 /* returns a random vector of size N with values in [a,b]*/
 std::vector<double> random_vector(std::size_t N, double a, double b);
 
+namespace common { class Random_Stream; }
+
+/* While a Random_Scope exists, the random functions above draw from the
+ * given stream instead of rand(), in the constructing thread only. E.g.
+ * the initial weights of a predictor then do not depend on when it is
+ * constructed. Scopes may be nested. */
+class Random_Scope {
+public:
+    explicit Random_Scope(common::Random_Stream& stream);
+    ~Random_Scope();
+
+private:
+    Random_Scope(const Random_Scope&) = delete;
+    Random_Scope& operator=(const Random_Scope&) = delete;
+    common::Random_Stream* previous;
+};
+
 /* multiplies matrix by vector */
 void mult_mat_by_vect(double *result_vect, const double *mat, const double *vect, const unsigned int Zeilen, const unsigned int Spalten);
 void mult_mat_by_vect(VectorN& result_vect, const VectorN& mat, const VectorN& vect);
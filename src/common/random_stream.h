@@ -0,0 +1,68 @@
+#ifndef RANDOM_STREAM_H_INCLUDED
+#define RANDOM_STREAM_H_INCLUDED
+
+#include <cmath>
+#include <random>
+#include <cstdint>
+
+namespace common {
+
+/* Deterministic stream of pseudo-random numbers.
+ *
+ * Unlike rand() and the functions in modules.h, each stream has its own
+ * state, so e.g. every expert can draw its noise independent of the order
+ * in which experts are evaluated, also concurrently. Numbers are derived
+ * from the (standardized) 32 bit Mersenne Twister only, hence a seed gives
+ * the same sequence on every platform.
+ */
+class Random_Stream
+{
+public:
+    explicit Random_Stream(uint32_t seed = 5489u) : engine(seed), has_spare(false), spare(.0) {}
+
+    void seed(uint32_t s) { engine.seed(s); has_spare = false; }
+
+    /* uniform in [0,1[ */
+    double uniform(void) { return engine() * (1.0 / 4294967296.0); }
+
+    /* uniform in [a,b[ */
+    double uniform(double a, double b) { return a + (b - a) * uniform(); }
+
+    /* zero mean normal distributed value, limited to 3 sigma
+       like rand_norm_zero_mean() */
+    double normal(double sigma)
+    {
+        const double r = standard_normal() * sigma;
+        const double limit = 3 * std::abs(sigma);
+        return (r < -limit) ? -limit : (r > limit) ? limit : r;
+    }
+
+    /* standard normal distributed value, polar Box-Muller method */
+    double standard_normal(void)
+    {
+        if (has_spare) {
+            has_spare = false;
+            return spare;
+        }
+        double x1, x2, w;
+        do {
+            x1 = 2.0 * uniform() - 1.0;
+            x2 = 2.0 * uniform() - 1.0;
+            w = x1 * x1 + x2 * x2;
+        } while (w >= 1.0 or w == 0.0);
+
+        w = std::sqrt((-2.0 * std::log(w)) / w);
+        spare = x2 * w;
+        has_spare = true;
+        return x1 * w;
+    }
+
+private:
+    std::mt19937 engine;
+    bool         has_spare;
+    double       spare;
+};
+
+} // namespace common
+
+#endif // RANDOM_STREAM_H_INCLUDED
@@ -169,4 +169,24 @@ Socket_Client::recv(unsigned int timeout_us = 0)
     return std::string(buffer);
 }
 
+/* Reads whatever is pending on the socket without waiting. Returns false
+ * if nothing has arrived yet. An empty message with return value true means
+ * the connection was closed or has failed. */
+bool
+Socket_Client::try_recv(std::string& msg)
+{
+    char buffer[constants::msglen];
+    int len = read(sockfd, buffer, constants::msglen);
+
+    if (-1 == len && (EAGAIN == errno || EWOULDBLOCK == errno))
+        return false;
+
+    if (0 < len) msg.assign(buffer, len);
+    else {
+        if (0 > len) wrn_msg("Reading from socket failed: %s", strerror(errno));
+        msg.clear();
+    }
+    return true;
+}
+
 } /* namespace network */
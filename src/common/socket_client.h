@@ -11,6 +11,7 @@
 #include <string.h>
 #include <stdlib.h>
 #include <unistd.h>
+#include <errno.h>
 #include <string>
 #include <fcntl.h>
 #include <netinet/in.h>
@@ -51,12 +52,15 @@ public:
     void close_connection(void);
 
     std::string recv(unsigned int time_out_us);
+    bool try_recv(std::string& msg); /* non-blocking, returns false if no data is pending */
     void send(const char* format, ...); /* sends independent messages immediately */
 
     void append(const char* format, ...);
     void flush();
     void eat(void);
 
+    int get_descriptor(void) const { return sockfd; }
+
 private:
     struct sockaddr_in srv_addr;
     struct hostent *server;
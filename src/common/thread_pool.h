@@ -0,0 +1,133 @@
+#ifndef THREAD_POOL_H_INCLUDED
+#define THREAD_POOL_H_INCLUDED
+
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <functional>
+#include <condition_variable>
+#include <cassert>
+#include <common/lock.h>
+#include <common/log_messages.h>
+
+namespace common {
+
+/**
+ * Persistent pool of worker threads for fork-join loops on the control
+ * cycle. Threads are created once and sleep between jobs, so dispatching
+ * a parallel_for costs a wake-up, not a thread creation.
+ *
+ * The range [0,N) is cut into chunks of 'grain_size' elements, which are
+ * taken from a shared counter by the workers and the calling thread.
+ * Which thread processes which chunk is not deterministic, hence the body
+ * must write its results to disjoint locations and any reduction must be
+ * done afterwards by the caller in a fixed order.
+ */
+class Thread_Pool
+{
+    Thread_Pool(const Thread_Pool& other) = delete;
+    Thread_Pool& operator=(const Thread_Pool& other) = delete;
+
+public:
+    typedef std::function<void(std::size_t /*begin*/, std::size_t /*end*/)> body_t;
+
+    /* number_of_threads includes the calling thread */
+    explicit Thread_Pool(std::size_t number_of_threads = std::thread::hardware_concurrency())
+    : threads()
+    , mtx()
+    , cv_start()
+    , cv_done()
+    , body(nullptr)
+    , range(0)
+    , grain(1)
+    , next_chunk(0)
+    , generation(0)
+    , num_working(0)
+    , quit(false)
+    {
+        if (number_of_threads < 1) number_of_threads = 1;
+        threads.reserve(number_of_threads - 1);
+        for (std::size_t i = 1; i < number_of_threads; ++i)
+            threads.emplace_back(&Thread_Pool::worker_loop, this);
+        dbg_msg("Created thread pool with %u threads.", number_of_threads);
+    }
+
+    ~Thread_Pool() {
+        {
+            lock_t lock(mtx);
+            quit = true;
+        }
+        cv_start.notify_all();
+        for (auto& t : threads) t.join();
+    }
+
+    std::size_t size(void) const { return threads.size() + 1; }
+
+    void parallel_for(std::size_t N, std::size_t grain_size, body_t const& func)
+    {
+        assert(grain_size > 0);
+        if (threads.empty() or N <= grain_size) {
+            if (N > 0) func(0, N);
+            return;
+        }
+        {
+            lock_t lock(mtx);
+            body  = &func;
+            range = N;
+            grain = grain_size;
+            next_chunk.store(0);
+            num_working = threads.size();
+            ++generation;
+        }
+        cv_start.notify_all();
+
+        process_chunks();
+
+        std::unique_lock<mutex_t> lock(mtx);
+        cv_done.wait(lock, [this]{ return 0 == num_working; });
+        body = nullptr;
+    }
+
+private:
+
+    void process_chunks(void) {
+        std::size_t begin;
+        while ((begin = next_chunk.fetch_add(grain)) < range)
+            (*body)(begin, std::min(begin + grain, range));
+    }
+
+    void worker_loop(void) {
+        std::size_t seen_generation = 0;
+        for (;;) {
+            {
+                std::unique_lock<mutex_t> lock(mtx);
+                cv_start.wait(lock, [&]{ return quit or generation != seen_generation; });
+                if (quit) return;
+                seen_generation = generation;
+            }
+            process_chunks();
+            {
+                lock_t lock(mtx);
+                --num_working;
+            }
+            cv_done.notify_one();
+        }
+    }
+
+    std::vector<std::thread>    threads;
+    mutex_t                     mtx;
+    std::condition_variable     cv_start;
+    std::condition_variable     cv_done;
+
+    body_t const*               body;
+    std::size_t                 range;
+    std::size_t                 grain;
+    std::atomic<std::size_t>    next_chunk;
+    std::size_t                 generation;
+    std::size_t                 num_working;
+    bool                        quit;
+};
+
+} // namespace common
+
+#endif // THREAD_POOL_H_INCLUDED
@@ -3,6 +3,8 @@
 
 #include <vector>
 #include <common/log_messages.h>
+#include <common/matrix.h>
+#include <common/matrix_kernels.h>
 #include <robots/robot.h>
 
 
@@ -12,81 +14,139 @@ namespace constants {
     const double initial_bias = 0.1;
 }
 
+/* scalar type of the controllers, float for builds with -DCONTROL_FLOAT32
+   (scons float32=1), e.g. for the Raspberry Pi Zero */
+#ifdef CONTROL_FLOAT32
+typedef float  scalar_t;
+#else
+typedef double scalar_t;
+#endif
+
 inline std::size_t get_number_of_inputs(robots::Robot_Interface const& robot) {
     /* angle, velocity, motor output + xyz-acceleration + bias */
     return 3 * robot.get_number_of_joints() + 3 * robot.get_number_of_accel_sensors() + 1;
 }
 
+template <typename Scalar_t = double>
 struct sym_input {
-    double x,y;
+    Scalar_t x,y;
 
-    sym_input& operator*=(const double& gain)  {
+    sym_input& operator*=(const Scalar_t& gain)  {
         this->x *= gain;
         this->y *= gain;
         return *this;
     }
 };
 
+/* inputs of the controller from the robot's state, shared by all cores
+   of a robot, e.g. prepared once per cycle for many motor experts */
+template <typename Scalar_t>
+void prepare_inputs(robots::Robot_Interface const& robot, Scalar_t gain, std::vector<sym_input<Scalar_t>>& input)
+{
+    assert(input.size() == get_number_of_inputs(robot));
+    auto make_input = [](double x, double y) { return sym_input<Scalar_t>{ static_cast<Scalar_t>(x), static_cast<Scalar_t>(y) }; };
+
+    std::size_t index = 0;
+    for (auto const& jx : robot.get_joints())
+    {
+        auto const& jy = robot.get_joints()[jx.symmetric_joint];
+
+        /**IDEA: consider using a virtual (integrated) angle */
+        input[index++] = make_input(jx.s_ang             , jy.s_ang             );
+        input[index++] = make_input(jx.s_vel             , jy.s_vel             );
+        input[index++] = make_input(jx.motor.get_backed(), jy.motor.get_backed());
+    }
+
+    for (auto const& a : robot.get_accels())
+    {
+        input[index++] = make_input(a.v.x, -a.v.x); // mirror the x-axes
+        input[index++] = make_input(a.v.y, a.v.y);
+        input[index++] = make_input(a.v.z, a.v.z);
+    }
+
+    input[index++] = make_input(constants::initial_bias, constants::initial_bias);
+    assert(index == input.size());
+
+    /* apply input gain */
+    for (auto& i : input)
+        i *= gain;
+}
+
+/* Scalar_t selects the precision of weights, inputs and activations,
+   sensor values and parameters remain double and are converted
+
+   The weights are kept per joint and, for the output computation, in a
+   transposed copy (inputs x joints) whose columns list the normal joints
+   first. Each output reads either all x or all y inputs, so for any mode
+   the columns reading x are a leading block: the outputs are two axpy
+   sweeps per input without branches, and each activation is summed over
+   the inputs in the original order, i.e. bit for bit as before. Whoever
+   changes 'weights' directly must call update_layout() afterwards. */
+template <typename Scalar_t = double>
 class Fully_Connected_Symmetric_Core
 {
 public:
-    std::vector<std::vector<double> > weights;
-    std::vector<sym_input>            input;
-    std::vector<double>               activation;
+    typedef Scalar_t scalar_t;
 
-    double gain = 1.0;
+    std::vector<std::vector<Scalar_t> > weights;
+    std::vector<sym_input<Scalar_t>>    input;
+    std::vector<Scalar_t>               activation;
+
+    Scalar_t gain = 1.0;
 
     Fully_Connected_Symmetric_Core(robots::Robot_Interface const& robot)
-    : weights(robot.get_number_of_joints(), std::vector<double>(get_number_of_inputs(robot), 0.0))
+    : weights(robot.get_number_of_joints(), std::vector<Scalar_t>(get_number_of_inputs(robot), 0.0))
     , input(get_number_of_inputs(robot))
     , activation(robot.get_number_of_joints())
+    , layout(get_number_of_inputs(robot), robot.get_number_of_joints())
+    , joint_of_column(robot.get_number_of_joints())
+    , number_of_normal_joints(0)
+    , input_x(get_number_of_inputs(robot))
+    , input_y(get_number_of_inputs(robot))
+    , sum(robot.get_number_of_joints())
     {
         /*dbg_msg("Fully connected symmetric core.\n\t weights: %u x %u ", weights.size(), weights.at(0).size());*/
         assert(get_number_of_inputs(robot) > 0);
         assert(robot.get_number_of_joints() > 0);
-    }
-
-
-    void prepare_inputs(const robots::Robot_Interface& robot)
-    {
-        std::size_t index = 0;
-        for (auto const& jx : robot.get_joints())
-        {
-            auto const& jy = robot.get_joints()[jx.symmetric_joint];
-
-            /**IDEA: consider using a virtual (integrated) angle */
-            input[index++] = {jx.s_ang             , jy.s_ang             };
-            input[index++] = {jx.s_vel             , jy.s_vel             };
-            input[index++] = {jx.motor.get_backed(), jy.motor.get_backed()};
-        }
 
-        for (auto const& a : robot.get_accels())
-        {
-            input[index++] = {a.v.x, -a.v.x}; // mirror the x-axes
-            input[index++] = {a.v.y, a.v.y};
-            input[index++] = {a.v.z, a.v.z};
-        }
+        robots::Jointvector_t const& joints = robot.get_joints();
+        std::size_t col = 0;
+        for (std::size_t i = 0; i < joints.size(); ++i)
+            if (joints[i].type != robots::Joint_Type_Symmetric)
+                joint_of_column[col++] = i;
+        number_of_normal_joints = col;
+        for (std::size_t i = 0; i < joints.size(); ++i)
+            if (joints[i].type == robots::Joint_Type_Symmetric)
+                joint_of_column[col++] = i;
+        assert(col == joints.size());
+    }
 
-        input[index++] = {constants::initial_bias, constants::initial_bias};
-        assert(index == input.size());
 
-        /* apply input gain */
-        for (auto& i : input)
-            i *= gain;
-    }
+    void prepare_inputs(const robots::Robot_Interface& robot) { control::prepare_inputs(robot, gain, input); }
 
     void update_outputs(const robots::Robot_Interface& robot, bool is_symmetric, bool is_switched)
     {
-        assert(input.size() == weights[0].size());
+        assert(input.size() == layout.rows());
         assert(activation.size() == robot.get_number_of_joints());
         assert(!(is_switched and is_symmetric));
-        for (std::size_t i = 0; i < activation.size(); ++i)
-        {
-            activation[i] = .0;
-            bool swap_inputs = is_switched != (is_symmetric and robot.get_joints()[i].type == robots::Joint_Type_Symmetric);
-            for (std::size_t k = 0; k < input.size(); ++k)
-                activation[i] += weights[i][k] * (swap_inputs ? input[k].y : input[k].x);
+        (void) robot;
+
+        /* symmetric: the symmetric joints read y, switched: all joints read y */
+        const std::size_t N = activation.size();
+        const std::size_t num_x = is_switched ? 0 : (is_symmetric ? number_of_normal_joints : N);
+
+        for (std::size_t k = 0; k < input.size(); ++k) {
+            input_x[k] = input[k].x;
+            input_y[k] = input[k].y;
         }
+        std::fill(sum.begin(), sum.end(), Scalar_t(0));
+        for (std::size_t k = 0; k < input.size(); ++k) {
+            const Scalar_t* w_k = layout.row(k).data();
+            common::kernel::axpy(num_x    , input_x[k], w_k        , sum.data()        );
+            common::kernel::axpy(N - num_x, input_y[k], w_k + num_x, sum.data() + num_x);
+        }
+        for (std::size_t col = 0; col < N; ++col)
+            activation[joint_of_column[col]] = sum[col];
     }
 
     void write_motors(robots::Robot_Interface& robot, bool is_switched)
@@ -107,6 +167,7 @@ public:
                 w_ik = params[param_index++];
 
         assert(param_index == params.size());
+        update_layout();
     }
 
     void apply_symmetric_weights(robots::Robot_Interface const& robot, std::vector<double> const& params)
@@ -128,8 +189,44 @@ public:
             }
         }
         assert(param_index == params.size());
+        update_layout();
+    }
+
+    /* output weights sum_c gain_c * W_c of cores of the same robot with
+       input gain 1, e.g. to fade between controllers in weight space.
+       Only the layout for update_outputs() is blended, 'weights' remain. */
+    void blend_weights(std::vector<Fully_Connected_Symmetric_Core const*> const& cores)
+    {
+        for (std::size_t k = 0; k < layout.rows(); ++k) {
+            Scalar_t* w_k = layout.row(k).data();
+            std::fill(w_k, w_k + layout.cols(), Scalar_t(0));
+            for (auto const* c : cores) {
+                assert(c->layout.rows() == layout.rows() and c->layout.cols() == layout.cols());
+                assert(c->number_of_normal_joints == number_of_normal_joints);
+                common::kernel::axpy(layout.cols(), c->gain, c->layout.row(k).data(), w_k);
+            }
+        }
+        gain = Scalar_t(1);
+    }
+
+    /* transposed copy of the weights for update_outputs() */
+    void update_layout(void)
+    {
+        assert(weights.size() == layout.cols());
+        for (std::size_t col = 0; col < layout.cols(); ++col) {
+            std::vector<Scalar_t> const& w_i = weights[joint_of_column[col]];
+            assert(w_i.size() == layout.rows());
+            for (std::size_t k = 0; k < layout.rows(); ++k)
+                layout(k, col) = w_i[k];
+        }
     }
 
+private:
+    common::Matrix<Scalar_t> layout;          /* inputs x joints, normal joints first */
+    std::vector<std::size_t> joint_of_column;
+    std::size_t              number_of_normal_joints;
+    std::vector<Scalar_t>    input_x, input_y; /* contiguous inputs */
+    std::vector<Scalar_t>    sum;
 };
 
 
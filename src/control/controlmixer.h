@@ -1,25 +1,62 @@
 #ifndef CONTROLMIXER_H
 #define CONTROLMIXER_H
 
+#include <vector>
 #include <control/jointcontrol.h>
 #include <robots/robot.h>
 
 namespace control {
 
+/* Mixes the motor outputs of several controllers by their input gains.
+ *
+ * Controllers with gain 0 are skipped. If several controllers are active,
+ * e.g. during a fade, they are blended in weight space and a single
+ * controller is run with the blended weights, which is the sum of their
+ * outputs unless a motor output is clipped. The blended weights are kept
+ * until the gains, the weights or the active controllers change, see
+ * Jointcontrol::get_weights_version. In exact mode, each active
+ * controller is run instead, e.g. if the outputs saturate. The
+ * acceleration sensors are integrated once per cycle.
+ */
 class Controlmixer {
 
+robots::Robot_Interface&  robot;
 std::vector<Jointcontrol> control;
+Jointcontrol              blended;
+bool                      exact;
+
+/* active controllers, gains and weights the blended weights were made of */
+std::vector<std::size_t>  blended_index;
+std::vector<double>       blended_gain;
+std::vector<std::size_t>  blended_version;
+
+std::vector<std::size_t>  active;
+std::vector<Jointcontrol const*> blended_control;
 
 public:
-    Controlmixer(robots::Robot_Interface& robot, std::size_t num_controller)
-    : control()
+    Controlmixer(robots::Robot_Interface& robot, std::size_t num_controller, bool exact = false)
+    : robot(robot)
+    , control()
+    , blended(robot)
+    , exact(exact)
+    , blended_index()
+    , blended_gain()
+    , blended_version()
+    , active()
+    , blended_control()
     {
+        control.reserve(num_controller);
         for (std::size_t i = 0; i < num_controller; ++i)
             control.emplace_back(robot);
+        active.reserve(num_controller);
     }
 
     std::size_t size(void) const { return control.size(); }
 
+    /* run each active controller, no blending in weight space */
+    void set_exact(bool e) { exact = e; }
+    bool is_exact(void) const { return exact; }
+
     /* 'one-hot' switching */
     void set_active(std::size_t index) {
         for (std::size_t i = 0; i < control.size(); ++i)
@@ -39,10 +76,57 @@ public:
           Jointcontrol& operator[] (std::size_t index)       { return control.at(index); }
     const Jointcontrol& operator[] (std::size_t index) const { return control.at(index); }
 
-    void execute_cycle(void) { for (auto& c: control) c.execute_cycle(); }
+    void execute_cycle(void)
+    {
+        for (auto& a : robot.set_accels()) a.integrate();
+
+        active.clear();
+        for (std::size_t i = 0; i < control.size(); ++i)
+            if (control[i].get_input_gain() > 0.)
+                active.push_back(i);
+
+        if (exact or active.size() < 2 or not same_symmetry()) {
+            for (std::size_t i : active)
+                control[i].update_motors();
+            return;
+        }
+
+        if (blend_changed())
+            blend();
+        blended.update_motors();
+    }
 
     void reset(void) { for (auto& c: control) c.reset(); }
 
+private:
+
+    bool same_symmetry(void) const {
+        for (std::size_t i : active)
+            if (not control[i].has_same_symmetry(control[active[0]])) return false;
+        return true;
+    }
+
+    bool blend_changed(void) const {
+        if (active != blended_index) return true;
+        for (std::size_t n = 0; n < active.size(); ++n)
+            if (control[active[n]].get_input_gain() != blended_gain[n]
+             or control[active[n]].get_weights_version() != blended_version[n])
+                return true;
+        return false;
+    }
+
+    void blend(void) {
+        blended_control.clear();
+        blended_gain.clear();
+        blended_version.clear();
+        for (std::size_t i : active) {
+            blended_control.push_back(&control[i]);
+            blended_gain.push_back(control[i].get_input_gain());
+            blended_version.push_back(control[i].get_weights_version());
+        }
+        blended.set_blended_weights(blended_control);
+        blended_index = active;
+    }
 };
 
 } /* namespace control */
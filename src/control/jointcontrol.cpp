@@ -10,6 +10,7 @@ Jointcontrol::Jointcontrol(robots::Robot_Interface& robot)
 , number_of_params_asym(get_number_of_inputs(robot) * robot.get_number_of_joints())
 , symmetric_controller(false)
 , is_switched(false)
+, weights_version(0)
 {
     sts_msg("Creating joint controller.");
     if (robot.get_number_of_joints() < 1) err_msg(__FILE__, __LINE__, "No motor outputs.");
@@ -29,11 +30,13 @@ Jointcontrol::Jointcontrol(robots::Robot_Interface& robot)
 void
 Jointcontrol::switch_symmetric(bool switched)
 {
+    const bool before = is_switched;
     if (not symmetric_controller)
         is_switched = switched;
     else
         is_switched = false;
     /* switching symmetry does not have any effect on symmetrical controller weights */
+    if (is_switched != before) ++weights_version;
 }
 
 
@@ -87,17 +90,42 @@ void
 Jointcontrol::execute_cycle(void)
 {
     integrate_accels();
+    update_motors();
+}
+
+
+void
+Jointcontrol::update_motors(void)
+{
     core.prepare_inputs(robot);
     core.update_outputs(robot, symmetric_controller, is_switched);
     core.write_motors  (robot, is_switched);
 }
 
 
+void
+Jointcontrol::set_blended_weights(std::vector<Jointcontrol const*> const& controls)
+{
+    assert(not controls.empty());
+    std::vector<Fully_Connected_Symmetric_Core<scalar_t> const*> cores;
+    cores.reserve(controls.size());
+    for (auto const* c : controls) {
+        assert(&c->robot == &robot);
+        assert(c->has_same_symmetry(*controls[0]));
+        cores.push_back(&c->core);
+    }
+    core.blend_weights(cores);
+    symmetric_controller = controls[0]->symmetric_controller;
+    is_switched          = controls[0]->is_switched;
+}
+
+
 void
 Jointcontrol::apply_symmetric_weights(const std::vector<double>& params)
 {
     assert(params.size() == number_of_params_sym);
     core.apply_symmetric_weights(robot, params);
+    ++weights_version;
 }
 
 void
@@ -105,6 +133,7 @@ Jointcontrol::apply_weights(const std::vector<double>& params)
 {
     assert(params.size() == number_of_params_asym);
     core.apply_weights(robot, params);
+    ++weights_version;
 }
 
 void
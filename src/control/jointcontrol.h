@@ -61,6 +61,10 @@ public:
     void execute_cycle(void);
     void reset(void);
 
+    /* motor outputs without integrating the acceleration sensors, for
+       several controllers on one robot, which integrate them once */
+    void update_motors(void);
+
     void insert_motor_command(unsigned index, double value);
 
     void switch_symmetric(bool switched);
@@ -78,10 +82,26 @@ public:
     std::size_t get_number_of_symmetric_parameter(void) const { return number_of_params_sym;  }
 
     bool is_symmetric(void) const { return symmetric_controller; }
+    bool is_mirrored (void) const { return is_switched; }
+
+    bool has_same_symmetry(Jointcontrol const& other) const {
+        return symmetric_controller == other.symmetric_controller and is_switched == other.is_switched;
+    }
+
+    /* changes with every change of the weights or the symmetry, e.g. to
+       detect that weights derived from this controller are outdated */
+    std::size_t get_weights_version(void) const { return weights_version; }
+
+    /* weights of the controllers, weighted by their input gains, and input
+       gain 1, for the motor outputs only, the parameters are not changed.
+       Gives the sum of their motor outputs as long as none is clipped.
+       All controllers must have the same symmetry. */
+    void set_blended_weights(std::vector<Jointcontrol const*> const& controls);
 
     double get_L1_norm(void);
 
     void set_input_gain(double g) { core.gain = clip(g, 0., 1.); }
+    double get_input_gain(void) const { return core.gain; }
 
 private:
 
@@ -90,13 +110,14 @@ private:
     void integrate_accels       (void);
 
     robots::Robot_Interface&          robot;
-    Fully_Connected_Symmetric_Core    core;
+    Fully_Connected_Symmetric_Core<scalar_t> core;
 
     const std::size_t                 number_of_params_sym;
     const std::size_t                 number_of_params_asym;
 
     bool                              symmetric_controller;
     bool                              is_switched;
+    std::size_t                       weights_version;
 
     friend class Jointcontrol_Graphics;
 };
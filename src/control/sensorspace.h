@@ -6,6 +6,7 @@
 #include <queue>
 #include <cassert>
 #include <functional>
+#include <common/matrix.h>
 #include <common/vector_n.h>
 
 /**TODO namespace */
@@ -35,12 +36,44 @@ public:
 };
 
 
+/* read-only view of contiguous sensor values */
+class sensor_span {
+    const double* ptr;
+    std::size_t   len;
+public:
+    sensor_span(const double* ptr, std::size_t len) : ptr(ptr), len(len) {}
+
+    std::size_t size(void) const { return len; }
+    double operator[] (std::size_t index) const { assert(index < len); return ptr[index]; }
+
+    const double* data (void) const { return ptr;       }
+    const double* begin(void) const { return ptr;       }
+    const double* end  (void) const { return ptr + len; }
+};
+
+
+/* Sensor spaces take a snapshot of their values once per cycle, in one
+ * contiguous, aligned block. Consumers read it by values(), without
+ * copies or virtual calls per element. The snapshot is also taken when
+ * the space is constructed and when sensors are added (add_sensor), so
+ * values() only reads and may be called concurrently.
+ */
 class sensor_input_interface {
 public:
+    sensor_input_interface() : snapshot() {}
+
     virtual std::size_t size(void) const = 0;
     virtual VectorN get(void) const = 0;
     virtual ~sensor_input_interface() {}
     virtual double operator[] (std::size_t index) const = 0;
+
+    sensor_span values(void) const {
+        assert(snapshot.size() == size() && "Sensors must be added with add_sensor().");
+        return sensor_span(snapshot.data(), snapshot.size());
+    }
+
+protected:
+    std::vector<double, common::aligned_allocator<double, 32>> snapshot;
 };
 
 
@@ -62,13 +95,17 @@ public:
     : sensor_vector(plain.size())
     {
         for (std::size_t i = 0; i < plain.size(); ++i)
-            sensors.emplace_back(std::to_string(i) , [&plain, i](){ return plain[i]; });
+            add_sensor(std::to_string(i) , [&plain, i](){ return plain[i]; });
     }
 
     virtual ~sensor_vector() { /*dbg_msg("Destroying sensor vector base.");*/ };
 
     void execute_cycle(void) {
-        for (auto& s : sensors) s.execute_cycle();
+        assert(snapshot.size() == sensors.size());
+        for (std::size_t i = 0; i < sensors.size(); ++i) {
+            sensors[i].execute_cycle();
+            snapshot[i] = sensors[i]();
+        }
     }
 
     std::size_t size(void) const { return sensors.size(); }
@@ -82,6 +119,12 @@ public:
             result[i] = sensors[i]();
         return result;
     }
+
+protected:
+    void add_sensor(const std::string& name, std::function<double()> lambda) {
+        sensors.emplace_back(name, lambda);
+        snapshot.push_back(sensors.back()()); // zero until the next cycle
+    }
 };
 
 template <std::size_t NumTaps>
@@ -126,24 +169,20 @@ public:
     {
         //dbg_msg("Creating time-embedded sensors, reserving space for %u delay lines of size %u.", number_of_elements, NumTaps);
         sensors.reserve(number_of_elements);
+        take_snapshot(); // bias only
     }
 
     virtual ~time_embedded_sensors() {};
 
     void execute_cycle(void) {
         for (auto& s : sensors) s.execute_cycle(); // propagate delay lines
+        take_snapshot();
     }
 
     std::size_t size(void) const { return sensors.size()*NumTaps + 1 /*bias*/; }
 
 
-    double operator[] (std::size_t index) const {
-        assert(index < size());
-        const std::size_t i = index/NumTaps; // get buffer index
-        const std::size_t j = index%NumTaps; // get element index
-        if (i >= sensors.size()) return 0.1;
-        return sensors[i][j];
-    }
+    double operator[] (std::size_t index) const { return element(index); }
 
     VectorN get(void) const {
         VectorN result(size());
@@ -152,6 +191,27 @@ public:
         return result;
     }
 
+protected:
+    void add_sensor(const std::string& name, std::function<double()> lambda) {
+        sensors.emplace_back(name, lambda);
+        take_snapshot(); // the bias moves to the end
+    }
+
+private:
+
+    void take_snapshot(void) {
+        snapshot.resize(size());
+        for (std::size_t i = 0; i < snapshot.size(); ++i)
+            snapshot[i] = element(i);
+    }
+
+    double element(std::size_t index) const {
+        assert(index < size());
+        const std::size_t i = index/NumTaps; // get buffer index
+        const std::size_t j = index%NumTaps; // get element index
+        if (i >= sensors.size()) return 0.1;
+        return sensors[i][j];
+    }
 };
 
 #endif // SENSORSPACE_H_INCLUDED
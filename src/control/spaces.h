@@ -26,9 +26,9 @@ public:
     : sensor_vector(3)
     {
         assert(joints.size() == 1);
-        sensors.emplace_back("[1] sin phi" , [&joints](){ return +sin(M_PI * joints[0].s_ang); });
-        sensors.emplace_back("[2] cos phi" , [&joints](){ return -cos(M_PI * joints[0].s_ang); });
-        sensors.emplace_back("[3] velocity", [&joints](){ return +joints[0].s_vel;             });
+        add_sensor("[1] sin phi" , [&joints](){ return +sin(M_PI * joints[0].s_ang); });
+        add_sensor("[2] cos phi" , [&joints](){ return -cos(M_PI * joints[0].s_ang); });
+        add_sensor("[3] velocity", [&joints](){ return +joints[0].s_vel;             });
     }
 };
 
@@ -143,9 +143,9 @@ public:
     GMES_joint_space(const robots::Joint_Model& joint)
     : sensor_vector(3)
     {
-        sensors.emplace_back("[1] angle"    , [&joint](){ return joint.s_ang;       });
-        sensors.emplace_back("[2] velocity" , [&joint](){ return joint.s_vel;       });
-        sensors.emplace_back("[3] torque"   , [&joint](){ return joint.motor.get(); }); //don't even think of removing that
+        add_sensor("[1] angle"    , [&joint](){ return joint.s_ang;       });
+        add_sensor("[2] velocity" , [&joint](){ return joint.s_vel;       });
+        add_sensor("[3] torque"   , [&joint](){ return joint.motor.get(); }); //don't even think of removing that
         /**TODO: Think about: the introduction of the motor signal in the sensor space makes that inherently instable.
          * The adaption can skip the world in the loop and can directly influence the sensor space without actually moving the robot.
          * Also, reducing sensor space dimension reduces the overall cost. */
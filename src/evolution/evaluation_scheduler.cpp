@@ -0,0 +1,157 @@
+#include "evaluation_scheduler.h"
+
+#include <sys/epoll.h>
+#include <unistd.h>
+#include <string.h>
+
+Evaluation_Scheduler::Evaluation_Scheduler(const std::vector<Resumable_Evaluation_Interface*>& evaluations)
+: epoll_fd(epoll_create1(0))
+, workers()
+, jobs()
+, ready()
+, num_busy(0)
+, all_finished(true)
+{
+    if (epoll_fd < 0)
+        err_msg(__FILE__, __LINE__, "Cannot create epoll instance: %s", strerror(errno));
+
+    assert(not evaluations.empty());
+    workers.reserve(evaluations.size());
+    for (auto* e : evaluations) {
+        assert(e != nullptr);
+        workers.emplace_back(Worker{e, -1, false, false});
+    }
+    dbg_msg("Created evaluation scheduler with %u workers.", workers.size());
+}
+
+Evaluation_Scheduler::~Evaluation_Scheduler()
+{
+    close(epoll_fd);
+}
+
+void
+Evaluation_Scheduler::add_job(Fitness_Value& fitness, genome_t& genome, double rand_value)
+{
+    jobs.emplace_back(Job{&fitness, &genome, rand_value});
+}
+
+std::size_t
+Evaluation_Scheduler::get_number_of_active_workers(void) const
+{
+    std::size_t count = 0;
+    for (auto const& w : workers)
+        if (not w.retired) ++count;
+    return count;
+}
+
+bool
+Evaluation_Scheduler::start_next_job(std::size_t w)
+{
+    if (jobs.empty()) return false;
+    const Job job = jobs.front();
+    jobs.pop_front();
+
+    workers[w].evaluation->constrain(*job.genome);
+    workers[w].evaluation->start(*job.fitness, *job.genome, job.rand_value);
+    workers[w].busy = true;
+    ++num_busy;
+    ready.push_back(w);
+    return true;
+}
+
+void
+Evaluation_Scheduler::step(std::size_t w)
+{
+    Worker& worker = workers[w];
+    assert(worker.busy);
+
+    switch (worker.evaluation->resume())
+    {
+        case Evaluation_Status::waiting:
+        {
+            const int fd = worker.evaluation->get_descriptor();
+            if (fd < 0) ready.push_back(w); // cooperative yield only
+            else arm(w, fd);
+            return;
+        }
+        case Evaluation_Status::aborted:
+            wrn_msg("Evaluation of worker %u aborted, retiring it.", w);
+            worker.retired = true;
+            all_finished = false;
+            break;
+
+        case Evaluation_Status::finished:
+            break;
+    }
+
+    /* evaluation done, pick up next job if any */
+    worker.busy = false;
+    --num_busy;
+    if (worker.retired) disarm(w);
+    else if (not start_next_job(w)) disarm(w);
+}
+
+void
+Evaluation_Scheduler::arm(std::size_t w, int fd)
+{
+    Worker& worker = workers[w];
+    if (worker.registered_fd >= 0 and worker.registered_fd != fd)
+        disarm(w);
+
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events   = EPOLLIN | EPOLLONESHOT;
+    ev.data.u64 = w;
+
+    const int op = (worker.registered_fd < 0) ? EPOLL_CTL_ADD : EPOLL_CTL_MOD;
+    if (0 != epoll_ctl(epoll_fd, op, fd, &ev))
+        err_msg(__FILE__, __LINE__, "Cannot register descriptor %d of worker %u: %s", fd, w, strerror(errno));
+    worker.registered_fd = fd;
+}
+
+void
+Evaluation_Scheduler::disarm(std::size_t w)
+{
+    Worker& worker = workers[w];
+    if (worker.registered_fd < 0) return;
+    epoll_ctl(epoll_fd, EPOLL_CTL_DEL, worker.registered_fd, nullptr); // may fail if fd was closed already
+    worker.registered_fd = -1;
+}
+
+bool
+Evaluation_Scheduler::run(void)
+{
+    all_finished = true;
+
+    for (std::size_t w = 0; w < workers.size(); ++w)
+        if (not workers[w].retired and not workers[w].busy)
+            start_next_job(w);
+
+    const int max_events = 64;
+    struct epoll_event events[max_events];
+
+    while (num_busy > 0)
+    {
+        while (not ready.empty()) {
+            const std::size_t w = ready.front();
+            ready.pop_front();
+            step(w);
+        }
+        if (0 == num_busy) break;
+
+        const int n = epoll_wait(epoll_fd, events, max_events, -1);
+        if (n < 0) {
+            if (EINTR == errno) continue;
+            err_msg(__FILE__, __LINE__, "Waiting for evaluations failed: %s", strerror(errno));
+        }
+        for (int i = 0; i < n; ++i)
+            ready.push_back(events[i].data.u64);
+    }
+
+    if (not jobs.empty()) {
+        wrn_msg("No workers left, %u jobs remain unevaluated.", jobs.size());
+        jobs.clear();
+        all_finished = false;
+    }
+    return all_finished;
+}
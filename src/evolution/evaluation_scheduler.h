@@ -0,0 +1,70 @@
+#ifndef EVALUATION_SCHEDULER_H_INCLUDED
+#define EVALUATION_SCHEDULER_H_INCLUDED
+
+#include <vector>
+#include <deque>
+#include <cassert>
+
+#include <common/noncopyable.h>
+#include <common/log_messages.h>
+#include <evolution/individual.h>
+#include <evolution/resumable_evaluation.h>
+
+/**
+ * Event loop, interleaving many resumable evaluations on a single thread.
+ *
+ * Each worker is a resumable evaluation with its own connection (e.g. one
+ * Simloid instance each). Jobs (genome + fitness) are queued and handed to
+ * idle workers. A worker that yields is parked on epoll until its descriptor
+ * becomes readable, so the thread only sleeps when all workers wait for
+ * their simulators. Descriptors of different workers must be distinct.
+ *
+ * A worker that aborts is retired, its job stays unevaluated.
+ */
+class Evaluation_Scheduler : public noncopyable
+{
+public:
+    typedef std::vector<double> genome_t;
+
+    Evaluation_Scheduler(const std::vector<Resumable_Evaluation_Interface*>& workers);
+    ~Evaluation_Scheduler();
+
+    /* fitness and genome must stay valid until run() has returned */
+    void add_job(Fitness_Value& fitness, genome_t& genome, double rand_value);
+
+    /* processes all queued jobs, returns false if any evaluation was aborted */
+    bool run(void);
+
+    std::size_t get_number_of_workers(void) const { return workers.size(); }
+    std::size_t get_number_of_active_workers(void) const;
+    std::size_t get_number_of_jobs   (void) const { return jobs.size(); }
+
+private:
+
+    struct Job {
+        Fitness_Value*  fitness;
+        genome_t*       genome;
+        double          rand_value;
+    };
+
+    struct Worker {
+        Resumable_Evaluation_Interface* evaluation;
+        int  registered_fd; // -1 if not registered with epoll
+        bool busy;
+        bool retired;
+    };
+
+    bool start_next_job(std::size_t w);
+    void step(std::size_t w);
+    void arm(std::size_t w, int fd);
+    void disarm(std::size_t w);
+
+    int                      epoll_fd;
+    std::vector<Worker>      workers;
+    std::deque<Job>          jobs;
+    std::deque<std::size_t>  ready;    // workers to be resumed without waiting
+    std::size_t              num_busy;
+    bool                     all_finished;
+};
+
+#endif // EVALUATION_SCHEDULER_H_INCLUDED
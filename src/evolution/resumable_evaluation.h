@@ -0,0 +1,139 @@
+#ifndef RESUMABLE_EVALUATION_H_INCLUDED
+#define RESUMABLE_EVALUATION_H_INCLUDED
+
+#include <vector>
+#include <poll.h>
+#include <errno.h>
+
+#include <common/log_messages.h>
+#include <evolution/individual.h>
+#include <evolution/evaluation_interface.h>
+
+/**
+ * Resumable evaluation, to be driven as a state machine.
+ *
+ * Instead of owning the thread for a whole rollout, resume() advances the
+ * evaluation until it has to wait for the next sensor frame and returns
+ * 'waiting'. The caller may then do other work (e.g. other evaluations)
+ * until get_descriptor() becomes readable and call resume() again.
+ * A descriptor of -1 means 'nothing to wait for', i.e. the evaluation only
+ * yields cooperatively and can be resumed at any time.
+ *
+ * A typical implementation with a robots::Simloid looks like:
+ *
+ *    Evaluation_Status resume(void) {
+ *        if (not robot.complete_update()) return Evaluation_Status::waiting;
+ *        if (not robot.is_connected())    return Evaluation_Status::aborted;
+ *        ...do one control cycle and fitness step...
+ *        if (done) { fitness.set_value(...); return Evaluation_Status::finished; }
+ *        robot.begin_update();
+ *        return Evaluation_Status::waiting;
+ *    }
+ *    int get_descriptor(void) const { return robot.get_descriptor(); }
+ */
+
+enum class Evaluation_Status {
+    waiting,  // yielded, resume when descriptor is readable
+    finished, // fitness has been written
+    aborted   // no result, e.g. connection lost or user abort
+};
+
+class Resumable_Evaluation_Interface
+{
+public:
+    typedef std::vector<double> genome_t;
+
+    virtual ~Resumable_Evaluation_Interface() = default;
+
+    /* set up a new rollout, fitness and genome must stay valid until finished */
+    virtual void start(Fitness_Value& fitness, const genome_t& genome, double rand_value) = 0;
+    virtual Evaluation_Status resume(void) = 0;
+    virtual int get_descriptor(void) const = 0;
+
+    virtual void prepare_generation(unsigned cur_generation, unsigned max_generation) = 0;
+    virtual void prepare_evaluation(unsigned cur_trial, unsigned max_trial) = 0;
+
+    virtual void constrain(genome_t& /*genome*/) { /* implement optionally */ };
+};
+
+
+/**
+ * Lets an existing blocking evaluation take part in the resumable API.
+ * The whole rollout runs within the first call of resume(), so it never
+ * yields and blocks all other evaluations scheduled on the same thread.
+ */
+class Blocking_Evaluation_Adapter : public Resumable_Evaluation_Interface
+{
+    Evaluation_Interface& evaluation;
+    Fitness_Value*        fitness;
+    const genome_t*       genome;
+    double                rand_value;
+
+public:
+    Blocking_Evaluation_Adapter(Evaluation_Interface& evaluation)
+    : evaluation(evaluation), fitness(nullptr), genome(nullptr), rand_value() {}
+
+    Blocking_Evaluation_Adapter(const Blocking_Evaluation_Adapter& other) = delete;
+    Blocking_Evaluation_Adapter& operator=(const Blocking_Evaluation_Adapter& other) = delete;
+
+    void start(Fitness_Value& f, const genome_t& g, double r) override {
+        fitness = &f;
+        genome  = &g;
+        rand_value = r;
+    }
+
+    Evaluation_Status resume(void) override {
+        assert(fitness != nullptr and genome != nullptr);
+        const bool result = evaluation.evaluate(*fitness, *genome, rand_value);
+        fitness = nullptr;
+        genome  = nullptr;
+        return result ? Evaluation_Status::finished : Evaluation_Status::aborted;
+    }
+
+    int get_descriptor(void) const override { return -1; }
+
+    void prepare_generation(unsigned cur, unsigned max) override { evaluation.prepare_generation(cur, max); }
+    void prepare_evaluation(unsigned cur, unsigned max) override { evaluation.prepare_evaluation(cur, max); }
+    void constrain(genome_t& g) override { evaluation.constrain(g); }
+};
+
+
+/**
+ * Runs a resumable evaluation to completion on the calling thread, so it
+ * can be used wherever an Evaluation_Interface is expected (e.g. by the
+ * existing evolution strategies).
+ */
+class Blocking_Evaluation : public Evaluation_Interface
+{
+    Resumable_Evaluation_Interface& evaluation;
+
+public:
+    Blocking_Evaluation(Resumable_Evaluation_Interface& evaluation) : evaluation(evaluation) {}
+
+    bool evaluate(Fitness_Value& fitness, const genome_t& genome, double rand_value) override {
+        evaluation.start(fitness, genome, rand_value);
+        Evaluation_Status status;
+        while (Evaluation_Status::waiting == (status = evaluation.resume()))
+            if (not wait_for(evaluation.get_descriptor())) return false;
+        return Evaluation_Status::finished == status;
+    }
+
+    void prepare_generation(unsigned cur, unsigned max) override { evaluation.prepare_generation(cur, max); }
+    void prepare_evaluation(unsigned cur, unsigned max) override { evaluation.prepare_evaluation(cur, max); }
+    void constrain(genome_t& genome) override { evaluation.constrain(genome); }
+
+private:
+    static bool wait_for(int fd) {
+        if (fd < 0) return true;
+        struct pollfd pfd = { fd, POLLIN, 0 };
+        int result;
+        do result = poll(&pfd, 1, -1); while (-1 == result and EINTR == errno);
+        if (result < 0) {
+            wrn_msg("Polling evaluation descriptor %d failed.", fd);
+            return false;
+        }
+        return true;
+    }
+};
+
+#endif // RESUMABLE_EVALUATION_H_INCLUDED
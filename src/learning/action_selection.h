@@ -1,11 +1,15 @@
 #ifndef ACTION_SELECTION_H_INCLUDED
 #define ACTION_SELECTION_H_INCLUDED
 
+#include <vector>
+#include <algorithm>
 #include <common/static_vector.h>
+#include <common/random_stream.h>
 #include <common/log_messages.h>
 #include <learning/action_module.h>
 #include <learning/payload.h>
 
+template <typename Vector_t> std::size_t select_from_distribution(Vector_t const& distribution, double x);
 template <typename Vector_t> std::size_t select_from_distribution(Vector_t const& distribution);
 
 class Action_Selection_Base
@@ -21,6 +25,31 @@ protected:
 
     bool                                explorative_selection = false;
 
+    /* own random numbers, e.g. for agents in separate threads, else rand() */
+    bool                                use_stream = false;
+    common::Random_Stream               stream;
+
+    double random_number(void) { return use_stream ? stream.uniform() : random_value(0.0, 1.0); }
+
+    /* Q-values of a state and policy. While other learners write them
+       concurrently, a snapshot taken with relaxed atomics is returned,
+       valid until the next call */
+    bool                                concurrent = false;
+    std::vector<double>                 snapshot;
+
+    const double* read_qvalues(std::size_t state, std::size_t policy) {
+        const double* q = states[state].get_qvalues(policy);
+        if (not concurrent) return q;
+        snapshot.resize(actions.get_number_of_actions());
+        for (std::size_t a = 0; a < snapshot.size(); ++a)
+            snapshot[a] = learning::Q_Tensor::load(q + a);
+        return snapshot.data();
+    }
+
+    std::size_t greedy_action(std::size_t state, std::size_t policy) {
+        return learning::Q_Tensor::argmax(read_qvalues(state, policy), actions);
+    }
+
 public:
     Action_Selection_Base( const static_vector<State_Payload>& states
                          , const Action_Module_Interface&     actions
@@ -37,6 +66,14 @@ public:
 
     bool is_exploring(void) { return explorative_selection; }
 
+    void set_random_stream(uint32_t seed) {
+        stream.seed(seed);
+        use_stream = true;
+    }
+
+    /* Q-values are written by concurrent learners, see SARSA */
+    void enable_concurrent_reads(void) { concurrent = true; }
+
     std::size_t select_randomized(void) {
         selection_probabilities.zero(); // set all zeros
         const double portion = 1.0 / actions.get_number_of_actions_available();
@@ -47,7 +84,7 @@ public:
 
         explorative_selection = true;
 
-        return select_from_distribution(selection_probabilities); // uniform, only available actions
+        return select_from_distribution(selection_probabilities, random_number()); // uniform, only available actions
     }
 
 };
@@ -56,13 +93,12 @@ void print_distribution(const Action_Selection_Base::Vector_t& distribution);
 
 
 /** Selects an index from given discrete probability distribution.
- *  The given distribution must sum up to 1.
+ *  The given distribution must sum up to 1, x is uniform in [0,1[.
  */
 template <typename Vector_t>
 std::size_t
-select_from_distribution(Vector_t const& distribution)
+select_from_distribution(Vector_t const& distribution, double x)
 {
-    const double x = random_value(0.0, 1.0);
     double sum = 0.0;
     for (std::size_t i = 0; i < distribution.size(); ++i)
     {
@@ -76,4 +112,27 @@ select_from_distribution(Vector_t const& distribution)
     assert(false);
 }
 
+template <typename Vector_t>
+std::size_t
+select_from_distribution(Vector_t const& distribution) { return select_from_distribution(distribution, random_value(0.0, 1.0)); }
+
+/** Selects an index given the cumulative sums of a discrete probability
+ *  distribution, by binary search. Same choice as select_from_distribution
+ *  for the same random number.
+ */
+template <typename Vector_t>
+std::size_t
+select_from_cumulative(Vector_t const& cumulative, double x)
+{
+    assert(cumulative.size() > 0);
+    auto it = std::upper_bound(cumulative.begin(), cumulative.end(), x);
+    if (it == cumulative.end()) // x above the rounded total, take the last non-zero
+        it = std::lower_bound(cumulative.begin(), cumulative.end(), cumulative.back());
+    return std::distance(cumulative.begin(), it);
+}
+
+template <typename Vector_t>
+std::size_t
+select_from_cumulative(Vector_t const& cumulative) { return select_from_cumulative(cumulative, random_value(0.0, 1.0)); }
+
 #endif // ACTION_SELECTION_H_INCLUDED
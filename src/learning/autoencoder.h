@@ -2,7 +2,8 @@
 #define AUTOENCODER_H_INCLUDED
 
 #include <common/modules.h>
-#include <common/static_vector.h>
+#include <common/matrix.h>
+#include <common/matrix_kernels.h>
 #include <control/sensorspace.h>
 
 
@@ -10,7 +11,7 @@ namespace learning {
 
 class Autoencoder {
     typedef VectorN vector_t;
-    typedef copyable_static_vector<copyable_static_vector<double>> matrix_t;
+    typedef common::Matrix<double> matrix_t;
 
 public:
     Autoencoder( const std::size_t input_size
@@ -19,14 +20,16 @@ public:
     : hidden(hidden_size)
     , outputs(input_size)
     , delta(outputs.size())
+    , input_buffer(input_size)
+    , hidden_buffer(hidden_size)
     , weights(hidden.size(), input_size)
     {
         dbg_msg("Creating Autoencoder with %u inputs and %u hidden units.", input_size, hidden_size);
         assertion(hidden_size > 0, "Hidden layer must have min. size of 1 (currently=%u)", hidden_size);
         assertion(input_size > hidden_size, "Input size (%u) must be greater than hidden layer size (%u).", input_size, hidden_size);
 
-        assert(weights.size() == hidden_size);
-        assert(weights[0].size() == input_size);
+        assert(weights.rows() == hidden_size);
+        assert(weights.cols() == input_size);
         assert(outputs.size() == input_size);
 
         if (random_weight_range == 0.0)
@@ -52,12 +55,7 @@ public:
         assert(inputs.size() == outputs.size());
 
         /* encoder */
-        for (std::size_t i = 0; i < hidden.size(); ++i) {
-            double act = 0.;
-            for (std::size_t j = 0; j < inputs.size(); ++j)
-                act += weights[i][j] * inputs[j];
-            hidden[i] = tanh(act);
-        }
+        common::kernel::gemv(weights, common::kernel::contiguous(inputs, input_buffer), hidden.data(), common::kernel::tanh_fn());
     }
 
     template <typename InputVector_t>
@@ -65,15 +63,10 @@ public:
     {
         assert(hidden_input.size() == hidden.size());
 
-        /* decoder*/
-        for (std::size_t j = 0; j < outputs.size(); ++j) {
-            double act = 0.;
-            for (std::size_t i = 0; i < hidden_input.size(); ++i)
-                act += weights[i][j] * hidden_input[i];
-            outputs[j] = tanh(act);
-            /** TODO: The decoder should not use the tanh activation function.
-                This must also be considered in the weight change. */
-        }
+        /* decoder, transposed weights */
+        common::kernel::gemv_t(weights, common::kernel::contiguous(hidden_input, hidden_buffer), outputs.data(), common::kernel::tanh_fn());
+        /** TODO: The decoder should not use the tanh activation function.
+            This must also be considered in the weight change. */
     }
 
 
@@ -105,13 +98,14 @@ public:
 
         for (std::size_t i = 0; i < hidden.size(); ++i)
         {
+            double* w_i = weights.row(i).data();
             double error_i = .0;
             for (std::size_t j = 0; j < outputs.size(); ++j)
-                error_i += delta[j] * weights[i][j];
+                error_i += delta[j] * w_i[j];
 
             const double delta_i = error_i * tanh_(hidden[i]);
             for (std::size_t j = 0; j < outputs.size(); ++j)
-                weights[i][j] += learning_rate * (delta_i * inputs[j] + delta[j] * hidden[i]);
+                w_i[j] += learning_rate * (delta_i * inputs[j] + delta[j] * hidden[i]);
         }
     }
 
@@ -121,12 +115,12 @@ public:
 
     void randomize_weight_matrix(const double random_weight_range) {
         assert_in_range(random_weight_range, 0.0, 0.5);
-        const double normed_std_dev = random_weight_range / sqrt(weights[0].size());
+        const double normed_std_dev = random_weight_range / sqrt(weights.cols());
         assert(normed_std_dev != 0.0);
 
-        for (std::size_t i = 0; i < weights.size(); ++i) {
-            for (std::size_t j = 0; j < weights[i].size(); ++j)
-                weights[i][j] = rand_norm_zero_mean(normed_std_dev); // normalized by sqrt(N), N:#inputs
+        for (std::size_t i = 0; i < weights.rows(); ++i) {
+            for (std::size_t j = 0; j < weights.cols(); ++j)
+                weights(i,j) = rand_norm_zero_mean(normed_std_dev); // normalized by sqrt(N), N:#inputs
         }
     }
 
@@ -164,6 +158,8 @@ private:
     vector_t hidden;
     vector_t outputs;
     vector_t delta;
+    vector_t input_buffer;
+    vector_t hidden_buffer;
     matrix_t weights;
 };
 
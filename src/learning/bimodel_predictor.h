@@ -56,7 +56,7 @@ public:
 
     double predict(void) override {
         mod.propagate_forward(ctrl_context);
-        mod.propagate_inverse(input);
+        mod.propagate_inverse(input.values());
 
         return calculate_prediction_error();
     };
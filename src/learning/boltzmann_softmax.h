@@ -2,6 +2,9 @@
 #define BOLTZMANN_SOFTMAX_H_INCLUDED
 
 #include <vector>
+#include <algorithm>
+#include <common/matrix_kernels.h>
+#include <common/fast_math.h>
 #include <common/static_vector.h>
 #include <common/log_messages.h>
 #include <learning/action_selection.h>
@@ -13,19 +16,50 @@ class Boltzmann_Softmax : public Action_Selection_Base
     /** TODO this does not work for non-existing actions,
      ** rethink variably sized action space, this makes EVERYTHING way too complicated */
 
-    template <typename VectorType>
-    static void boltzmann_layer(VectorType& output, const VectorType& input, const double inv_temp) {
-        assert(output.size() == input.size());
-        assert(output.size() > 0);
+    fast_math::Mode math_mode = fast_math::Mode::exact;
+
+    /* distribution of one state and policy, valid as long as the Q-values
+       are the ones it was computed from */
+    struct Cached_Distribution {
+        std::vector<double> qvalues;
+        std::vector<double> probabilities;
+        std::vector<double> cumulative;
+
+        bool holds(const double* q, std::size_t n) const {
+            return qvalues.size() == n and std::equal(qvalues.begin(), qvalues.end(), q);
+        }
+    };
+
+    const std::size_t                number_of_policies;
+    std::vector<Cached_Distribution> cache; // [state][policy]
+
+    /* single pass: max-subtracted, one exp per action */
+    static void boltzmann_layer(double* output, const double* input, std::size_t n, const double inv_temp, fast_math::Mode mode) {
+        assert(n > 0);
+        const double maxq = common::kernel::maximum(input, n);
+        for (std::size_t i = 0; i < n; ++i)
+            output[i] = inv_temp * (input[i] - maxq);
+        fast_math::exp(output, output, n, mode);
 
-        const double maxq = input.get_max();
         double sum = .0;
-        for (std::size_t i = 0; i < input.size(); ++i)
-            sum += exp(inv_temp * (input[i] - maxq));
+        for (std::size_t i = 0; i < n; ++i)
+            sum += output[i];
 
         assert(sum > .0);
-        for (std::size_t i = 0; i < input.size(); ++i)
-            output[i] = exp(inv_temp * (input[i] - maxq)) / sum;
+        for (std::size_t i = 0; i < n; ++i)
+            output[i] /= sum;
+    }
+
+    void update(Cached_Distribution& dist, const double* q, std::size_t n, const double inv_temp) const {
+        dist.qvalues.assign(q, q + n);
+        dist.probabilities.resize(n);
+        dist.cumulative.resize(n);
+        boltzmann_layer(dist.probabilities.data(), q, n, inv_temp, math_mode);
+        double sum = .0;
+        for (std::size_t i = 0; i < n; ++i) {
+            sum += dist.probabilities[i];
+            dist.cumulative[i] = sum;
+        }
     }
 
 public:
@@ -33,6 +67,8 @@ public:
                      , const Action_Module_Interface&     actions
                      , const double              exploration_rate )
     : Action_Selection_Base(states, actions, exploration_rate)
+    , number_of_policies(states[0].policies.size())
+    , cache(states.size() * number_of_policies)
     {
         dbg_msg("Creating 'Boltzmann/Softmax' action selection.");
         assert_in_range(exploration_rate, 0.01, 0.99);
@@ -65,14 +101,28 @@ public:
 //        dbg_msg("End Testing of Boltzmann/Softmax Module");
     }
 
+    void set_math_mode(fast_math::Mode mode) {
+        if (math_mode != mode)
+            cache.assign(cache.size(), Cached_Distribution{});
+        math_mode = mode;
+    }
+
     std::size_t select_action(std::size_t current_state, std::size_t current_policy)
     {
         assert(actions.get_number_of_actions_available() > 1);
+        assert(current_policy < number_of_policies);
         double inv_temp = 1.0;//TODO
-        boltzmann_layer(selection_probabilities, states[current_state].policies[current_policy].qvalues, inv_temp);
+
+        /* recompute the distribution only if the Q-values have changed */
+        const double* qvalues = read_qvalues(current_state, current_policy);
+        const std::size_t n = actions.get_number_of_actions();
+        Cached_Distribution& dist = cache.at(current_state * number_of_policies + current_policy);
+        if (not dist.holds(qvalues, n))
+            update(dist, qvalues, n, inv_temp);
+        selection_probabilities = dist.probabilities;
 
         /* create random variable and select */
-        return select_from_distribution(selection_probabilities);
+        return select_from_cumulative(dist.cumulative, random_number());
     }
 };
 
@@ -6,18 +6,26 @@
 
 /** TODO: visualize traces by displaying the max trace per state.
  */
+/* Eligibility trace of one state and action, a reference to the trace
+ * in the Q tensor. Assigning copies the trace value.
+ * The trace is stored in units of a scale, which the learner decays for
+ * all traces at once, i.e. the trace is value * scale. */
 class Eligibility
 {
-    double value;
+    double& value;
 
 public:
-    Eligibility()
-    : value(0.0)
+    explicit Eligibility(double& value)
+    : value(value)
     {}
 
-    void decay(float factor)       { value *= factor; }
-    void reset(void)       { value = 1.0;  }
-    double get(void) const { assert(in_range(value, 0.0, 1.0)); return value; }
+    Eligibility(const Eligibility& other) = default;
+    Eligibility& operator=(const Eligibility& other) { value = other.value; return *this; }
+
+    void decay(double factor)      { value *= factor; }
+    void reset(double scale = 1.0) { value = 1.0 / scale; }
+    void clear(void)               { value = 0.0; }
+    double get(double scale = 1.0) const { assert(in_range(value * scale, 0.0, 1.0 + 1e-12)); return value * scale; }
 
     friend std::ostream& operator<< (std::ostream& os, const Eligibility& e);
 };
@@ -47,10 +47,10 @@ private:
 public:
     std::size_t select_action(std::size_t current_state, std::size_t current_policy) override
     {
-        update_distribution(states[current_state].policies[current_policy].get_argmax_q());
+        update_distribution(greedy_action(current_state, current_policy));
 
         /* create random variable and select */
-        return select_from_distribution(selection_probabilities);
+        return select_from_distribution(selection_probabilities, random_number());
     }
 };
 
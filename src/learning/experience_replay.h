@@ -0,0 +1,346 @@
+#ifndef EXPERIENCE_REPLAY_H_INCLUDED
+#define EXPERIENCE_REPLAY_H_INCLUDED
+
+#include <cmath>
+#include <memory>
+#include <vector>
+#include <cstdint>
+#include <cassert>
+#include <algorithm>
+#include <functional>
+
+namespace learning {
+
+/* Slab of replay samples shared by several replay buffers, e.g. by all
+ * experts of one expert vector.
+ *
+ * Samples of one dimension are rows of one contiguous block, buffers
+ * hold lists of row indices. Rows are handed out in consecutive runs
+ * where possible and recycled on release. Rows are reference counted
+ * for copy-on-write sharing between buffers. Samples are stored either as
+ * doubles or quantized to 16 bit integers with a per-dimension scale,
+ * i.e. x = scale[m] * q, which takes a quarter of the memory. Quantized
+ * values are clipped to the given range per dimension ([-1,+1] by default),
+ * the quantization error is at most scale[m]/2 = range[m]/65534.
+ * Allocation and release are not thread-safe.
+ */
+class Experience_Pool
+{
+    const double int16_limit = 32767.0;
+
+public:
+    enum class Storage { exact, int16 };
+
+    typedef uint32_t index_t;
+
+    Experience_Pool( std::size_t                dimension
+                   , Storage                    storage = Storage::exact
+                   , std::vector<double> const& range   = {}
+                   , std::size_t                reserved_rows = 0 )
+    : dim(dimension)
+    , storage(storage)
+    , scale(dimension, 1.0)
+    , values()
+    , quantized()
+    , references()
+    , free_rows()
+    , number_of_rows(0)
+    {
+        assert(dimension > 0);
+        assert(range.empty() or range.size() == dimension);
+        if (storage == Storage::int16) {
+            for (std::size_t m = 0; m < dim; ++m) {
+                const double r = range.empty() ? 1.0 : range[m];
+                assert(r > 0.);
+                scale[m] = r / int16_limit;
+            }
+            quantized.reserve(reserved_rows * dim);
+        } else
+            values.reserve(reserved_rows * dim);
+        references.reserve(reserved_rows);
+    }
+
+    std::size_t dimension  (void) const { return dim; }
+    Storage     get_storage(void) const { return storage; }
+    std::size_t capacity   (void) const { return number_of_rows; }
+    std::size_t rows_in_use(void) const { return number_of_rows - free_rows.size(); }
+
+    /* memory of the sample slab */
+    std::size_t bytes(void) const { return values.capacity() * sizeof(double) + quantized.capacity() * sizeof(int16_t); }
+
+    /* value of one unit of the raw (stored) representation */
+    double get_scale(std::size_t m) const { assert(m < dim); return scale[m]; }
+
+    /* n zero initialized rows, lowest free rows first */
+    std::vector<index_t> allocate(std::size_t n)
+    {
+        std::vector<index_t> rows;
+        rows.reserve(n);
+        while (rows.size() < n and not free_rows.empty())
+            rows.push_back(pop_free_row());
+
+        if (rows.size() < n) {
+            const std::size_t new_rows = n - rows.size();
+            for (std::size_t i = 0; i < new_rows; ++i)
+                rows.push_back(number_of_rows + i);
+            resize(number_of_rows + new_rows);
+        }
+        for (index_t row : rows)
+            initialize_row(row);
+        std::sort(rows.begin(), rows.end());
+        return rows;
+    }
+
+    index_t allocate_row(void)
+    {
+        index_t row;
+        if (free_rows.empty()) {
+            row = number_of_rows;
+            resize(number_of_rows + 1);
+        } else
+            row = pop_free_row();
+        initialize_row(row);
+        return row;
+    }
+
+    /* Rows are reference counted, so buffers may share rows, e.g. of a
+     * cloned expert. Shared rows must not be written, see is_shared(). */
+    void share(std::vector<index_t> const& rows) {
+        for (index_t row : rows) {
+            assert(references[row] > 0);
+            ++references[row];
+        }
+    }
+
+    bool is_shared(index_t row) const { assert(row < number_of_rows); return references[row] > 1; }
+
+    void release_row(index_t row)
+    {
+        assert(row < number_of_rows and references[row] > 0);
+        if (--references[row] == 0) {
+            free_rows.push_back(row);
+            std::push_heap(free_rows.begin(), free_rows.end(), std::greater<index_t>());
+        }
+    }
+
+    void release(std::vector<index_t> const& rows) {
+        for (index_t row : rows)
+            release_row(row);
+    }
+
+    /* stored value in units of the scale */
+    double raw(index_t row, std::size_t m) const {
+        assert(row < number_of_rows and m < dim);
+        return (storage == Storage::exact) ? values[row * dim + m] : quantized[row * dim + m];
+    }
+
+    double get(index_t row, std::size_t m) const { return scale[m] * raw(row, m); }
+
+    /* store a value and return its raw representation */
+    double store(index_t row, std::size_t m, double value)
+    {
+        assert(row < number_of_rows and m < dim);
+        if (storage == Storage::exact)
+            return values[row * dim + m] = value;
+
+        const double q = std::round(std::max(-int16_limit, std::min(int16_limit, value / scale[m])));
+        quantized[row * dim + m] = static_cast<int16_t>(q);
+        return q;
+    }
+
+private:
+
+    index_t pop_free_row(void) {
+        std::pop_heap(free_rows.begin(), free_rows.end(), std::greater<index_t>());
+        const index_t row = free_rows.back();
+        free_rows.pop_back();
+        return row;
+    }
+
+    void resize(std::size_t rows) {
+        number_of_rows = rows;
+        references.resize(rows, 0);
+        values.resize(storage == Storage::exact ? rows * dim : 0);
+        quantized.resize(storage == Storage::int16 ? rows * dim : 0);
+    }
+
+    void initialize_row(index_t row) {
+        assert(references[row] == 0);
+        references[row] = 1;
+        for (std::size_t m = 0; m < dim; ++m)
+            store(row, m, .0);
+    }
+
+    const std::size_t     dim;
+    const Storage         storage;
+    std::vector<double>   scale;
+    std::vector<double>   values;
+    std::vector<int16_t>  quantized;
+    std::vector<uint32_t> references;
+    std::vector<index_t>  free_rows;  // min-heap
+    std::size_t           number_of_rows;
+};
+
+
+/* Replay buffer of input samples.
+ *
+ * The samples live in an experience pool, either a private one or one
+ * shared with other buffers. Additionally the buffer keeps the sum of
+ * all samples per input dimension, updated on every replacement.
+ * Learners whose update is linear in the samples (e.g. the simple
+ * predictor moving towards their mean) read these sums in O(input dim)
+ * instead of O(buffer size * input dim). Sums are kept in the pool's raw
+ * units: for quantized storage they are sums of integers and exact, for
+ * doubles they pick up rounding errors and are therefore recomputed
+ * after every 'size' replacements.
+ * Assigning a buffer of the same pool is copy-on-write: both buffers
+ * share the rows, a shared row is detached when it is written the next
+ * time. Cloning thus costs O(size) for the indices instead of
+ * O(size * dim), and replacing a sample stays O(dim).
+ */
+class Experience_Replay
+{
+public:
+
+    /* read-only view of one sample */
+    class sample_t {
+        Experience_Pool const&   pool;
+        Experience_Pool::index_t row;
+    public:
+        sample_t(Experience_Pool const& pool, Experience_Pool::index_t row) : pool(pool), row(row) {}
+        std::size_t size(void) const { return pool.dimension(); }
+        double operator[](std::size_t m) const { return pool.get(row, m); }
+    };
+
+    /* private pool */
+    Experience_Replay(std::size_t number_of_samples, std::size_t dimension)
+    : Experience_Replay(number_of_samples, std::make_shared<Experience_Pool>(dimension, Experience_Pool::Storage::exact, std::vector<double>{}, number_of_samples))
+    {}
+
+    /* shared pool */
+    Experience_Replay(std::size_t number_of_samples, std::shared_ptr<Experience_Pool> pool)
+    : pool(pool)
+    , rows(pool->allocate(number_of_samples))
+    , sums(pool->dimension(), .0)
+    , replacements(0)
+    {
+        assert(number_of_samples > 0);
+    }
+
+    Experience_Replay(const Experience_Replay& other) = delete;
+
+    ~Experience_Replay() { pool->release(rows); }
+
+    /* shares the samples within one pool, copies them otherwise */
+    Experience_Replay& operator=(const Experience_Replay& other)
+    {
+        assert(size() == other.size() and dimension() == other.dimension());
+        if (this == &other)
+            return *this;
+
+        if (pool == other.pool) {
+            pool->share(other.rows);
+            pool->release(rows);
+            rows         = other.rows;
+            sums         = other.sums;
+            replacements = other.replacements;
+        } else {
+            for (std::size_t i = 0; i < size(); ++i) {
+                detach(i);
+                for (std::size_t m = 0; m < dimension(); ++m)
+                    pool->store(rows[i], m, other.pool->get(other.rows[i], m));
+            }
+            recompute_sums();
+        }
+        return *this;
+    }
+
+    std::size_t size     (void) const { return rows.size(); }
+    std::size_t dimension(void) const { return pool->dimension(); }
+
+    sample_t operator[](std::size_t i) const { assert(i < size()); return sample_t(*pool, rows[i]); }
+
+    /* sum over all samples of dimension m */
+    double sum(std::size_t m) const { assert(m < sums.size()); return pool->get_scale(m) * sums[m]; }
+
+    Experience_Pool const& get_pool(void) const { return *pool; }
+
+    /* move the samples to another pool */
+    void move_to(std::shared_ptr<Experience_Pool> other)
+    {
+        assert(other->dimension() == dimension());
+        if (other == pool) return;
+        std::vector<Experience_Pool::index_t> other_rows = other->allocate(size());
+        for (std::size_t i = 0; i < size(); ++i)
+            for (std::size_t m = 0; m < dimension(); ++m)
+                other->store(other_rows[i], m, pool->get(rows[i], m));
+        pool->release(rows);
+        pool = other;
+        rows.swap(other_rows);
+        recompute_sums();
+    }
+
+    /* set all samples to the same vector */
+    template <typename Vector_t>
+    void fill(Vector_t const& sample)
+    {
+        assert(sample.size() == dimension());
+        for (std::size_t i = 0; i < size(); ++i) {
+            detach(i);
+            for (std::size_t m = 0; m < dimension(); ++m)
+                pool->store(rows[i], m, sample[m]);
+        }
+        recompute_sums();
+    }
+
+    /* replace sample i, keeping the sums up to date */
+    template <typename Vector_t>
+    void replace(std::size_t i, Vector_t const& sample)
+    {
+        assert(i < size() and sample.size() == dimension());
+        const Experience_Pool::index_t old_row = rows[i];
+        detach(i); // old row stays valid, it is still in use by others
+        for (std::size_t m = 0; m < dimension(); ++m) {
+            const double old_value = pool->raw(old_row, m);
+            sums[m] += pool->store(rows[i], m, sample[m]) - old_value;
+        }
+        if (++replacements >= size())
+            recompute_sums();
+    }
+
+    /* number of rows shared with other buffers */
+    std::size_t shared_rows(void) const {
+        std::size_t n = 0;
+        for (auto row : rows)
+            if (pool->is_shared(row)) ++n;
+        return n;
+    }
+
+private:
+
+    /* make row i private before it is overwritten, contents are not kept */
+    void detach(std::size_t i) {
+        if (pool->is_shared(rows[i])) {
+            pool->release_row(rows[i]);
+            rows[i] = pool->allocate_row();
+        }
+    }
+
+    void recompute_sums(void)
+    {
+        std::fill(sums.begin(), sums.end(), .0);
+        for (std::size_t i = 0; i < size(); ++i)
+            for (std::size_t m = 0; m < dimension(); ++m)
+                sums[m] += pool->raw(rows[i], m);
+        replacements = 0;
+    }
+
+    std::shared_ptr<Experience_Pool>      pool;
+    std::vector<Experience_Pool::index_t> rows;
+    std::vector<double>                   sums;
+    std::size_t                           replacements;
+};
+
+} // namespace learning
+
+#endif // EXPERIENCE_REPLAY_H_INCLUDED
@@ -2,6 +2,10 @@
 #define EXPERT_H_INCLUDED
 
 #include <memory>
+#include <cstdint>
+#include <functional>
+#include <common/fast_math.h>
+#include <common/random_stream.h>
 #include <common/save_load.h>
 #include <learning/gmes_constants.h>
 #include <learning/predictor.h>
@@ -10,21 +14,34 @@
 /** TODO
  *  + get 3d graphical representation, note: must provided by the underlying type
  *  + in general, an expert should not care if it exists or not, this should be supervised by the expert_vector.
- *  + optional: restrict transitions to have max. k connections
  */
 
 class Expert : public common::Save_Load {
     Expert(const Expert& other) = delete; // non construction-copyable
 
 public:
+    typedef std::function<Predictor_ptr(void)> factory_t;
 
-    Expert( Predictor_ptr     predictor
-          , const std::size_t max_number_of_nodes )
+    explicit Expert(Predictor_ptr predictor)
     : exists(false)
     , predictor(std::move(predictor))
+    , factory()
+    , seed(0)
+    , experience_pool()
+    , learning_capacity(gmes_constants::initial_learning_capacity)
+    , perceptive_width(gmes_constants::perceptive_width)
+    { }
+
+    /* the predictor is constructed on first use, with the random numbers
+     * it draws when constructed taken from a stream seeded by 'seed' */
+    Expert(factory_t factory, uint32_t seed)
+    : exists(false)
+    , predictor()
+    , factory(factory)
+    , seed(seed)
+    , experience_pool()
     , learning_capacity(gmes_constants::initial_learning_capacity)
     , perceptive_width(gmes_constants::perceptive_width)
-    , transition(max_number_of_nodes)
     { }
 
     Expert(Expert&& other) = default;
@@ -32,45 +49,68 @@ public:
 
     bool   learning_capacity_is_exhausted(void) const { return learning_capacity < gmes_constants::learning_capacity_exhausted; }
     double get_learning_capacity         (void) const { return learning_capacity; }
-    double get_prediction_error          (void) const { return predictor->get_prediction_error(); }
-    void   adapt_weights                 (void)       { predictor->adapt();                       }
-    void   reinit_predictor_weights      (void)       { predictor->initialize_from_input();       }
-
-    double update_and_get_activation     (void) const {
-        if (not exists) return 0.0;
-        double e = predictor->get_prediction_error();
-        return exp(-e*e/perceptive_width);
-    }
-
-    /* make prediction and update prediction error */
-    double make_prediction(void) { return predictor->predict(); }
-    double redo_prediction(void) { return predictor->verify(); }
+    double get_prediction_error          (void) const { return instance().get_prediction_error(); }
+    void   adapt_weights                 (void)       { instance().adapt();                       }
+    void   reinit_predictor_weights      (void)       { instance().initialize_from_input();       }
 
-    void clear_transitions(void) { for (auto& t : transition) t = 0.0; }
+    double update_and_get_activation     (fast_math::Mode mode = fast_math::Mode::exact) const { return fast_math::exp(get_activation_exponent(), mode); }
 
-    void create_randomized(void) {
-        exists = true;
-        predictor->initialize_randomized();
+    /* activation = exp(exponent), -inf if the expert does not exist */
+    double get_activation_exponent       (void) const {
+        if (not exists) return -INFINITY;
+        double e = instance().get_prediction_error();
+        return -e*e/perceptive_width;
     }
 
-    bool exists_transition(std::size_t index) const { return transition.at(index) > gmes_constants::transition_exist_treshold; }
-    void reset_transition(std::size_t index) { transition.at(index) = gmes_constants::initial_transition_validation; }
+    /* make prediction and update prediction error */
+    double make_prediction(void) { return instance().predict(); }
+    double redo_prediction(void) { return instance().verify(); }
+
+    bool supports_concurrent_prediction(void) const { return instance().supports_concurrent_prediction(); }
 
-    Predictor_Base const& get_predictor(void) const { return *predictor; }
-    Predictor_Base      & set_predictor(void)       { return *predictor; }
+    Predictor_Base const& get_predictor(void) const { return instance(); }
+    Predictor_Base      & set_predictor(void)       { return instance(); }
 
     bool does_exists(void) const { return exists; }
+    bool is_constructed(void) const { return predictor != nullptr; }
 
     //Predictor_Base::vector_t const& get_weights(void) const { return predictor->get_weights(); }
     //Predictor_Base::vector_t      & set_weights(void)       { return predictor->set_weights(); }
 
 
 private:
+    Predictor_Base& instance(void) const {
+        if (not predictor) {
+            assert(factory);
+            common::Random_Stream stream(seed);
+            Random_Scope scope(stream); // same initial weights, whenever constructed
+            predictor = factory();
+            if (experience_pool)
+                predictor->share_experience(experience_pool);
+        }
+        return *predictor;
+    }
+
+    /* replay buffers of predictors constructed later go to this pool */
+    void share_experience(std::shared_ptr<learning::Experience_Pool> pool) {
+        experience_pool = pool;
+        if (predictor)
+            predictor->share_experience(pool);
+    }
+
+    /* use Expert_Vector::create_randomized, which keeps count of the existing experts */
+    void create_randomized(void) {
+        exists = true;
+        instance().initialize_randomized();
+    }
+
     bool          exists;
-    Predictor_ptr predictor;
+    mutable Predictor_ptr predictor;
+    factory_t     factory;
+    uint32_t      seed;
+    std::shared_ptr<learning::Experience_Pool> experience_pool;
     double        learning_capacity;
     const double  perceptive_width;
-    VectorN       transition;       // validity of connections
 
     friend class Expert_Vector;
     friend class GMES;
@@ -2,6 +2,7 @@
 #define EXPERT_VECTOR_H_INCLUDED
 
 #include <memory>
+#include <functional>
 #include <common/static_vector.h>
 #include <common/save_load.h>
 #include <control/sensorspace.h>
@@ -18,23 +19,40 @@
 /* The Expert Vector merely work as a container
  * and should neither carry any information nor functionality
  * regarding the expert modules in it. However this is theory. :)
+ *
+ * Predictors are constructed lazily, i.e. when an expert is first used
+ * (created, copied to, predicted with, ...). Use preallocate(n) to
+ * construct the first n predictors up front. Random numbers drawn by
+ * the predictors' constructors come from a stream per expert, seeded
+ * when the vector is constructed, so they do not depend on the order
+ * or time of construction.
  */
 
 class Expert_Vector : public common::Save_Load {
 
     std::vector<Expert> experts;
     static_vector_interface& payloads;
+    std::size_t number_of_existing;
+    std::shared_ptr<learning::Experience_Pool> experience_pool;
+    std::function<void(void)> cycle_preparation; // work shared by all experts of a cycle
+    uint32_t construction_seed;                  // of the experts' random streams
 
     Expert_Vector( const std::size_t max_number_of_experts
                  , static_vector_interface& payloads )
     : experts()
     , payloads(payloads)
+    , number_of_existing(0)
+    , experience_pool()
+    , cycle_preparation()
+    , construction_seed(rand())
     {
         assert(payloads.size() == max_number_of_experts);
         assert(max_number_of_experts > 0);
         experts.reserve(max_number_of_experts);
     }
 
+    void emplace_lazy(Expert::factory_t factory) { experts.emplace_back(factory, construction_seed + experts.size()); }
+
 public:
     Expert_Vector(Expert_Vector&& other) = default;
     Expert_Vector& operator=(Expert_Vector&& other) = default;
@@ -43,6 +61,47 @@ public:
     const Expert& operator[] (const std::size_t index) const { return experts.at(index); }
 
     std::size_t size(void) const { return experts.size(); }
+    std::size_t get_number_of_existing(void) const { return number_of_existing; }
+
+    void create_randomized(std::size_t index) {
+        if (not experts.at(index).exists) ++number_of_existing;
+        experts[index].create_randomized();
+    }
+
+    /* called once per cycle before the experts predict */
+    void begin_cycle(void) { if (cycle_preparation) cycle_preparation(); }
+
+    /* construct the predictors of the first n experts now */
+    void preallocate(std::size_t n) {
+        assert(n <= experts.size());
+        for (std::size_t i = 0; i < n; ++i)
+            experts[i].get_predictor();
+    }
+
+    std::size_t get_number_of_constructed(void) const {
+        std::size_t n = 0;
+        for (auto const& e : experts)
+            if (e.is_constructed()) ++n;
+        return n;
+    }
+
+    /* Moves the replay buffers of all experts into one pool, optionally
+     * quantized to 16 bit with the given range per input dimension.
+     * Experts constructed later allocate their buffers there too. */
+    void share_experience( learning::Experience_Pool::Storage storage = learning::Experience_Pool::Storage::exact
+                         , std::vector<double> const& range = {} )
+    {
+        assert(not experts.empty());
+        auto const& replay = experts[0].get_predictor().get_experience();
+        const std::size_t rows = experts.size() * replay.size(); // also for experts constructed later
+
+        auto pool = std::make_shared<learning::Experience_Pool>(replay.dimension(), storage, range, rows);
+        for (auto& e : experts)
+            e.share_experience(pool);
+        experience_pool = pool;
+    }
+
+    learning::Experience_Pool const* get_experience_pool(void) const { return experience_pool.get(); }
 
     void save(std::string f)
     {
@@ -60,20 +119,26 @@ public:
         auto const cols = experts.at(0).get_predictor().get_weights().size();
         csv_file_t csv(f+"experts.dat", experts.size(), cols);
         csv.read();
+        number_of_existing = 0;
+        Predictor_Base::vector_t weights(cols);
         for (std::size_t i = 0; i < experts.size(); ++i) {
-            csv.get_line(i, experts[i].set_predictor().set_weights());
-            experts[i].exists = !(i > 0 && is_vector_zero(experts[i].get_predictor().get_weights()));
+            csv.get_line(i, weights);
+            experts[i].exists = !(i > 0 && is_vector_zero(weights));
+            if (experts[i].exists or experts[i].is_constructed()) // do not construct unused experts
+                experts[i].set_predictor().set_weights() = weights;
+            if (experts[i].exists) ++number_of_existing;
         }
     }
 
 
     void copy(std::size_t to, std::size_t from, bool one_shot_learning) {
 
-        experts.at(to).exists = true; // create
+        if (not experts.at(to).exists) ++number_of_existing;
+        experts[to].exists = true; // create
 
         if (one_shot_learning) experts.at(to).reinit_predictor_weights();
         else
-            experts.at(to).predictor->copy( *(experts.at(from).predictor) );
+            experts.at(to).set_predictor().copy( experts.at(from).get_predictor() );
 
         payloads.copy(to, from); /* take a flawed copy of the payload */
     }
@@ -89,8 +154,10 @@ public:
     {
         assert(local_learning_rate > 0.);
         for (std::size_t i = 0; i < max_number_of_experts; ++i)
-            experts.emplace_back( Predictor_ptr( new Predictor(input, local_learning_rate, random_weight_range, experience_size) )
-                                , max_number_of_experts );
+            emplace_lazy( Expert::factory_t([&input, local_learning_rate, random_weight_range, experience_size]() {
+                return Predictor_ptr( new Predictor(input, local_learning_rate, random_weight_range, experience_size) );
+            }) );
+        share_experience();
     }
 
     /* time-delay network sensor state space constructor */
@@ -105,8 +172,28 @@ public:
     {
         assert(local_learning_rate > 0.);
         for (std::size_t i = 0; i < max_number_of_experts; ++i)
-            experts.emplace_back( Predictor_ptr( new learning::State_Predictor(input, local_learning_rate, gmes_constants::random_weight_range, experience_size, hidden_layer_size, time_delay_size) )
-                                , max_number_of_experts );
+            emplace_lazy( Expert::factory_t([&input, local_learning_rate, experience_size, hidden_layer_size, time_delay_size]() {
+                return Predictor_ptr( new learning::State_Predictor(input, local_learning_rate, gmes_constants::random_weight_range, experience_size, hidden_layer_size, time_delay_size) );
+            }) );
+        share_experience();
+    }
+
+    /* time-delay network sensor state space constructor, all experts share one delay line */
+    Expert_Vector( const std::size_t                 max_number_of_experts
+                 , static_vector_interface&          payloads
+                 , const sensor_vector&              input
+                 , learning::FIR_type_synapse const& shared_delay_line
+                 , const double                      local_learning_rate
+                 , const std::size_t                 experience_size
+                 , const std::size_t                 hidden_layer_size )
+    : Expert_Vector(max_number_of_experts, payloads)
+    {
+        assert(local_learning_rate > 0.);
+        for (std::size_t i = 0; i < max_number_of_experts; ++i)
+            emplace_lazy( Expert::factory_t([&input, &shared_delay_line, local_learning_rate, experience_size, hidden_layer_size]() {
+                return Predictor_ptr( new learning::State_Predictor(input, shared_delay_line, local_learning_rate, gmes_constants::random_weight_range, experience_size, hidden_layer_size) );
+            }) );
+        share_experience();
     }
 
     /* motor action space constructor */
@@ -123,9 +210,19 @@ public:
         sts_msg("Creating motor expert vector with %u elements in control parameter vector.", ctrl_params.size());
         assert(local_learning_rate > 0.);
         assert(ctrl_params.size() == max_number_of_experts);
-        for (std::size_t i = 0; i < max_number_of_experts; ++i)
-            experts.emplace_back( Predictor_ptr( new learning::Motor_Predictor(robot, motor_targets, local_learning_rate, gmes_constants::random_weight_range, experience_size, ctrl_params.get(i), noise_level))
-                                , max_number_of_experts );
+        /* inputs are prepared once per cycle, every expert has its own noise */
+        auto inputs = std::make_shared<learning::Motor_Inputs>(robot);
+        cycle_preparation = [inputs, &robot]() { inputs->prepare(robot); };
+        const uint32_t seed = rand();
+
+        for (std::size_t i = 0; i < max_number_of_experts; ++i) {
+            const control::Control_Parameter params = ctrl_params.get(i);
+            const uint32_t noise_seed = seed + i;
+            emplace_lazy( Expert::factory_t([&robot, &motor_targets, local_learning_rate, experience_size, params, noise_level, noise_seed, inputs]() {
+                return Predictor_ptr( new learning::Motor_Predictor(robot, motor_targets, local_learning_rate, gmes_constants::random_weight_range, experience_size, params, noise_level, noise_seed, inputs) );
+            }) );
+        }
+        share_experience();
     }
 
     /* state action space constructor */
@@ -141,13 +238,15 @@ public:
     {
         assert(local_learning_rate > 0.);
         for (std::size_t i = 0; i < max_number_of_experts; ++i)
-            experts.emplace_back( Predictor_ptr( new learning::State_Action_Predictor( input
-                                                                                     , local_learning_rate
-                                                                                     , random_weight_range
-                                                                                     , experience_size
-                                                                                     , hidden_layer_size
-                                                                                     ) )
-                                , max_number_of_experts );
+            emplace_lazy( Expert::factory_t([&input, local_learning_rate, random_weight_range, experience_size, hidden_layer_size]() {
+                return Predictor_ptr( new learning::State_Action_Predictor( input
+                                                                          , local_learning_rate
+                                                                          , random_weight_range
+                                                                          , experience_size
+                                                                          , hidden_layer_size
+                                                                          ) );
+            }) );
+        share_experience();
     }
 
 
@@ -165,13 +264,14 @@ public:
     {
         assert(local_learning_rate > 0.);
         for (std::size_t i = 0; i < max_number_of_experts; ++i)
-            experts.emplace_back( Predictor_ptr( new learning::Homeokinetic_Core( input
-                                                                                , number_of_motor_outputs
-                                                                                , local_learning_rate
-                                                                                , random_weight_range
-                                                                                , number_of_context_units
-                                                                                ) )
-                                , max_number_of_experts );
+            emplace_lazy( Expert::factory_t([&input, number_of_motor_outputs, local_learning_rate, random_weight_range, number_of_context_units]() {
+                return Predictor_ptr( new learning::Homeokinetic_Core( input
+                                                                     , number_of_motor_outputs
+                                                                     , local_learning_rate
+                                                                     , random_weight_range
+                                                                     , number_of_context_units
+                                                                     ) );
+            }) );
     }
 
 
@@ -189,15 +289,15 @@ public:
     {
         assert(local_learning_rate > 0.);
         for (std::size_t i = 0; i < max_number_of_experts; ++i)
-            experts.emplace_back(
-                                 Predictor_ptr( new learning::BiModel_Predictor( input
-                                                                               , gateway
-                                                                               , gradient
-                                                                               , local_learning_rate
-                                                                               , random_weight_range
-                                                                               , regularization_rate
-                                                                               ) )
-                                , max_number_of_experts );
+            emplace_lazy( Expert::factory_t([&input, &gateway, &gradient, local_learning_rate, random_weight_range, regularization_rate]() {
+                return Predictor_ptr( new learning::BiModel_Predictor( input
+                                                                     , gateway
+                                                                     , gradient
+                                                                     , local_learning_rate
+                                                                     , random_weight_range
+                                                                     , regularization_rate
+                                                                     ) );
+            }) );
     }
 
 };
@@ -215,7 +315,7 @@ public:
     : Expert_Vector_Base(max_number_of_experts, payloads)
     {
         for (std::size_t i = 0; i < max_number_of_experts; ++i)
-            experts.emplace_back( Predictor_ptr(new PredictorType(predictor_args...)), max_number_of_experts );
+            experts.emplace_back( Predictor_ptr(new PredictorType(predictor_args...)) );
     }
 };
 
@@ -116,8 +116,8 @@ public:
         Vector3 new_position = 0.0;
         new_position.random(-0.5*ff_constants::distance_0, +0.5*ff_constants::distance_0);
 
-        for (std::size_t k = 0; k < expert[winner].transition.size(); ++k) {
-            if (expert[winner].exists_transition(k)) {
+        for (std::size_t k = 0; k < gmes.transitions.size(); ++k) {
+            if (gmes.transitions.exists(winner, k)) {
                 new_position += particle[k].position;
                 ++count_transitions;
             }
@@ -146,7 +146,7 @@ public:
                     {
                         double dx = distance(particle[i].position, particle[k].position);
 
-                        if (expert[i].exists_transition(k) || expert[k].exists_transition(i)) {
+                        if (gmes.transitions.exists(i, k) || gmes.transitions.exists(k, i)) {
                             particle[i].force += -ff_constants::k_spring * clip(dx - ff_constants::distance_0, ff_constants::distance_0) * ((particle[i].position - particle[k].position)/dx);
                             //TODO add damper forces
                         }
@@ -173,7 +173,7 @@ public:
                                  fmin(2.0, expert[i].learning_capacity));
 
             for (unsigned int k = 0; k < expert.size(); ++k)
-                ff_graph.update_edge(i, k, (expert[i].exists_transition(k) ? expert[i].transition[k]*192 : 0)); //TODO use color of edge to display eligibility traces
+                ff_graph.update_edge(i, k, (gmes.transitions.exists(i, k) ? gmes.transitions.value(i, k)*192 : 0)); //TODO use color of edge to display eligibility traces
         }
         ff_graph.activated(gmes.get_winner());
         ff_graph.special(gmes.get_to_insert());
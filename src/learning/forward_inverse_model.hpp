@@ -2,7 +2,9 @@
 #define BIDIRECTIONAL_MODELS_H_INCLUDED
 
 #include <vector>
-#include <common/static_vector.h>
+#include <common/matrix.h>
+#include <common/matrix_kernels.h>
+#include <common/fast_math.h>
 #include <common/modules.h>
 
 
@@ -13,7 +15,7 @@ namespace learning {
 namespace model {
     typedef double scalar_t;
     typedef std::vector<scalar_t> vector_t;
-    typedef copyable_static_vector<copyable_static_vector<scalar_t>> matrix_t;
+    typedef common::Matrix<scalar_t> matrix_t;
 
     template <typename Float_t>
     struct AdamData {
@@ -35,24 +37,24 @@ namespace model {
             const Float_t M = m / (1. - bt1);
             const Float_t V = v / (1. - bt2);
 
-            return (M / (sqrt(V) + e0));
+            return (M / (std::sqrt(V) + e0));
 
         }
     };
 
-    typedef copyable_static_vector<copyable_static_vector<AdamData<scalar_t>>> gradient_t;
+    typedef common::Matrix<AdamData<scalar_t>> gradient_t;
 
 
 
     template <typename MatrixType>
     void randomize_weights(MatrixType& mat, double random_weight_range) {
         assert_in_range(random_weight_range, 0.0, 5.0);
-        const double normed_std_dev = random_weight_range / sqrt(mat[0].size());
+        const double normed_std_dev = random_weight_range / sqrt(mat.cols());
         assert(normed_std_dev != 0.0);
 
-        for (std::size_t i = 0; i < mat.size(); ++i)
-            for (std::size_t j = 0; j < mat[i].size(); ++j)
-                mat[i][j] = rand_norm_zero_mean(normed_std_dev); // normalized by sqrt(N), N:#inputs
+        for (std::size_t i = 0; i < mat.rows(); ++i)
+            for (std::size_t j = 0; j < mat.cols(); ++j)
+                mat(i,j) = rand_norm_zero_mean(normed_std_dev); // normalized by sqrt(N), N:#inputs
 
     }
 }
@@ -113,6 +115,7 @@ class LinearTransfer {
 public:
     static T transfer(T const& x) { return x; }
     static T derive(T const& /*y*/) { return T{1}; }
+    static void transfer_fast(T* /*y*/, std::size_t /*n*/) { } // in place
 };
 
 template <typename T = model::scalar_t>
@@ -121,6 +124,7 @@ public:
     static T transfer(T const& x) { return tanh(x);               } // normal tangens hyperbolicus
     static T derive  (T const& y) { return (1.0 + y) * (1.0 - y); } // this is y' with y=tanh(x)
     static T inverse (T const& x) { return atanh(x); /*log((1+x)/(1-x))/2*/    } // area tangens hyperbolicus = tanh^-1
+    static void transfer_fast(T* y, std::size_t n) { fast_math::tanh(y, y, n); } // in place, vectorized
 };
 
 struct Weight_Statistics_t {
@@ -132,15 +136,26 @@ struct Weight_Statistics_t {
 
 };
 
-template <typename Transfer_t>
+/* Scalar_t selects the precision of weights, activations and Adam's
+   statistics, use e.g. NeuralModel<TanhTransfer<float>, float> */
+template <typename Transfer_t, typename Scalar_t = model::scalar_t>
 class NeuralModel {
+public:
+    typedef std::vector<Scalar_t>                       vector_t;
+    typedef common::Matrix<Scalar_t>                    matrix_t;
+    typedef common::Matrix<model::AdamData<Scalar_t>>   gradient_t;
+
+private:
+
+    vector_t y; // output, predictions
+    matrix_t W; // Weights
+    Scalar_t E; // prediction error
+    vector_t d; // delta error (used for back-propagation)
+    vector_t x; // contiguous copy of non-vector inputs
 
-    model::vector_t y; // output, predictions
-    model::matrix_t W; // Weights
-    model::scalar_t E; // prediction error
-    model::vector_t d; // delta error (used for back-propagation)
+    gradient_t G; // Adam's Gradient Statistics
 
-    model::gradient_t G; // Adam's Gradient Statistics
+    fast_math::Mode math_mode = fast_math::Mode::exact; // of the transfer function
 
 public:
     NeuralModel(std::size_t size_in, std::size_t size_out, double random_weight_range)
@@ -148,33 +163,44 @@ public:
     , W(size_out, size_in)
     , E()
     , d(size_out)
+    , x(size_in)
     , G(size_out, size_in)
     {
         model::randomize_weights(W, random_weight_range);
     }
 
+    /* copy of a model of another precision, Adam's statistics start anew */
+    template <typename Other_Transfer_t, typename Other_t>
+    explicit NeuralModel(NeuralModel<Other_Transfer_t, Other_t> const& other)
+    : y(other.y.begin(), other.y.end())
+    , W(other.W)
+    , E(other.E)
+    , d(other.d.begin(), other.d.end())
+    , x(other.x.size())
+    , G(other.G.rows(), other.G.cols())
+    , math_mode(other.math_mode)
+    { }
+
+    template <typename, typename> friend class NeuralModel;
+
     /* calculate and get back-propagated delta error */
-    model::vector_t get_backprop_err(void) const
+    vector_t get_backprop_err(void) const
     {
-        model::vector_t r(W[0].size());
-        for (std::size_t j = 0; j < r.size(); ++j)
-            for (std::size_t i = 0; i < d.size(); ++i)
-                r[j] += d[i] * W[i][j];
+        vector_t r(W.cols());
+        common::kernel::gemv_t(W, d.data(), r.data());
         return r;
     }
 
 
     template <typename InputVector_t>
-    model::vector_t const& propagate(InputVector_t const& in)
+    vector_t const& propagate(InputVector_t const& in)
     {
         check_vectors(in, W[0]);
-
-        for (std::size_t i = 0; i < y.size(); ++i) {
-            model::scalar_t a = .0;
-            for (std::size_t j = 0; j < in.size(); ++j)
-                a += W[i][j] * in[j];
-            y[i] = Transfer_t::transfer(a);
-        }
+        if (math_mode == fast_math::Mode::fast) {
+            common::kernel::gemv(W, common::kernel::contiguous(in, x), y.data());
+            Transfer_t::transfer_fast(y.data(), y.size());
+        } else
+            common::kernel::gemv(W, common::kernel::contiguous(in, x), y.data(), [](Scalar_t a) { return Transfer_t::transfer(a); });
         return y;
     }
 
@@ -187,37 +213,41 @@ public:
         assert_in_range(learning_rate, 0.0, 1.0);
         E = .0; // reset total sum of prediction errors
         for (std::size_t i = 0; i < y.size(); ++i) {
-            const model::scalar_t e_i = tar[i] - y[i];
+            const Scalar_t e_i = tar[i] - y[i];
             E += square(e_i);
             d[i] = Transfer_t::derive(y[i]) * e_i; // remember delta error for back-propagation signal
+            Scalar_t* w_i = W.row(i).data();
+            model::AdamData<Scalar_t>* g_i = G.row(i).data();
             for (std::size_t j = 0; j < in.size(); ++j)
                 //W[i][j] += learning_rate * d[i] * in[j] - regularization_rate * W[i][j];//* sign(W[i][j]);
                 /*              target learning                  L1 regularization     */
-                W[i][j] += learning_rate * G[i][j].get(d[i] * in[j]) - regularization_rate * W[i][j];
+                w_i[j] += learning_rate * g_i[j].get(d[i] * in[j]) - regularization_rate * w_i[j];
         }
     }
 
-    model::matrix_t const& get_weights() const { return W; }
-    model::vector_t const& get_outputs() const { return y; }
-    model::scalar_t        get_error  () const { return E/y.size(); }
+    matrix_t const& get_weights() const { return W; }
+    vector_t const& get_outputs() const { return y; }
+    Scalar_t        get_error  () const { return E/y.size(); }
 
     void randomize_weights(double random_weight_range) { model::randomize_weights(W, random_weight_range); }
 
+    void set_math_mode(fast_math::Mode mode) { math_mode = mode; }
+
 
     void constrain_weights(void) {
-        for (std::size_t i = 0; i < W.size(); ++i)
-            for (std::size_t j = 0; j < W[i].size(); ++j)
-                W[i][j] = clip(W[i][j], 5);
+        for (std::size_t i = 0; i < W.rows(); ++i)
+            for (std::size_t j = 0; j < W.cols(); ++j)
+                W(i,j) = clip(W(i,j), 5);
     }
 
     //move to w_statistics class
     Weight_Statistics_t get_weight_statistics(void) const {
         Weight_Statistics_t stat = {};
         stat.num = 0;
-        stat.total = W.size() * W[0].size();
-        for (std::size_t i = 0; i < W.size(); ++i)
-            for (std::size_t j = 0; j < W[i].size(); ++j) {
-                const float w = W[i][j];
+        stat.total = W.rows() * W.cols();
+        for (std::size_t i = 0; i < W.rows(); ++i)
+            for (std::size_t j = 0; j < W.cols(); ++j) {
+                const float w = W(i,j);
                 stat.avg += w;
                 stat.vol += std::abs(w);
                 if (fabs(w) > Weight_Statistics_t::zero_thrsh) ++stat.num;
@@ -237,6 +267,19 @@ class InverseNeuralModel {
     model::matrix_t M;    // Weights
     model::scalar_t e;    // prediction error
 
+    fast_math::Mode math_mode = fast_math::Mode::exact; // of the inverse transfer function
+
+    /* a = G(in) */
+    template <typename InputVector_t>
+    void inverse_transfer(InputVector_t const& in) {
+        if (math_mode == fast_math::Mode::fast) {
+            const model::scalar_t* x = common::kernel::contiguous(in, a);
+            fast_math::atanh(x, a.data(), a.size());
+        } else
+            for (std::size_t j = 0; j < in.size(); ++j)
+                a[j] = G(in[j]);
+    }
+
 public:
     static constexpr auto& G = TanhTransfer<>::inverse;
 
@@ -253,15 +296,9 @@ public:
     model::vector_t const& propagate(InputVector_t const& in)
     {
         check_vectors(in, a);
-        for (std::size_t j = 0; j < in.size(); ++j)
-            a[j] = G(in[j]);
-
-        for (std::size_t i = 0; i < y.size(); ++i) {
-            y[i] = .0;
-            for (std::size_t j = 0; j < a.size(); ++j)
-                y[i] += M[i][j] * a[j];
-        }
+        inverse_transfer(in);
 
+        common::kernel::gemv(M, a.data(), y.data());
         return y;
     }
 
@@ -273,14 +310,14 @@ public:
         assert_in_range(learning_rate, 0.0, 5.0);
 
         e = .0;
-        for (std::size_t j = 0; j < in.size(); ++j)
-            a[j] = G(in[j]);
+        inverse_transfer(in);
 
         for (std::size_t i = 0; i < y.size(); ++i) {
             model::scalar_t err_i = learning_rate * (tar[i] - y[i]);
             e += square(tar[i] - y[i]);
+            model::scalar_t* m_i = M.row(i).data();
             for (std::size_t j = 0; j < in.size(); ++j)
-                M[i][j] += err_i * a[j] - normalize_rate * sign(M[i][j]);
+                m_i[j] += err_i * a[j] - normalize_rate * sign(m_i[j]);
         }
     }
 
@@ -290,6 +327,7 @@ public:
 
     void randomize_weights(double random_weight_range) { model::randomize_weights(M, random_weight_range); }
 
+    void set_math_mode(fast_math::Mode mode) { math_mode = mode; }
 
 }; /* LinearModel */
 
@@ -342,6 +380,11 @@ public:
         m_inverse.constrain_weights();
     }
 
+    void set_math_mode(fast_math::Mode mode) {
+        m_forward.set_math_mode(mode);
+        m_inverse.set_math_mode(mode);
+    }
+
 }; /* BidirectionalModel */
 
 
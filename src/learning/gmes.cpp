@@ -18,12 +18,21 @@
     , recipient(0)
     , to_insert(0)
     , activations(Nmax)
+    , activation_stamp(Nmax, 0)
+    , activations_complete(0)
+    , activation_version(1)
     , new_node(false)
+    , transitions(Nmax)
+    , pool(nullptr)
+    , grain_size(1)
+    , prediction_errors(Nmax)
+    , prototypes()
+    , outdated_error(Nmax, false)
     , name(name)
     {
         assert(in_range(number_of_initial_experts, std::size_t{1}, Nmax));
         for (std::size_t n = 0; n < number_of_initial_experts; ++n)
-            expert[n].create_randomized();
+            expert.create_randomized(n);
         sts_msg("Created GMES (%s) with %u experts and learning rate %.4f", name.c_str(), Nmax, learning_rate);
         number_of_experts = count_existing_experts();
     }
@@ -40,6 +49,9 @@
         /* backup last winner */
         last_winner = winner;
 
+        /* e.g. prepare inputs shared by all experts */
+        expert.begin_cycle();
+
         /* determine new winner */
         winner = determine_winner();
 
@@ -49,6 +61,7 @@
 
             /* adapt weights of winner */
             expert[winner].adapt_weights();
+            update_prototype(winner);
 
             /* estimate learning progress: L = -dE/dt */
             estimate_learning_progress();
@@ -60,7 +73,7 @@
             refresh_transitions();
 
             /* count experts */
-            number_of_experts = count_existing_experts(); /** could be a member method of experts class */
+            number_of_experts = count_existing_experts();
 
             /* assert learning_capacity does not leak */
             check_learning_capacity();
@@ -73,7 +86,7 @@
         } else /* learning_disabled */
             learning_progress = .0;
 
-        update_activations();
+        invalidate_activations();
     }
 
 
@@ -88,10 +101,12 @@
         {
             /* copy weights and payload */
             expert.copy(to_insert, winner, one_shot_learning);
+            update_prototype(to_insert);
+            outdated_error[to_insert] = false; // copied or reset with the weights
 
             /* clear transitions emanating from 'to_insert' */
-            expert[to_insert].clear_transitions();
-            clear_transitions_to(to_insert);
+            transitions.clear_from(to_insert);
+            transitions.clear_to(to_insert);
 
             /* exchange learning capacity */
             const double share = (expert[winner].learning_capacity + expert[to_insert].learning_capacity)/2;
@@ -99,7 +114,7 @@
             expert[to_insert].learning_capacity -= share;
 
             /* set new transition */
-            expert[to_insert].reset_transition(winner);
+            transitions.reset(to_insert, winner);
             winner = to_insert;
             new_node = true;
         }
@@ -124,7 +139,7 @@
     void GMES::adjust_learning_capacity(void)
     {
         const double delta_capacity = expert[winner].learning_capacity
-                                    - expert[winner].learning_capacity * exp(-learning_rate * learning_progress); /** TODO: reorder eq. to: x * (1-exp) */
+                                    - expert[winner].learning_capacity * fast_math::exp(-learning_rate * learning_progress, math_mode); /** TODO: reorder eq. to: x * (1-exp) */
 
         recipient = random_index(Nmax);
 
@@ -137,25 +152,54 @@
      */
     void GMES::refresh_transitions(void)
     {
-        /* invalidate connections emanating from winner */
-        for (std::size_t n = 0; n < Nmax; ++n) {
-            expert[n].transition[winner] *= exp(-learning_rate * learning_progress); /** TODO: this factor can be computed beforehand and used several times*/
-            expert[winner].transition[n] *= exp(-learning_rate * learning_progress);
-        }
+        /* invalidate connections emanating from winner,
+         * i.e. multiply them by exp(-learning_rate * learning_progress) */
+        transitions.decay_node(winner, learning_rate * learning_progress);
 
         /* validate the connection from last_winner to winner */
-        expert[winner].reset_transition(last_winner);
+        transitions.reset(winner, last_winner);
     }
 
 
     /* refreshes the activation vector with the current
      * experts' activations, i.e. inverse prediction error
      */
-    void GMES::update_activations(void)
+    void GMES::update_activations(void) const
     {
-        /* compute activations */
         for (std::size_t n = 0; n < Nmax; ++n)
-            activations[n] = expert[n].update_and_get_activation();
+            refresh_prediction_error(n);
+        /* compute the exponents first, then all exp at once */
+        for (std::size_t n = 0; n < Nmax; ++n)
+            activations[n] = expert[n].get_activation_exponent();
+        fast_math::exp(activations.data(), activations.data(), Nmax, math_mode);
+
+        activations_complete = activation_version;
+        std::fill(activation_stamp.begin(), activation_stamp.end(), activation_version);
+    }
+
+
+    /* the experts' prediction errors have changed,
+     * activations are evaluated again on next read
+     */
+    void GMES::invalidate_activations(void) { ++activation_version; }
+
+
+    double GMES::get_activation(std::size_t n) const
+    {
+        if (activation_stamp.at(n) != activation_version) {
+            refresh_prediction_error(n);
+            activations[n] = expert[n].update_and_get_activation(math_mode);
+            activation_stamp[n] = activation_version;
+        }
+        return activations[n];
+    }
+
+
+    VectorN const& GMES::get_activations(void) const
+    {
+        if (activations_complete != activation_version)
+            update_activations();
+        return activations;
     }
 
 
@@ -164,6 +208,11 @@
      */
     std::size_t GMES::determine_winner(void)
     {
+        if (prototypes != nullptr)
+            return determine_winner_by_prototypes();
+        if (pool != nullptr)
+            return determine_winner_parallel();
+
         std::size_t winner = 0;
         double min_error = expert[0].make_prediction();
 
@@ -186,6 +235,120 @@
     }
 
 
+    /* same as determine_winner, but the predictions are made concurrently
+     * and the arg min is taken afterwards in index order, hence ties are
+     * resolved exactly as in the serial version.
+     */
+    std::size_t GMES::determine_winner_parallel(void)
+    {
+        pool->parallel_for(Nmax, grain_size, [this](std::size_t begin, std::size_t end) {
+            for (std::size_t n = begin; n < end; ++n)
+                if (0 == n or expert[n].exists)
+                    prediction_errors[n] = expert[n].make_prediction();
+        });
+
+        std::size_t winner = 0;
+        double min_error = prediction_errors[0];
+        for (std::size_t n = 1; n < Nmax; ++n)
+        {
+            if (expert[n].exists and prediction_errors[n] < min_error) {
+                winner = n;
+                min_error = prediction_errors[n];
+            }
+        }
+        min_prediction_error = min_error;
+        return winner;
+    }
+
+
+    void GMES::enable_parallel_prediction(common::Thread_Pool& thread_pool, std::size_t grain)
+    {
+        assert(grain > 0);
+        /* experts of one vector are of the same type, check only those
+           already constructed (at least expert 0) to keep construction lazy */
+        for (std::size_t n = 0; n < Nmax; ++n)
+            if ((0 == n or expert[n].is_constructed()) and not expert[n].supports_concurrent_prediction()) {
+                wrn_msg("GMES (%s) experts do not support concurrent prediction. Keep predicting serially.", name.c_str());
+                return;
+            }
+        pool = &thread_pool;
+        grain_size = grain;
+        sts_msg("GMES (%s) predicts in parallel on %u threads with grain size %u.", name.c_str(), pool->size(), grain_size);
+    }
+
+
+    /* nearest prototype search, which is equivalent to the minimal
+     * prediction error for simple predictors, since the error is a
+     * monotonic function of the squared distance to the input. The
+     * other experts' errors are taken from the distances the search
+     * evaluated, the skipped ones are outdated until read.
+     */
+    std::size_t GMES::determine_winner_by_prototypes(void)
+    {
+        prototypes->set_input(expert[0].get_predictor().get_input());
+        double squared_dist;
+        const std::size_t winner = prototypes->nearest(squared_dist);
+        assert(winner < Nmax);
+
+        for (std::size_t n = 0; n < Nmax; ++n) {
+            if (not expert[n].exists or n == winner) continue;
+            outdated_error[n] = not prototypes->last_distance(n, squared_dist);
+            if (not outdated_error[n]) /* type checked on enabling */
+                static_cast<Predictor&>(expert[n].set_predictor()).predict(squared_dist);
+        }
+        outdated_error[winner] = false;
+        min_prediction_error = expert[winner].make_prediction(); // same summation as without search
+        return winner;
+    }
+
+    /* predicts with an expert skipped by the last prototype search */
+    void GMES::refresh_prediction_error(std::size_t index) const
+    {
+        if (not outdated_error[index]) return;
+        expert[index].make_prediction();
+        outdated_error[index] = false;
+    }
+
+
+    void GMES::enable_prototype_search(bool use_index, std::size_t max_checks)
+    {
+        for (std::size_t n = 0; n < Nmax; ++n) /* constructed experts only, see above */
+            if ((0 == n or expert[n].is_constructed()) and nullptr == dynamic_cast<Predictor const*>(&expert[n].get_predictor())) {
+                wrn_msg("GMES (%s) prototype search requires simple predictors.", name.c_str());
+                return;
+            }
+        prototypes.reset(new learning::Prototype_Search(Nmax, expert[0].get_predictor().get_weights().size()));
+        refresh_prototypes();
+        if (use_index) prototypes->enable_index(max_checks);
+        sts_msg("GMES (%s) uses prototype search%s.", name.c_str(), use_index ? " with vp-tree index" : "");
+    }
+
+
+    void GMES::disable_prototype_search(void)
+    {
+        for (std::size_t n = 0; n < Nmax; ++n)
+            refresh_prediction_error(n);
+        prototypes.reset();
+    }
+
+
+    void GMES::refresh_prototypes(void)
+    {
+        if (prototypes == nullptr) return;
+        for (std::size_t n = 0; n < Nmax; ++n)
+            update_prototype(n);
+        if (prototypes->is_index_enabled()) prototypes->rebuild();
+    }
+
+
+    void GMES::update_prototype(std::size_t index)
+    {
+        if (prototypes == nullptr) return;
+        if (expert[index].exists) prototypes->set(index, expert[index].get_predictor().get_weights());
+        else prototypes->remove(index);
+    }
+
+
     /* find the expert for which the
      * learning capacity is maximal.
      */
@@ -204,16 +367,12 @@
     }
 
 
-    /* count number of experts where
-     * the 'exists' flag is set to true
+    /* number of experts where the 'exists' flag is
+     * set to true, as counted by the expert vector
      */
     std::size_t GMES::count_existing_experts(void) const
     {
-        std::size_t num_experts = 0;
-        for (std::size_t n = 0; n < Nmax; ++n)
-            if (expert[n].exists)
-                ++num_experts;
-        return num_experts;
+        return expert.get_number_of_existing();
     }
 
 
@@ -233,16 +392,6 @@
     }
 
 
-    /* remove all transitions emanating
-     * from a a certain node 'to_clear'
-     */
-    void GMES::clear_transitions_to(std::size_t to_clear)
-    {
-        for (std::size_t n = 0; n < Nmax; ++n)
-            expert[n].transition[to_clear] = .0;
-    }
-
-
     void GMES::enable_learning(bool enable) {
         if (learning_enabled != enable) {
             sts_msg("GMES (%s) learning is now %s", name.c_str(), enable? "ENABLED":"DISABLED");
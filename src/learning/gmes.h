@@ -7,12 +7,16 @@
 #include <common/log_messages.h>
 #include <common/modules.h>
 #include <common/vector_n.h>
+#include <common/thread_pool.h>
+#include <common/fast_math.h>
 #include <control/statemachine.h>
 #include <learning/expert_vector.h>
 #include <learning/gmes_constants.h>
 #include <learning/q_function.h>
 #include <learning/payload.h>
 #include <learning/learning_machine_interface.h>
+#include <learning/prototype_search.h>
+#include <learning/transition_graph.h>
 /* first object oriented implementation of GMES
  * 23.02.2015 (Elmar ist heute 16 Monate alt geworden) */
 
@@ -63,16 +67,43 @@ public:
     double      get_learning_progress     (void) const { return learning_progress;     }
     double      get_min_prediction_error  (void) const { return min_prediction_error;  }
 
-    VectorN const& get_activations        (void) const { return activations;           }
+    /* activations are evaluated lazily on read, once per cycle */
+    double         get_activation         (std::size_t n) const;
+    VectorN const& get_activations        (void) const;
+    learning::Transition_Graph const& get_transitions(void) const { return transitions; }
+
+    /* exp of activations and learning capacity, exact by default */
+    void set_math_mode(fast_math::Mode mode) { math_mode = mode; invalidate_activations(); }
 
 
     void enable_learning(bool enable);
     void execute_cycle(void);
-    void update_activations(void);
+    void update_activations(void) const; // evaluate all activations now
+    void invalidate_activations(void);   // next read re-evaluates
+
+    /* distribute the predictions of all experts over a thread pool, each
+     * task predicts 'grain_size' experts. the winner is identical to serial. */
+    void enable_parallel_prediction(common::Thread_Pool& pool, std::size_t grain_size = 1);
+    void disable_parallel_prediction(void) { pool = nullptr; }
+    bool is_parallel_prediction_enabled(void) const { return pool != nullptr; }
+
+    /* for simple predictors only: find the winner as the nearest prototype
+     * in a contiguous matrix with partial distances and optionally a
+     * vantage-point tree index (max_checks = 0: exact). The prediction
+     * errors are refreshed from the distances the search evaluated, those
+     * of experts it skipped are predicted when their activation is read. */
+    void enable_prototype_search(bool use_index = false, std::size_t max_checks = 0);
+    void disable_prototype_search(void);
+    bool is_prototype_search_enabled(void) const { return prototypes != nullptr; }
+    void refresh_prototypes(void); // call after changing the expert's weights from outside, e.g. loading
 
 private:
 
     std::size_t determine_winner          (void);
+    std::size_t determine_winner_parallel (void);
+    std::size_t determine_winner_by_prototypes(void);
+    void        update_prototype(std::size_t index);
+    void        refresh_prediction_error(std::size_t index) const;
     std::size_t arg_max_capacity          (void) const;
     std::size_t count_existing_experts    (void) const;
     void        check_learning_capacity   (void) const;
@@ -82,8 +113,6 @@ private:
     void        refresh_transitions       (void);
     void        insert_expert_on_demand   (void);
 
-    void        clear_transitions_to(std::size_t to_clear);
-
     Expert_Vector& expert;
     const std::size_t Nmax;
 
@@ -100,8 +129,21 @@ private:
     std::size_t recipient;          // donee of the learning capacity consumed by the winner
     std::size_t to_insert;          // expert to be inserted on demand
 
-    VectorN     activations;
+    mutable VectorN                  activations;
+    mutable std::vector<std::size_t> activation_stamp;    // version of each activation
+    mutable std::size_t              activations_complete; // version at which all were evaluated
+    std::size_t                      activation_version;
     bool        new_node;
+    fast_math::Mode math_mode = fast_math::Mode::exact;
+
+    learning::Transition_Graph transitions; // validity of connections
+
+    common::Thread_Pool* pool;      // not owned, serial prediction if null
+    std::size_t          grain_size;
+    VectorN              prediction_errors;
+
+    std::unique_ptr<learning::Prototype_Search> prototypes; // null if disabled
+    mutable std::vector<bool> outdated_error; // skipped by the prototype search, predicted on read
 
     std::string name;
 
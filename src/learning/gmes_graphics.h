@@ -48,8 +48,8 @@ public:
                         fmin(2.0, expert[i].learning_capacity));
             for (unsigned int j = 0; j < expert.size(); ++j) {
                 if (!expert[j].does_exists()) continue;
-                graph.update_edge(i, j, (unsigned char) 255 * expert[i].transition[j]);
-                graph.update_edge(j, i, (unsigned char) 255 * expert[j].transition[i]);
+                graph.update_edge(i, j, (unsigned char) 255 * gmes.transitions.value(i, j));
+                graph.update_edge(j, i, (unsigned char) 255 * gmes.transitions.value(j, i));
             }
         }
     }
@@ -60,8 +60,8 @@ public:
         plot.add_sample((float) input[0], (float) input[1], (float) input[2]);
 
         for (unsigned int n = 0; n < expert.size(); ++n) {
-            graph.update_edge(n, gmes.get_winner(), (unsigned char) 255 * expert[n].transition[gmes.get_winner()]);
-            graph.update_edge(gmes.get_winner(), n, (unsigned char) 255 * expert[gmes.get_winner()].transition[n]);
+            graph.update_edge(n, gmes.get_winner(), (unsigned char) 255 * gmes.transitions.value(n, gmes.get_winner()));
+            graph.update_edge(gmes.get_winner(), n, (unsigned char) 255 * gmes.transitions.value(gmes.get_winner(), n));
         }
 
         graph.update_node(gmes.get_recipient(),
@@ -89,7 +89,7 @@ public:
         /* original order changed, because robot.update must be executed between steps 1. + 2. */
 
         /** 2.) Prediction */
-        read_next_state(input);
+        read_next_state(input.values());
         predict();
 
         /** 3.) Reconstruction */
@@ -41,8 +41,8 @@ public:
     : sensor_vector(joints.size())
     {
         for (robots::Joint_Model const& j : joints)
-            sensors.emplace_back(j.name, [&j](){ return clip(j.motor.get()); });
-            //sensors.emplace_back(j.name, [&j](){ return clip(j.motor.get() + rand_norm_zero_mean(0.01), 1.0); });
+            add_sensor(j.name, [&j](){ return clip(j.motor.get()); });
+            //add_sensor(j.name, [&j](){ return clip(j.motor.get() + rand_norm_zero_mean(0.01), 1.0); });
     }
 };
 
@@ -1,7 +1,9 @@
 #ifndef MOTOR_PREDICTOR_H_INCLUDED
 #define MOTOR_PREDICTOR_H_INCLUDED
 
+#include <memory>
 #include <common/log_messages.h>
+#include <common/random_stream.h>
 #include <robots/robot.h>
 #include <control/controlparameter.h>
 #include <control/jointcontrol.h>
@@ -12,6 +14,24 @@
 
 namespace learning {
 
+/* Controller inputs prepared once per cycle from the robot's state and
+ * shared by all motor predictors of an expert vector, which only add
+ * their own noise. prepare() must be called before the predictions of
+ * a cycle, see Expert_Vector::begin_cycle. */
+class Motor_Inputs {
+public:
+    typedef std::vector<control::sym_input<>> vector_t;
+
+    Motor_Inputs(robots::Robot_Interface const& robot) : input(control::get_number_of_inputs(robot)) {}
+
+    void prepare(robots::Robot_Interface const& robot) { control::prepare_inputs(robot, 1.0, input); }
+
+    vector_t const& get(void) const { return input; }
+
+private:
+    vector_t input;
+};
+
 
 class Motor_Predictor : public Predictor_Base {
 public:
@@ -22,6 +42,8 @@ public:
                    , std::size_t experience_size
                    , control::Control_Parameter const& parameter
                    , double noise_level
+                   , uint32_t noise_seed = 0
+                   , std::shared_ptr<const Motor_Inputs> shared_inputs = nullptr
                    )
     : Predictor_Base(motor_targets, learning_rate, random_weight_range, experience_size)
     , robot(robot)
@@ -30,6 +52,8 @@ public:
     , params(control::turn_symmetry(robot, control::make_asymmetric(robot, parameter)))
     , params_changed(false)
     , noise_level(noise_level)
+    , noise(noise_seed)
+    , shared_inputs(shared_inputs)
     {
         core.apply_weights(robot, params.get_parameter());
     }
@@ -41,7 +65,11 @@ public:
     }
 
     double predict(void) override {
-        core.prepare_inputs(robot);
+        if (shared_inputs) {
+            assert(core.gain == 1.0);
+            core.input = shared_inputs->get();
+        } else
+            core.prepare_inputs(robot);
         add_noise_to_inputs(core.input, noise_level);
         assert(!(params.is_mirrored() and params.is_symmetric()));
         core.update_outputs(robot, params.is_symmetric(), params.is_mirrored());
@@ -62,11 +90,12 @@ public:
         for (auto& w_k : core.weights)
             for (auto& w_ik : w_k)
                 w_ik += random_value(-random_weight_range,+random_weight_range); // don't override weights initialized by params
+        core.update_layout();
 
         auto initial_experience = input.get(); /**TODO this code is the same in state predictor, move to base?*/
         for (auto& w: initial_experience)
             w += random_value(-random_weight_range, random_weight_range);
-        experience.assign(experience.size(), initial_experience);
+        experience.fill(initial_experience);
 
         prediction_error = predictor_constants::error_min;
 
@@ -97,14 +126,19 @@ public:
     vector_t const& get_weights(void) const override { assert(false); return dummy; /*not implemented*/ }
     vector_t      & set_weights(void)       override { assert(false); return dummy; /*not implemented*/ }
 
+    /* input noise is drawn from the predictor's own stream */
+    bool supports_concurrent_prediction(void) const override { return true; }
+
 private:
     robots::Robot_Interface const&          robot;
-    control::Fully_Connected_Symmetric_Core core;
+    control::Fully_Connected_Symmetric_Core<> core;
     sensor_vector const&                    motor_targets;
 
     mutable control::Control_Parameter      params; // for loading, saving, buffering
     mutable bool                            params_changed;
     const double                            noise_level;
+    common::Random_Stream                   noise;
+    std::shared_ptr<const Motor_Inputs>     shared_inputs;
 
     VectorN dummy = {}; // remove when implementing get_weights
 
@@ -120,22 +154,24 @@ private:
         assert(motor_targets.size() == weights.size());
         assert(inputs.size() == weights.at(0).size());
 
-        for (std::size_t k = 0; k < motor_targets.size(); ++k) { // for num of motor outputs
-            double err = motor_targets[k] - predictions[k];
+        auto const targets = motor_targets.values();
+        for (std::size_t k = 0; k < targets.size(); ++k) { // for num of motor outputs
+            double err = targets[k] - predictions[k];
             for (std::size_t i = 0; i < weights[k].size(); ++i) { // for num of inputs
                 weights[k][i] += learning_rate * err * tanh_(predictions[k]) * inputs[i].x;
                 /** This gradient is intentionally wrong, derivative of clip transfer function would be not continuous. */
             }
         }
+        core.update_layout();
         params_changed = true; /**TODO: move to learn_from_experience, if supported */
     }
 
     void learn_from_experience(std::size_t /*skip_idx*/) override { assert(false && "Learning from experience is not implemented yet."); }
 
-    void add_noise_to_inputs(std::vector<control::sym_input>& inputs, double sigma) {
+    void add_noise_to_inputs(std::vector<control::sym_input<>>& inputs, double sigma) {
         const double s = sigma/sqrt(inputs.size());
         for (auto &in : inputs) {
-            const double rndval = rand_norm_zero_mean(s);
+            const double rndval = noise.normal(s);
             in.x += rndval;
             in.y += rndval;
         }
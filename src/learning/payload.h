@@ -2,6 +2,8 @@
 #define PAYLOAD_H_INCLUDED
 
 #include <vector>
+#include <memory>
+#include <algorithm>
 #include <common/static_vector.h>
 #include <common/log_messages.h>
 #include <learning/q_function.h>
@@ -14,14 +16,68 @@ public:
     Empty_Payload& operator=(const Empty_Payload& /*other*/) { return *this; };
 };
 
+/* Q-values and eligibility traces of one state.
+ *
+ * The values live in a Q tensor, either shared by all states of a layer,
+ * i.e. one contiguous block, or a private one. 'policies' and
+ * 'eligibility_trace' are views of the state's slice in the tensor.
+ */
 class State_Payload
 {
 public:
+    /* policies of this state */
+    class policies_t {
+        learning::Q_Tensor* tensor;
+        std::size_t         state;
+    public:
+        policies_t(learning::Q_Tensor* tensor, std::size_t state) : tensor(tensor), state(state) {}
+        policies_t(const policies_t& other) = default;
+        std::size_t size(void) const { return tensor->get_number_of_policies(); }
+        Policy operator[](std::size_t p) const { assert(p < size()); return Policy(tensor, state, p); }
+
+        /* copies the values with flaws */
+        policies_t& operator=(const policies_t& other) {
+            assert(size() == other.size());
+            for (std::size_t p = 0; p < size(); ++p)
+                (*this)[p] = other[p];
+            return *this;
+        }
+    };
+
+    /* eligibility traces of this state */
+    class traces_t {
+        learning::Q_Tensor* tensor;
+        std::size_t         state;
+    public:
+        traces_t(learning::Q_Tensor* tensor, std::size_t state) : tensor(tensor), state(state) {}
+        traces_t(const traces_t& other) = default;
+        std::size_t size(void) const { return tensor->get_number_of_actions(); }
+        Eligibility operator[](std::size_t a) const { assert(a < size()); return Eligibility(tensor->trace(state)[a]); }
+        double* data(void) const { return tensor->trace(state); }
+
+        /* copies the values */
+        traces_t& operator=(const traces_t& other) {
+            assert(size() == other.size());
+            std::copy(other.data(), other.data() + other.size(), data());
+            return *this;
+        }
+    };
+
+    /* state of a shared tensor */
+    explicit State_Payload(std::shared_ptr<learning::Q_Tensor> const& tensor)
+    : tensor(tensor)
+    , state(tensor->add_state())
+    , policies(tensor.get(), state)
+    , eligibility_trace(tensor.get(), state)
+    {}
+
+    /* private tensor */
     State_Payload(const Action_Module_Interface& actions, std::size_t number_of_policies, double q_initial)
-    : policies(number_of_policies, actions, q_initial)
-    , eligibility_trace(actions.get_number_of_actions())
+    : State_Payload(std::make_shared<learning::Q_Tensor>(actions, number_of_policies, q_initial, 1))
     {}
 
+    State_Payload(State_Payload&& other) = default;
+
     State_Payload& operator=(const State_Payload& other) {
         assert(this != &other); // no self-assignment
         copy_with_flaws(other); // redirect copy-assignment
@@ -35,6 +91,14 @@ public:
         eligibility_trace[to_idx] = eligibility_trace[from_idx];
     }
 
+    /* rows of the tensor, for kernels */
+    double* get_qvalues(std::size_t policy) const { return tensor->q(state, policy); }
+    double* get_traces (void)               const { return tensor->trace(state); }
+
+    /* Q(p,.) += alpha[p] * x for all policies p */
+    void update(const double* alpha, const double* x) { tensor->update(state, alpha, x); }
+    void update_relaxed(const double* alpha, const double* x) { tensor->update_relaxed(state, alpha, x); }
+
 private:
     void copy_with_flaws(const State_Payload& other)
     {
@@ -44,9 +108,13 @@ private:
         /* inherit flawless eligibility traces */
         eligibility_trace = other.eligibility_trace;
     }
+
+    std::shared_ptr<learning::Q_Tensor> tensor;
+    std::size_t                         state;
+
 public:
-    copyable_static_vector<Policy> policies;
-    copyable_static_vector<Eligibility> eligibility_trace;
+    policies_t policies;
+    traces_t   eligibility_trace;
 
     friend class SARSA;
     friend class Epsilon_Greedy;
@@ -11,14 +11,16 @@
         //test_range(predictions, -1.0, 1.0, "predictions");
 
         /* sum of squared distances to input */
-        const double error = squared_distance(input, predictions);
+        return prediction_error_from(squared_distance(input.values(), predictions));
+    }
 
+    double Predictor_Base::prediction_error_from(double squared_dist) {
         /** The prediction error is being normalized by the number
          *  of weights/inputs and the max. input range [-1,+1] so
          *  that it is independent of the size of input space.
          *  Also it should be limited [0..1].
          */
-        prediction_error = normalize_factor * sqrt(error);
+        prediction_error = normalize_factor * sqrt(squared_dist);
         assert_in_range(prediction_error, predictor_constants::error_min, predictor_constants::error_max);
         return prediction_error;
     }
@@ -42,10 +44,11 @@
     void Predictor::initialize_randomized(void)
     {
         assert(weights.size() == input.size());
-        for (std::size_t m = 0; m < input.size(); ++m)
-            weights[m] = input[m] + random_value(-random_weight_range,
+        auto const x = input.values();
+        for (std::size_t m = 0; m < x.size(); ++m)
+            weights[m] = x[m] + random_value(-random_weight_range,
                                                  +random_weight_range);
-        experience.assign(experience.size(), weights);
+        experience.fill(weights);
         prediction_error = predictor_constants::error_min;
     }
 
@@ -56,7 +59,7 @@
     {
         assert(weights.size() == input.size());
         weights = input.get();
-        experience.assign(experience.size(), weights);
+        experience.fill(weights);
         prediction_error = predictor_constants::error_min;
     }
 
@@ -80,6 +83,13 @@
         return calculate_prediction_error();
     }
 
+    /* same as predict, with the squared distance of the weights
+     * to the input already known, e.g. from a prototype search
+     */
+    double Predictor::predict(double squared_dist) {
+        return prediction_error_from(squared_dist);
+    }
+
     /* adapt the weights to the current
      * input sample and learn from experience
      */
@@ -100,31 +110,31 @@
 
             /** Insert current input into random position of experience list.
              *  This must be done after adaptation to guarantee a positive learning progress */
-            experience[rand_idx] = input.get();
+            experience.replace(rand_idx, input.values());
         }
     }
 
 
 
     void Predictor::learn_from_input_sample(void) {
-        for (std::size_t m = 0; m < input.size(); ++m)
-            weights[m] += learning_rate * (input[m] - weights[m]) / experience.size();
+        auto const x = input.values();
+        for (std::size_t m = 0; m < x.size(); ++m)
+            weights[m] += learning_rate * (x[m] - weights[m]) / experience.size();
     }
 
 
 
     void Predictor::learn_from_experience(std::size_t skip_idx) {
         assert(experience.size() > 1);
-        assert(experience[0].size() == weights.size());
-        /* learn the list */
+        assert(experience.dimension() == weights.size());
+        /** learn the list, i.e. all samples except the skipped one:
+         *  sum_{i != skip} (x_i - w) = (S - x_skip) - (M-1) w,
+         *  with S being the running sum of all M samples */
+        const double others = experience.size() - 1;
+        const auto skipped = experience[skip_idx];
         for (std::size_t m = 0; m < weights.size(); ++m) {
-            double delta = .0;
-            for (std::size_t i = 0; i < experience.size(); ++i) {
-                if (i != skip_idx)
-                    delta += (experience[i][m] - weights[m]);
-            }
-            delta *= learning_rate / (experience.size() - 1);
-            weights[m] += delta;
+            const double delta = (experience.sum(m) - skipped[m]) - others * weights[m];
+            weights[m] += delta * learning_rate / others;
         }
     }
 
@@ -10,6 +10,7 @@
 #include <common/static_vector.h>
 #include <common/save_load.h>
 #include <control/sensorspace.h>
+#include <learning/experience_replay.h>
 
 /** Notes regarding normalizing the prediction error
  *  N: input size
@@ -38,6 +39,7 @@ class Predictor_Base : public common::Save_Load {
 protected:
 
     double calculate_prediction_error();
+    double prediction_error_from(double squared_dist);
 
     /* constants */
     const sensor_input_interface& input;
@@ -47,12 +49,13 @@ protected:
 
     /* non-const */
     double               prediction_error;
-    std::vector<VectorN> experience;       // replay buffer
+    learning::Experience_Replay experience; // replay buffer
 
     Predictor_Base& operator=(const Predictor_Base& other)
     {
         prediction_error = other.prediction_error;
         assert(experience.size() == other.experience.size());
+        assert(experience.dimension() == other.experience.dimension());
         experience = other.experience;
         return *this;
     }
@@ -69,7 +72,7 @@ public:
     , random_weight_range(random_weight_range)
     , normalize_factor( 1.0 / (sqrt(input.size() * 4)))
     , prediction_error(predictor_constants::error_min)
-    , experience(experience_size)
+    , experience(experience_size, input.size()) // zero initialized
     {
         //dbg_msg("Experience Replay: %s (%ul)", (experience_size > 1 ? "on" : "off"), experience_size);
         //dbg_msg("Input dimension: %u", input.size());
@@ -77,13 +80,13 @@ public:
         assert_in_range(experience_size,      1ul, 1000ul);
         assert_in_range(learning_rate,        0.0,   +1.0);
         assert_in_range(random_weight_range, -1.0,   +1.0);
-
-        experience.assign(experience.size(), VectorN(input.size(), .0) ); // zero initialize experience anyhow
     }
 
     /* non-virtual */
     double get_prediction_error(void) const { return prediction_error; }
-    std::vector<VectorN> const& get_experience(void) const { return experience; }
+    learning::Experience_Replay const& get_experience(void) const { return experience; }
+    void share_experience(std::shared_ptr<learning::Experience_Pool> pool) { experience.move_to(pool); }
+    sensor_input_interface const& get_input(void) const { return input; }
     void adapt(void);
 
     /* virtual */
@@ -104,6 +107,10 @@ public:
     virtual vector_t const& get_weights(void) const = 0;
     virtual vector_t      & set_weights(void)       = 0;
 
+    /* predict() of different experts may run concurrently, i.e. it touches
+     * no state shared with other predictors (e.g. the global rand()) */
+    virtual bool supports_concurrent_prediction(void) const { return true; }
+
 private:
     virtual void learn_from_input_sample(void) = 0;
     virtual void learn_from_experience(std::size_t /*skip_idx*/) {
@@ -133,6 +140,7 @@ public:
     Predictor_Base::vector_t const& get_prediction(void) const override { return weights; }
 
     double predict(void) override;
+    double predict(double squared_dist);
     double verify(void) override { return predict(); }
 
     void initialize_randomized(void) override;
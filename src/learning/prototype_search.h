@@ -0,0 +1,334 @@
+#ifndef PROTOTYPE_SEARCH_H_INCLUDED
+#define PROTOTYPE_SEARCH_H_INCLUDED
+
+#include <cmath>
+#include <vector>
+#include <cassert>
+#include <algorithm>
+#include <common/log_messages.h>
+#include <common/vector_n.h>
+#include <common/matrix.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace learning {
+
+/* Nearest prototype search for GMES with simple predictors.
+ *
+ * All prototypes (i.e. the weights of the experts) are held as rows of one
+ * contiguous, aligned and zero-padded matrix, so that the squared distances
+ * to the input can be computed with a SIMD kernel. The linear search stops
+ * each distance as soon as it exceeds the best one found so far.
+ *
+ * Optionally, a vantage-point tree over the prototypes prunes the search
+ * using the triangle inequality. Prototypes which moved after the tree was
+ * built are marked dirty and checked linearly, the tree is rebuilt when too
+ * many of them have piled up. With max_checks = 0 the tree search is exact,
+ * otherwise it stops after max_checks distance evaluations (approximate).
+ * The distances evaluated completely during the last search can be read
+ * back, e.g. to refresh the prediction errors of the other experts.
+ */
+
+namespace prototype_kernel {
+
+    const std::size_t block_size = 4; // doubles per block, rows are padded to multiples of it
+    const std::size_t alignment  = 32; // bytes
+
+    /* squared euclidean distance, n must be a multiple of block_size */
+    inline double squared_distance(const double* a, const double* b, std::size_t n)
+    {
+#if defined(__SSE2__)
+        __m128d s0 = _mm_setzero_pd(), s1 = _mm_setzero_pd();
+        for (std::size_t i = 0; i < n; i += block_size) {
+            const __m128d d0 = _mm_sub_pd(_mm_load_pd(a + i    ), _mm_load_pd(b + i    ));
+            const __m128d d1 = _mm_sub_pd(_mm_load_pd(a + i + 2), _mm_load_pd(b + i + 2));
+            s0 = _mm_add_pd(s0, _mm_mul_pd(d0, d0));
+            s1 = _mm_add_pd(s1, _mm_mul_pd(d1, d1));
+        }
+        s0 = _mm_add_pd(s0, s1);
+        return _mm_cvtsd_f64(_mm_add_sd(s0, _mm_unpackhi_pd(s0, s0)));
+#else
+        double s[block_size] = {.0, .0, .0, .0};
+        for (std::size_t i = 0; i < n; i += block_size)
+            for (std::size_t k = 0; k < block_size; ++k)
+                s[k] += (a[i+k] - b[i+k]) * (a[i+k] - b[i+k]);
+        return (s[0] + s[1]) + (s[2] + s[3]);
+#endif
+    }
+
+    /* partial distance, returns a value > bound as soon as the
+     * accumulated distance exceeds the bound (checked every 2 blocks) */
+    inline double squared_distance_bounded(const double* a, const double* b, std::size_t n, double bound)
+    {
+        const std::size_t step = 2*block_size;
+        double sum = .0;
+        std::size_t i = 0;
+        for (; i + step <= n; i += step) {
+            sum += squared_distance(a + i, b + i, step);
+            if (sum > bound) return sum;
+        }
+        if (i < n) sum += squared_distance(a + i, b + i, n - i);
+        return sum;
+    }
+
+} // namespace prototype_kernel
+
+
+class Prototype_Matrix
+{
+    Prototype_Matrix(const Prototype_Matrix& other) = delete;
+    Prototype_Matrix& operator=(const Prototype_Matrix& other) = delete;
+
+    common::Matrix<double> mat; // rows aligned and zero-padded to whole blocks
+
+public:
+    Prototype_Matrix(std::size_t rows, std::size_t dim)
+    : mat(rows, dim)
+    {
+        static_assert(common::Matrix<double>::alignment == prototype_kernel::alignment, "Rows must be aligned for the kernel.");
+        assert(mat.stride() % prototype_kernel::block_size == 0);
+    }
+
+    std::size_t get_rows  (void) const { return mat.rows();   }
+    std::size_t get_dim   (void) const { return mat.cols();   }
+    std::size_t get_stride(void) const { return mat.stride(); }
+
+          double* row(std::size_t i)       { return mat.row(i).data(); }
+    const double* row(std::size_t i) const { return mat.row(i).data(); }
+
+    template <typename Vector_t>
+    void set_row(std::size_t i, Vector_t const& vec) {
+        assert(vec.size() == mat.cols());
+        double* r = row(i);
+        for (std::size_t k = 0; k < mat.cols(); ++k) r[k] = vec[k];
+    }
+
+    void copy_row(std::size_t i, Prototype_Matrix const& other) {
+        assert(other.get_stride() == get_stride());
+        std::copy(other.row(i), other.row(i) + get_stride(), row(i));
+    }
+};
+
+
+class Prototype_Search
+{
+    struct Node {
+        std::size_t index;  // vantage point
+        double      mu;     // median distance to vantage point
+        int         inside; // child nodes, -1 if none
+        int         outside;
+    };
+
+    Prototype_Matrix         prototypes; // current positions
+    Prototype_Matrix         snapshot;   // positions when the tree was built
+    Prototype_Matrix         query;      // input, single row
+    std::vector<bool>        active;
+    std::vector<bool>        dirty;
+    std::vector<std::size_t> dirty_list;
+    std::vector<Node>        tree;
+    int                      root;
+
+    bool                     use_index;
+    std::size_t              max_checks;
+    std::size_t              rebuild_threshold;
+    std::size_t              num_checks; // distance evaluations of last search
+    std::vector<double>      distances;  // squared distances of the last search
+    std::vector<std::size_t> distance_stamp;
+    std::size_t              search_stamp;
+
+public:
+    Prototype_Search(std::size_t number_of_prototypes, std::size_t dim)
+    : prototypes(number_of_prototypes, dim)
+    , snapshot(number_of_prototypes, dim)
+    , query(1, dim)
+    , active(number_of_prototypes, false)
+    , dirty(number_of_prototypes, false)
+    , dirty_list()
+    , tree()
+    , root(-1)
+    , use_index(false)
+    , max_checks(0)
+    , rebuild_threshold(std::max<std::size_t>(8, 2 * std::sqrt(number_of_prototypes)))
+    , num_checks(0)
+    , distances(number_of_prototypes, .0)
+    , distance_stamp(number_of_prototypes, 0)
+    , search_stamp(0)
+    {
+        assert(number_of_prototypes > 0 and dim > 0);
+        tree.reserve(number_of_prototypes);
+        dirty_list.reserve(number_of_prototypes);
+    }
+
+    void enable_index(std::size_t max_distance_checks = 0) {
+        use_index = true;
+        max_checks = max_distance_checks;
+        rebuild();
+    }
+
+    void disable_index(void) { use_index = false; }
+
+    bool is_index_enabled(void) const { return use_index; }
+    std::size_t get_number_of_checks(void) const { return num_checks; }
+    std::size_t size(void) const { return active.size(); }
+
+    /* prototype was created or moved */
+    template <typename Vector_t>
+    void set(std::size_t i, Vector_t const& weights) {
+        prototypes.set_row(i, weights);
+        active[i] = true;
+        mark_dirty(i);
+    }
+
+    void remove(std::size_t i) {
+        active[i] = false;
+        mark_dirty(i);
+    }
+
+    template <typename Input_t>
+    void set_input(Input_t const& input) { query.set_row(0, input); }
+
+    /* returns the index of the nearest active prototype to the
+     * current input, ties are resolved in favor of the lower index */
+    std::size_t nearest(double& squared_dist)
+    {
+        num_checks = 0;
+        ++search_stamp;
+        std::size_t best = active.size();
+        double best_d2 = INFINITY;
+
+        if (not use_index) {
+            for (std::size_t i = 0; i < active.size(); ++i)
+                if (active[i]) check_candidate(i, best, best_d2);
+        } else {
+            if (dirty_list.size() > rebuild_threshold) rebuild();
+            for (std::size_t i : dirty_list)
+                if (active[i]) check_candidate(i, best, best_d2);
+            search_tree(best, best_d2);
+        }
+        assert(best < active.size() && "No active prototype.");
+        squared_dist = best_d2;
+        return best;
+    }
+
+    /* true if the last search evaluated the distance of prototype i
+     * completely, i.e. it was not pruned or cut off at the bound */
+    bool last_distance(std::size_t i, double& squared_dist) const {
+        assert(i < distances.size());
+        if (distance_stamp[i] != search_stamp) return false;
+        squared_dist = distances[i];
+        return true;
+    }
+
+    void rebuild(void)
+    {
+        std::vector<std::size_t> indices;
+        for (std::size_t i = 0; i < active.size(); ++i) {
+            dirty[i] = false;
+            if (not active[i]) continue;
+            snapshot.copy_row(i, prototypes);
+            indices.push_back(i);
+        }
+        dirty_list.clear();
+        tree.clear();
+        root = build(indices, 0, indices.size());
+    }
+
+private:
+
+    double distance_to(Prototype_Matrix const& mat, std::size_t i) {
+        ++num_checks; // same summation order as the bounded version
+        return prototype_kernel::squared_distance_bounded(query.row(0), mat.row(i), mat.get_stride(), INFINITY);
+    }
+
+    void record_distance(std::size_t i, double d2) {
+        distances[i] = d2;
+        distance_stamp[i] = search_stamp;
+    }
+
+    void check_candidate(std::size_t i, std::size_t& best, double& best_d2) {
+        ++num_checks;
+        const double d2 = prototype_kernel::squared_distance_bounded(query.row(0), prototypes.row(i), prototypes.get_stride(), best_d2);
+        if (d2 <= best_d2) record_distance(i, d2); // not cut off
+        if (d2 < best_d2 or (d2 == best_d2 and i < best)) {
+            best = i;
+            best_d2 = d2;
+        }
+    }
+
+    void mark_dirty(std::size_t i) {
+        if (dirty[i]) return;
+        dirty[i] = true;
+        dirty_list.push_back(i);
+    }
+
+    int build(std::vector<std::size_t>& indices, std::size_t begin, std::size_t end)
+    {
+        if (begin == end) return -1;
+        const int node = tree.size();
+        tree.push_back(Node{indices[begin], .0, -1, -1});
+        if (end - begin == 1) return node;
+
+        const double* vp = snapshot.row(indices[begin]);
+        const std::size_t stride = snapshot.get_stride();
+        std::vector<std::pair<double, std::size_t>> dists;
+        dists.reserve(end - begin - 1);
+        for (std::size_t k = begin + 1; k < end; ++k)
+            dists.emplace_back(std::sqrt(prototype_kernel::squared_distance(vp, snapshot.row(indices[k]), stride)), indices[k]);
+
+        const std::size_t mid = dists.size() / 2;
+        std::nth_element(dists.begin(), dists.begin() + mid, dists.end());
+        for (std::size_t k = 0; k < dists.size(); ++k)
+            indices[begin + 1 + k] = dists[k].second;
+
+        const double mu = dists[mid].first;
+        const int inside  = build(indices, begin + 1, begin + 1 + mid);
+        const int outside = build(indices, begin + 1 + mid, end);
+        tree[node].mu      = mu;
+        tree[node].inside  = inside;
+        tree[node].outside = outside;
+        return node;
+    }
+
+    void search_tree(std::size_t& best, double& best_d2)
+    {
+        const double slack = 1e-9; // guard against rounding in the triangle inequality
+        std::vector<std::pair<int, double>> stack; // node and lower bound of distances within
+        if (root >= 0) stack.emplace_back(root, .0);
+
+        while (not stack.empty())
+        {
+            if (max_checks > 0 and num_checks >= max_checks) return; // approximate
+            const Node& node = tree[stack.back().first];
+            const double bound = stack.back().second;
+            stack.pop_back();
+
+            if (bound > std::sqrt(best_d2) * (1.0 + slack) + slack) continue;
+
+            const double d2 = distance_to(snapshot, node.index);
+            if (not dirty[node.index]) record_distance(node.index, d2); // snapshot is current
+            if (not dirty[node.index] and (d2 < best_d2 or (d2 == best_d2 and node.index < best))) {
+                best = node.index;
+                best_d2 = d2;
+            }
+
+            const double d = std::sqrt(d2);
+            const std::pair<int, double> inside (node.inside , std::max(.0, d - node.mu));
+            const std::pair<int, double> outside(node.outside, std::max(.0, node.mu - d));
+
+            /* push the farther side first, so that the nearer one is searched first */
+            if (d < node.mu) {
+                if (outside.first >= 0) stack.push_back(outside);
+                if (inside .first >= 0) stack.push_back(inside);
+            } else {
+                if (inside .first >= 0) stack.push_back(inside);
+                if (outside.first >= 0) stack.push_back(outside);
+            }
+        }
+    }
+};
+
+} // namespace learning
+
+#endif // PROTOTYPE_SEARCH_H_INCLUDED
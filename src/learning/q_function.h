@@ -6,48 +6,63 @@
 #include <common/static_vector.h>
 #include <common/log_messages.h>
 #include <learning/action_module.h>
+#include <learning/q_tensor.h>
 
+/* Q-values of one state and policy, a view into the Q tensor. */
 class Policy {
 
-    const Action_Module_Interface& actions;
+    learning::Q_Tensor* tensor;
+    std::size_t         state;
+    std::size_t         policy;
 
 public:
 
-    static_vector<double> qvalues;
+    /* row of Q-values over actions */
+    class qvalues_t {
+        learning::Q_Tensor* tensor;
+        std::size_t         state;
+        std::size_t         policy;
+    public:
+        qvalues_t(learning::Q_Tensor* tensor, std::size_t state, std::size_t policy) : tensor(tensor), state(state), policy(policy) {}
+        std::size_t size(void) const { return tensor->get_number_of_actions(); }
+        double& operator[](std::size_t a) const { assert(a < size()); return data()[a]; }
+        double* data (void) const { return tensor->q(state, policy); }
+        double* begin(void) const { return data(); }
+        double* end  (void) const { return data() + size(); }
+        double get_max(void) const { return common::kernel::maximum(data(), size()); }
+    };
 
-    Policy(const Action_Module_Interface& actions, double initial)
-    : actions(actions)
-    , qvalues(actions.get_number_of_actions())
-    {
-//        dbg_msg("Creating Policies.");
-        assert(actions.get_number_of_actions() >= 1);
-        for (std::size_t i = 0; i < qvalues.size(); ++i)
-            qvalues[i] = initial + rand_norm_zero_mean(0.01);
-    }
+    qvalues_t qvalues;
 
-    double get_max_q(void) const
-    {
-        double max_q = qvalues[0];
-        for (std::size_t i = 1; i < qvalues.size(); ++i)
-            if (actions.exists(i) and qvalues[i] > max_q)
-                max_q = qvalues[i];
-        return max_q;
-    }
-    std::size_t get_argmax_q(void) const
-    {
-        double max_q = qvalues[0];
-        std::size_t argmax = 0;
+    Policy(learning::Q_Tensor* tensor, std::size_t state, std::size_t policy)
+    : tensor(tensor)
+    , state(state)
+    , policy(policy)
+    , qvalues(tensor, state, policy)
+    {}
+
+    Policy(const Policy& other) = default;
+
+    double get_max_q(void) const { return qvalues[get_argmax_q()]; }
 
+    std::size_t get_argmax_q(void) const { return tensor->argmax(state, policy); }
+
+    std::size_t get_argmin_q(void) const
+    {
+        Action_Module_Interface const& actions = tensor->get_actions();
+        double min_q = qvalues[0];
+        std::size_t argmin = 0;
         for (std::size_t i = 1; i < qvalues.size(); ++i)
-            if (actions.exists(i) and qvalues[i] > max_q) {
-                max_q = qvalues[i];
-                argmax = i;
+            if (actions.exists(i) and qvalues[i] < min_q) {
+                min_q = qvalues[i];
+                argmin = i;
             }
-        return argmax;
+        return argmin;
     }
 
     void copy_with_flaws(const Policy& other) {
         assert(qvalues.size() == other.qvalues.size());
+        Action_Module_Interface const& actions = tensor->get_actions();
         for (std::size_t a = 0; a < qvalues.size(); ++a)
             if (actions.exists(a))
                 qvalues[a] = other.qvalues[a]
@@ -59,6 +74,7 @@ public:
         qvalues[to_idx] = qvalues[from_idx];
     }
 
+    /* copies the values, not the view */
     Policy& operator=(const Policy& other) {
         this->copy_with_flaws(other);
         return *this;
@@ -0,0 +1,120 @@
+#ifndef Q_TENSOR_H_INCLUDED
+#define Q_TENSOR_H_INCLUDED
+
+#include <vector>
+#include <cassert>
+#include <common/modules.h>
+#include <common/matrix_kernels.h>
+#include <learning/action_module.h>
+
+namespace learning {
+
+/* Q-values of all states, policies and actions in one dense block,
+ * laid out as [state][policy][action], and the eligibility traces of
+ * all states and actions in a parallel block [state][action].
+ *
+ * The Q-values of one state are one contiguous (policies x actions)
+ * block and each policy is a contiguous row of actions, hence argmax
+ * over actions and updates across actions and policies run on plain
+ * arrays. States are appended one by one, e.g. by the state payloads
+ * sharing the tensor, growing the tensor invalidates pointers into it.
+ */
+class Q_Tensor
+{
+public:
+    Q_Tensor( const Action_Module_Interface& actions
+            , std::size_t                    number_of_policies
+            , double                         q_initial
+            , std::size_t                    reserved_states = 0 )
+    : actions(actions)
+    , num_policies(number_of_policies)
+    , num_actions(actions.get_number_of_actions())
+    , q_initial(q_initial)
+    , num_states(0)
+    , qvalues()
+    , traces()
+    {
+        assert(num_policies > 0);
+        assert(num_actions >= 1);
+        qvalues.reserve(reserved_states * num_policies * num_actions);
+        traces.reserve(reserved_states * num_actions);
+    }
+
+    /* appends a state with slightly randomized initial Q-values */
+    std::size_t add_state(void)
+    {
+        for (std::size_t p = 0; p < num_policies; ++p)
+            for (std::size_t a = 0; a < num_actions; ++a)
+                qvalues.push_back(q_initial + rand_norm_zero_mean(0.01));
+        traces.resize(traces.size() + num_actions, .0);
+        return num_states++;
+    }
+
+    std::size_t get_number_of_states  (void) const { return num_states;   }
+    std::size_t get_number_of_policies(void) const { return num_policies; }
+    std::size_t get_number_of_actions (void) const { return num_actions;  }
+
+    Action_Module_Interface const& get_actions(void) const { return actions; }
+
+    /* row of the Q-values of one state and policy */
+          double* q(std::size_t s, std::size_t p)       { assert(s < num_states and p < num_policies); return qvalues.data() + (s * num_policies + p) * num_actions; }
+    const double* q(std::size_t s, std::size_t p) const { assert(s < num_states and p < num_policies); return qvalues.data() + (s * num_policies + p) * num_actions; }
+
+    /* row of the eligibility traces of one state */
+          double* trace(std::size_t s)       { assert(s < num_states); return traces.data() + s * num_actions; }
+    const double* trace(std::size_t s) const { assert(s < num_states); return traces.data() + s * num_actions; }
+
+    /* Q(s,p,.) += alpha[p] * x for all policies p */
+    void update(std::size_t s, const double* alpha, const double* x) {
+        for (std::size_t p = 0; p < num_policies; ++p)
+            common::kernel::axpy(num_actions, alpha[p], x, q(s, p));
+    }
+
+    /* Hogwild-style update for several learners sharing the tensor, one per
+       thread: each value is read and written with relaxed atomics, hence it
+       is never torn, but concurrent updates of the same value may be lost.
+       The tensor must not grow while learners run. */
+    void update_relaxed(std::size_t s, const double* alpha, const double* x) {
+        for (std::size_t p = 0; p < num_policies; ++p) {
+            double* row = q(s, p);
+            for (std::size_t a = 0; a < num_actions; ++a)
+                store(row + a, load(row + a) + alpha[p] * x[a]);
+        }
+    }
+
+    static double load(const double* v) { double r; __atomic_load(v, &r, __ATOMIC_RELAXED); return r; }
+    static void store(double* v, double x) { __atomic_store(v, &x, __ATOMIC_RELAXED); }
+
+    /* first of the best existing actions */
+    std::size_t argmax(std::size_t s, std::size_t p) const { return argmax(q(s, p), actions); }
+
+    /* same for any row of Q-values, e.g. a snapshot */
+    static std::size_t argmax(const double* row, Action_Module_Interface const& actions)
+    {
+        const std::size_t num_actions = actions.get_number_of_actions();
+        if (actions.get_number_of_actions_available() == num_actions)
+            return common::kernel::argmax(row, num_actions);
+
+        double max_q = row[0];
+        std::size_t result = 0;
+        for (std::size_t a = 1; a < num_actions; ++a)
+            if (actions.exists(a) and row[a] > max_q) {
+                max_q = row[a];
+                result = a;
+            }
+        return result;
+    }
+
+private:
+    const Action_Module_Interface& actions;
+    const std::size_t              num_policies;
+    const std::size_t              num_actions;
+    const double                   q_initial;
+    std::size_t                    num_states;
+    std::vector<double>            qvalues;
+    std::vector<double>            traces;
+};
+
+} // namespace learning
+
+#endif // Q_TENSOR_H_INCLUDED
@@ -49,7 +49,8 @@ public:
          , float discounting = sarsa_constants::GAMMA
          , float trace_decay = sarsa_constants::LAMBDA
          , RL::State initial_state = 0
-         , RL::Action initial_action = 0 )
+         , RL::Action initial_action = 0
+         , double trace_cutoff = sarsa_constants::TRACE_CUTOFF )
     : states(states)
     , rewards(rewards)
     , action_selection(action_selection)
@@ -64,6 +65,11 @@ public:
     , learning_rates(learning_rates)
     , discounting(discounting)
     , trace_decay(trace_decay)
+    , trace_cutoff(trace_cutoff)
+    , trace_scale(1.0)
+    , alpha(number_of_policies)
+    , active_states()
+    , active_index(states.size(), std::size_t(not_active))
     , learning_enabled(true)
     {
         sts_msg("Creating discrete Reinforcement Learner: SARSA.\
@@ -76,6 +82,7 @@ public:
                , "Number of learning rates %u must be equal to the number of policies %u"
                , learning_rates.size(), number_of_policies);
         assert(states[0].policies.size() == rewards.get_number_of_policies() );
+        assert(trace_cutoff >= 0.0);
 
         sts_msg("GAMMA=%1.3f LAMBDA = %1.3f", discounting, trace_decay);
     }
@@ -87,6 +94,27 @@ public:
     std::size_t get_current_state     (void) const { return current_state;      }
     std::size_t get_number_of_policies(void) const { return number_of_policies; }
     std::size_t get_number_of_actions (void) const { return number_of_actions;  }
+    std::size_t get_number_of_active_states(void) const { return active_states.size(); }
+
+    /* eligibility trace of state s and action a */
+    double get_trace(RL::State s, RL::Action a) const {
+        return (active_index[s] == not_active) ? 0.0 : trace_row(s)[a] * trace_scale;
+    }
+
+    /* Hogwild-style concurrent learning: several agents, each with its own
+       SARSA, robot, rewards and action selection (with its own random
+       stream) in its own thread, learn into the same states, i.e. one
+       shared Q tensor. Each agent then keeps private eligibility traces,
+       Q-values are read and written with relaxed atomics, also by the
+       action selection. Enable before the first learning step. */
+    void enable_concurrent_learning(void) {
+        assert(active_states.empty());
+        private_traces.assign(states.size() * number_of_actions, .0);
+        action_selection.enable_concurrent_reads();
+        concurrent = true;
+    }
+
+    bool is_concurrent(void) const { return concurrent; }
 
     void select_policy(std::size_t index, bool print_status = true)
     {
@@ -98,11 +126,21 @@ public:
         else wrn_msg("Invalid policy");
     }
 
+    /* decays all traces at once by decaying their common scale, the
+       stored values are renormalized before the scale underflows. All
+       rows are renormalized, inactive ones may hold copied traces. */
     void decay_eligibility_traces(void) {
-        /**TODO non existing states should be reset to zero */
-        for (std::size_t s = 0; s < states.size(); ++s)
-            for (std::size_t a = 0; a < number_of_actions; ++a)
-                states[s].eligibility_trace[a].decay(discounting*trace_decay);
+        trace_scale *= discounting*trace_decay;
+        if (trace_scale < min_trace_scale) {
+            for (std::size_t s = 0; s < states.size(); ++s) {
+                double* row = trace_row(s);
+                for (std::size_t a = 0; a < number_of_actions; ++a)
+                    row[a] *= trace_scale;
+            }
+            for (auto& t : active_states)
+                t.peak *= trace_scale;
+            trace_scale = 1.0;
+        }
     }
 
 
@@ -164,8 +202,8 @@ private:
         for (std::size_t pi = 0; pi < number_of_policies; ++pi)
             //TODO testing
             //if (pi == current_policy)
-            deltaQ[pi] = rewards.get_aggregated_last_reward(pi) + discounting * states[current_state].policies[pi].qvalues[current_action]
-                                                                              - states[last_state   ].policies[pi].qvalues[last_action   ];
+            deltaQ[pi] = rewards.get_aggregated_last_reward(pi) + discounting * get_q(current_state, pi, current_action)
+                                                                              - get_q(last_state   , pi, last_action   );
 
             //else deltaQ[pi] = .0;
             //TODO use get_max_q
@@ -175,14 +213,58 @@ private:
             decay_eligibility_traces();
 
         /* reset trace */
-        states[last_state].eligibility_trace[last_action].reset();
-
-        /* update all Q-Values according to their trace */
-        /**TODO this method is inherently slow. try to improve */
-        for (std::size_t s = 0; s < states.size(); ++s)
-            for (std::size_t a = 0; a < number_of_actions; ++a)
-                for (std::size_t pi = 0; pi < number_of_policies; ++pi)
-                    states[s].policies[pi].qvalues[a] += learning_rates[pi] * deltaQ[pi] * states[s].eligibility_trace[a].get();
+        activate_trace(last_state, last_action);
+
+        /* update the Q-values of all active states, row by row over actions
+           and policies. All other states' traces are below the cutoff and
+           dropped, hence the cost is proportional to live traces */
+        for (std::size_t pi = 0; pi < number_of_policies; ++pi)
+            alpha[pi] = learning_rates[pi] * deltaQ[pi] * trace_scale;
+
+        for (std::size_t i = 0; i < active_states.size(); ) {
+            if (active_states[i].peak * trace_scale < trace_cutoff) {
+                drop_state(i);
+                continue;
+            }
+            const RL::State s = active_states[i].state;
+            if (concurrent)
+                states[s].update_relaxed(alpha.data(), trace_row(s));
+            else
+                states[s].update(alpha.data(), trace_row(s));
+            ++i;
+        }
+    }
+
+    double get_q(RL::State s, std::size_t pi, RL::Action a) const {
+        const double* q = states[s].get_qvalues(pi) + a;
+        return concurrent ? learning::Q_Tensor::load(q) : *q;
+    }
+
+    /* the traces of the payloads or the agent's own */
+          double* trace_row(RL::State s)       { return concurrent ? private_traces.data() + s * number_of_actions : states[s].get_traces(); }
+    const double* trace_row(RL::State s) const { return concurrent ? private_traces.data() + s * number_of_actions : states[s].get_traces(); }
+
+    void activate_trace(RL::State s, RL::Action a) {
+        Eligibility(trace_row(s)[a]).reset(trace_scale);
+        std::size_t& index = active_index[s];
+        if (index == not_active) {
+            index = active_states.size();
+            active_states.push_back({s, .0});
+        }
+        active_states[index].peak = 1.0 / trace_scale; // all others have decayed since
+    }
+
+    /* swap with the last one and remove */
+    void drop_state(std::size_t i) {
+        Active_State const& t = active_states[i];
+        double* row = trace_row(t.state);
+        std::fill(row, row + number_of_actions, .0);
+        active_index[t.state] = not_active;
+        if (i + 1 < active_states.size()) {
+            active_states[i] = active_states.back();
+            active_index[active_states[i].state] = i;
+        }
+        active_states.pop_back();
     }
 
 
@@ -208,6 +290,26 @@ private:
     float discounting; // aka Gamma
     float trace_decay; // aka Lambda
 
+    /* Sparse eligibility traces: only states with a trace above the cutoff
+       are kept in the active list, the traces of all others are zero. The
+       stored values are relative to the common trace scale, 'peak' is the
+       largest stored trace of the state. Traces copied between payloads
+       (e.g. cloned experts) are only tracked when their target is active,
+       else they are kept relative to the scale and apply when the target
+       is visited next. */
+    struct Active_State { RL::State state; double peak; };
+    static constexpr std::size_t not_active = static_cast<std::size_t>(-1);
+    static constexpr double min_trace_scale = 1e-100;
+
+    const double              trace_cutoff;
+    double                    trace_scale;
+    std::vector<double>       alpha;         // step size per policy, incl. trace scale
+    std::vector<Active_State> active_states;
+    std::vector<std::size_t>  active_index;  // position in active list per state
+
+    bool                      concurrent = false;
+    std::vector<double>       private_traces; // [state][action], concurrent learning only
+
     bool random_actions = false;
     bool learning_enabled;
 
@@ -8,6 +8,7 @@ namespace sarsa_constants {
     const double GAMMA   = 0.99; // discount factor
     const double LAMBDA  = 0.9;  // eligibility trace factor (better do not touch)
     const double ALPHA   = 0.1;  // Reinforcement Learning Rate
+    const double TRACE_CUTOFF = 1e-4; // traces below are dropped
 
     const unsigned int policy_change_cycle = 5000; // 10 sec. @ 100Hz
     const unsigned int number_of_policies = 3;
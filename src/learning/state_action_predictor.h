@@ -38,12 +38,12 @@ public:
     Predictor_Base::vector_t const& get_prediction(void) const override { return enc.get_outputs(); }
 
     double predict(void) override {
-        enc.propagate(input);
+        enc.propagate(input.values());
         return calculate_prediction_error();
     };
 
     double verify(void) override {
-        enc.propagate(input);
+        enc.propagate(input.values());
         return calculate_prediction_error();
     }
 
@@ -52,7 +52,7 @@ public:
         auto initial_experience = input.get();
         for (auto& w: initial_experience)
             w += random_value(-random_weight_range, random_weight_range);
-        experience.assign(experience.size(), initial_experience);
+        experience.fill(initial_experience);
         prediction_error = predictor_constants::error_min;
     };
 
@@ -67,7 +67,7 @@ public:
 
 private:
 
-    void learn_from_input_sample(void) override { enc.adapt(input, learning_rate); };
+    void learn_from_input_sample(void) override { enc.adapt(input.values(), learning_rate); };
     void learn_from_experience(std::size_t /*skip_idx*/) override { assert(false && "Learning from experience is not implemented yet."); };
 
     Autoencoder enc;
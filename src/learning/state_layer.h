@@ -38,15 +38,15 @@ public:
     : sensor_vector(joints.size())
     {
         for (robots::Joint_Model const& j : joints)
-            sensors.emplace_back(j.name + "_ang", [&j](){ return j.s_ang; });
+            add_sensor(j.name + "_ang", [&j](){ return j.s_ang; });
 
         for (robots::Joint_Model const& j : joints)
-            sensors.emplace_back(j.name + "_vel", [&j](){ return j.s_vel; });
+            add_sensor(j.name + "_vel", [&j](){ return j.s_vel; });
 
 
         /* TODO: why is there no accel data included*/
 
-        sensors.emplace_back("bias", [](){ return 0.1; });
+        add_sensor("bias", [](){ return 0.1; });
     }
 };
 
@@ -63,7 +63,8 @@ public:
     : max_num_state_experts(max_num_state_experts)
     , payloads(payloads)
     , statespace(robot.get_joints())
-    , experts(max_num_state_experts, payloads, statespace, learning_rate, experience_size, hidden_layer_size, time_delay_size)
+    , delay_line(statespace.size(), time_delay_size)
+    , experts(max_num_state_experts, payloads, statespace, delay_line, learning_rate, experience_size, hidden_layer_size)
     , gmes(experts, growth_rate, /* one shot learning = */false)
     {
         dbg_msg("Creating new competitive state layer.");
@@ -74,6 +75,7 @@ public:
 
     void execute_cycle(void) {
         statespace.execute_cycle();
+        delay_line.propagate(statespace.values()); // once for all experts
         gmes.execute_cycle();
     }
 
@@ -99,6 +101,7 @@ public:
     std::size_t                  max_num_state_experts;
     static_vector_interface&     payloads;
     State_Space                  statespace;
+    FIR_type_synapse             delay_line; // shared by all experts
     Expert_Vector                experts;
     GMES                         gmes;
 
@@ -26,6 +26,21 @@ public:
         dbg_msg("Initialize State Predictor using TDNN.");
     }
 
+    /* reads the time delayed inputs from a shared delay line, which
+     * must be propagated with the inputs before each prediction */
+    State_Predictor( const sensor_vector&    inputs
+                   , FIR_type_synapse const& shared_delay_line
+                   , const double            learning_rate
+                   , const double            random_weight_range
+                   , const std::size_t       experience_size
+                   , const std::size_t       hidden_layer_size )
+    : Predictor_Base(inputs, learning_rate, random_weight_range, experience_size)
+    , enc(shared_delay_line, inputs.size(), hidden_layer_size, random_weight_range )
+    {
+        assert(shared_delay_line.size() % inputs.size() == 0);
+        dbg_msg("Initialize State Predictor using TDNN with shared delay line.");
+    }
+
     virtual ~State_Predictor() = default;
 
     void copy(Predictor_Base const& other) override {
@@ -38,7 +53,7 @@ public:
     Predictor_Base::vector_t const& get_prediction(void) const override { return enc.get_outputs(); }
 
     double predict(void) override {
-        enc.propagate_and_shift(input);
+        enc.propagate_and_shift(input.values());
         return calculate_prediction_error();
     };
 
@@ -52,7 +67,7 @@ public:
         auto initial_experience = input.get();
         for (auto& w: initial_experience)
             w += random_value(-random_weight_range, random_weight_range);
-        experience.assign(experience.size(), initial_experience);
+        experience.fill(initial_experience);
         prediction_error = predictor_constants::error_min;
     };
 
@@ -65,10 +80,10 @@ public:
 
 private:
 
-    void learn_from_input_sample(void) override { enc.adapt(input, learning_rate); };
+    void learn_from_input_sample(void) override { enc.adapt(input.values(), learning_rate); };
     void learn_from_experience(std::size_t /*skip_idx*/) override { assert(false && "Learning from experience is not implemented yet."); };
 
-    Timedelay_Network enc;
+    Timedelay_Network<> enc;
 
     VectorN dummy = {}; // remove when implementing get_weights
 
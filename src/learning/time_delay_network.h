@@ -1,10 +1,13 @@
 #ifndef TIME_DELAY_NETWORK_H_INCLUDED
 #define TIME_DELAY_NETWORK_H_INCLUDED
 
-#include <deque>
+#include <algorithm>
+#include <type_traits>
 
 #include <common/modules.h>
-#include <common/static_vector.h>
+#include <common/matrix.h>
+#include <common/matrix_kernels.h>
+#include <common/fast_math.h>
 #include <control/sensorspace.h>
 
 
@@ -31,121 +34,146 @@ namespace learning {
 
    plus additional bias
 
+   The delay lines are kept in a contiguous ring buffer of input vectors, newest first.
+   Every input vector is stored twice, at row 'head' and at 'head + N', hence the N rows
+   starting at 'head' are always the time delayed inputs in order and can be read in
+   place, nothing is shifted or expanded.
+
+   A synapse can also be a view of another synapse's delay line, so that several
+   networks (e.g. all experts of a layer) share one delay line of the same input
+   stream. Views are not shifted, the owner of the delay line propagates it once
+   per cycle before the networks are propagated.
 */
 class FIR_type_synapse {
 
     typedef std::vector<double>  vector_t;
-    typedef std::deque<vector_t> buffer_t;   // replace by something which is more efficient
 
     std::size_t number_of_taps;
     std::size_t input_size;    /* size of raw inputs */
-    vector_t    td_inputs;     /* time delayed inputs */
-    buffer_t    buffer;        /* structure holding all FIFOs */
-
-
-    void expand(void) {
-        std::size_t p = 0;
-        for (auto const& vec : buffer)
-            for (auto const& el : vec)
-                td_inputs[p++] = el;
-        assert(p == td_inputs.size());
-    }
+    std::size_t head;          /* row of the newest input vector */
+    vector_t    buffer;        /* 2 x number_of_taps rows of input vectors, empty for views */
+    FIR_type_synapse const* shared; /* owner of the delay line, null if owned */
 
 public:
 
+    /* read-only access to the time delayed inputs, always up to date */
+    class view_t {
+        FIR_type_synapse const* line;
+    public:
+        explicit view_t(FIR_type_synapse const* line) : line(line) {}
+        std::size_t   size(void)                const { return line->size(); }
+        double        operator[](std::size_t i) const { assert(i < size()); return line->data()[i]; }
+        const double* begin(void)               const { return line->data(); }
+        const double* end(void)                 const { return line->data() + size(); }
+        bool operator==(vector_t const& other)  const { return other.size() == size() and std::equal(begin(), end(), other.begin()); }
+    };
+
     FIR_type_synapse(std::size_t input_size, std::size_t number_of_taps)
     : number_of_taps(number_of_taps)
     , input_size(input_size)
-    , td_inputs(input_size*number_of_taps)
-    , buffer(input_size)
+    , head(0)
+    , buffer(2*number_of_taps*input_size, .0) /* initialize buffer with zero vectors */
+    , shared(nullptr)
     {
-        /* initialize buffer with zero vectors */
-        buffer.assign(number_of_taps, vector_t(input_size));
-
-        assert(buffer.size() == number_of_taps);
-        assert(buffer.size()*buffer[0].size() == td_inputs.size());
+        assert(number_of_taps > 0);
         dbg_msg("Created FIR-type Synapse of size %u x %u.", input_size, number_of_taps);
     }
 
-    vector_t const& get       (void) const { return td_inputs; }
-    buffer_t const& get_buffer(void) const { return buffer; }
+    /* view of a shared delay line */
+    explicit FIR_type_synapse(FIR_type_synapse const* shared_line)
+    : number_of_taps(shared_line->number_of_taps)
+    , input_size(shared_line->input_size)
+    , head(0)
+    , buffer()
+    , shared(shared_line->is_shared() ? shared_line->shared : shared_line)
+    { }
 
-
-    std::size_t size(void) const { return td_inputs.size(); }
+    view_t          get (void) const { return view_t(this); }
+    const double*   data(void) const { return shared ? shared->data() : buffer.data() + head * input_size; }
+    std::size_t     size(void) const { return input_size*number_of_taps; }
+    bool       is_shared(void) const { return shared != nullptr; }
 
     template <typename InputVector_t>
     void propagate(const InputVector_t& inputs)
     {
         assert(input_size == inputs.size());
-
-        /* shift */
-        buffer.pop_back();       // remove oldest input vector
-        buffer.push_front(inputs.get()); // fill in new values
-        assert(buffer.size() == number_of_taps);
-
-        /*
-        for (auto const& vec : buffer) {
-            printf("[ ");
-            for (auto const& el : vec)
-                printf("%5.2f ", el);
-            printf("]\n");
-        }
-        printf("\n");
-        */
-
-        expand(); // prepare vector for returning in 'get()'
+        if (is_shared()) return; // propagated by the owner
+
+        /* shift, the oldest input vector is overwritten */
+        head = (head == 0 ? number_of_taps : head) - 1;
+        double* newest = buffer.data() + head * input_size;
+        double* mirror = newest + number_of_taps * input_size;
+        for (std::size_t i = 0; i < input_size; ++i)
+            newest[i] = mirror[i] = inputs[i];
     }
 
-
-
 };
 
 
-/**TODO move the tapped delay line to input space, in order to have all experts share the same tapping line. */
-
 /* Time-Delay feed-forward network
    with a single tanh-type hidden layer.
+
+   Weights and activations are of type Scalar_t (double by default), the
+   delay line keeps the double inputs and is converted for float networks.
 */
 typedef std::vector<double> vector_t;
-typedef copyable_static_vector<copyable_static_vector<double>> matrix_t;
+typedef common::Matrix<double> matrix_t;
 
+template <typename Scalar_t = double>
 struct TDNWeights {
+    typedef common::Matrix<Scalar_t> matrix_t;
+
     TDNWeights(std::size_t inp, std::size_t hid, std::size_t out): hi(hid, inp), oh(out, hid) /*, biases_oh(output.size())*/{}
 
+    template <typename Other_t>
+    explicit TDNWeights(TDNWeights<Other_t> const& other) : hi(other.hi), oh(other.oh) {}
+
     matrix_t hi;
     matrix_t oh;
         //TODO vector_t biases_oh;
 };
 
 
+template <typename Scalar_t = double>
 class Timedelay_Network
 {
+public:
+    typedef Scalar_t                 scalar_t;
+    typedef std::vector<Scalar_t>    vector_t;
+    typedef common::Matrix<Scalar_t> matrix_t;
+
+private:
 
     FIR_type_synapse td_input; /* time delayed inputs */
+    vector_t td_buffer;        /* converted time delayed inputs, empty for double */
     vector_t hidden;
     vector_t output;
     vector_t delta;
+    vector_t hidden_error;
 
-    TDNWeights weights;
+    TDNWeights<Scalar_t> weights;
 
-    void randomize(matrix_t& mat, double std_dev) {
-        assert_in_range(std_dev, 0.0, 0.1);
-        const double normed_stddev = std_dev / sqrt(mat[0].size()); // normalize by sqrt(N), N:#inputs
-        for (std::size_t i = 0; i < mat.size(); ++i)
-            for (std::size_t j = 0; j < mat[i].size(); ++j)
-                mat[i][j] = rand_norm_zero_mean(normed_stddev);
-    }
+    fast_math::Mode math_mode = fast_math::Mode::exact; /* of the tanh activations */
 
-    void propagate_forward(vector_t& out, matrix_t const& mat, vector_t const& in) {
-        assert(out.size() == mat.size());
-        assert( in.size() == mat[0].size());
+    static std::size_t buffer_size(FIR_type_synapse const& line) { return std::is_same<Scalar_t, double>::value ? 0 : line.size(); }
 
-        for (std::size_t i = 0; i < out.size(); ++i) {
-            double act = 0.;
-            for (std::size_t j = 0; j < in.size(); ++j)
-                act += mat[i][j] * in[j];
-            out[i] = act;
-        }
+    const Scalar_t* time_delayed_inputs(void) { return common::kernel::converted(td_input.data(), td_input.size(), td_buffer); }
+
+    /* y = tanh(W x) */
+    void propagate_layer(matrix_t const& W, const Scalar_t* x, vector_t& y) {
+        if (math_mode == fast_math::Mode::fast) {
+            common::kernel::gemv(W, x, y.data());
+            fast_math::tanh(y.data(), y.data(), y.size());
+        } else
+            common::kernel::gemv(W, x, y.data(), common::kernel::tanh_fn());
+    }
+
+    void randomize(matrix_t& mat, double std_dev) {
+        assert_in_range(std_dev, 0.0, 0.1);
+        const double normed_stddev = std_dev / sqrt(mat.cols()); // normalize by sqrt(N), N:#inputs
+        for (std::size_t i = 0; i < mat.rows(); ++i)
+            for (std::size_t j = 0; j < mat.cols(); ++j)
+                mat(i,j) = rand_norm_zero_mean(normed_stddev);
     }
 
 public:
@@ -156,23 +184,54 @@ public:
                      , std::size_t number_of_taps
                      , double rnd_init_range)
     : td_input(input_size, number_of_taps)
+    , td_buffer(buffer_size(td_input))
     , hidden(hidden_size)
     , output(target_size)
     , delta (output.size())
+    , hidden_error(hidden.size())
+    , weights(td_input.size(), hidden.size(), output.size())
+    {
+        randomize_weight_matrix(rnd_init_range);
+    }
+
+    /* network reading the time delayed inputs from a shared delay line */
+    Timedelay_Network( FIR_type_synapse const& shared_delay_line
+                     , std::size_t target_size
+                     , std::size_t hidden_size
+                     , double rnd_init_range)
+    : td_input(&shared_delay_line)
+    , td_buffer(buffer_size(td_input))
+    , hidden(hidden_size)
+    , output(target_size)
+    , delta (output.size())
+    , hidden_error(hidden.size())
     , weights(td_input.size(), hidden.size(), output.size())
     {
         randomize_weight_matrix(rnd_init_range);
     }
 
 
+    /* copy of a network of another precision, e.g. trained in double and run in float */
+    template <typename Other_t>
+    explicit Timedelay_Network(Timedelay_Network<Other_t> const& other)
+    : td_input(other.td_input)
+    , td_buffer(buffer_size(td_input))
+    , hidden(other.hidden.begin(), other.hidden.end())
+    , output(other.output.begin(), other.output.end())
+    , delta (other.delta.begin(), other.delta.end())
+    , hidden_error(other.hidden_error.begin(), other.hidden_error.end())
+    , weights(other.weights)
+    , math_mode(other.math_mode)
+    { }
+
+    template <typename> friend class Timedelay_Network;
+
     void propagate(void) {
         /* time delayed input to hidden layer */
-        propagate_forward(hidden, weights.hi, td_input.get());
-        vector_tanh(hidden);
+        propagate_layer(weights.hi, time_delayed_inputs(), hidden);
 
         /* hidden to output layer */
-        propagate_forward(output, weights.oh, hidden);
-        vector_tanh(output);
+        propagate_layer(weights.oh, hidden.data(), output);
     }
 
     template <typename InputVector_t>
@@ -194,25 +253,21 @@ public:
             delta[i] = (targets[i] - output[i]) * tanh_(output[i]);
 
 
-        /* estimate error for hidden units and adapt input to hidden weights */
+        /* estimate 'hidden' errors */
+        common::kernel::gemv_t(weights.oh, delta.data(), hidden_error.data());
+
+        /* adapt input to hidden weights */
+        const Scalar_t* td_inputs = time_delayed_inputs();
+        assert(output.size() <= weights.hi.cols());
         for (std::size_t i = 0; i < hidden.size(); ++i)
         {
-            /* estimate 'hidden' errors */
-            double error_i = .0;
-            for (std::size_t j = 0; j < output.size(); ++j)
-                error_i += weights.oh[j][i] * delta[j];
-
-            /* adapt weights.hi */
-            const double delta_i = error_i * tanh_(hidden[i]);
-            for (std::size_t j = 0; j < output.size(); ++j)
-                weights.hi[i][j] += learning_rate * delta_i * td_input.get()[j];
+            const double delta_i = hidden_error[i] * tanh_(hidden[i]);
+            common::kernel::axpy(output.size(), learning_rate * delta_i, td_inputs, weights.hi.row(i).data());
         }
 
 
         /* adapt weight_oh */
-        for (std::size_t i = 0; i < output.size(); ++i)
-            for (std::size_t j = 0; j < hidden.size(); ++j)
-                weights.oh[i][j] += learning_rate * delta[i] * hidden[j];
+        common::kernel::rank1_update(weights.oh, learning_rate, delta.data(), hidden.data());
     }
 
     /*
@@ -237,7 +292,9 @@ public:
 
     vector_t const& get_outputs() const { return output; }
     vector_t const& get_hidden() const { return hidden; }
-    TDNWeights const& get_weights() const { return weights; }
+    TDNWeights<Scalar_t> const& get_weights() const { return weights; }
+
+    void set_math_mode(fast_math::Mode mode) { math_mode = mode; }
 
     void randomize_weight_matrix(double random_weight_range)
     {
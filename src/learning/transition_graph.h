@@ -0,0 +1,126 @@
+#ifndef TRANSITION_GRAPH_H_INCLUDED
+#define TRANSITION_GRAPH_H_INCLUDED
+
+#include <cmath>
+#include <vector>
+#include <cassert>
+#include <algorithm>
+#include <learning/gmes_constants.h>
+
+namespace learning {
+
+/* Sparse transition graph of GMES.
+ *
+ * Each node keeps an adjacency list of its existing transitions only,
+ * value(i,k) corresponds to the former dense entry expert[i].transition[k].
+ *
+ * Decaying all transitions of a node (its row and its column) would touch
+ * every edge of it, hence decay is applied lazily: each node accumulates
+ * the exponent of its decay and each edge remembers the accumulated
+ * exponents of both ends at the time it was last written (timestamps).
+ * The current value is computed on read, a self-transition decays twice,
+ * just like with the dense matrix.
+ *
+ * Edges which decayed to exactly zero are dropped when the accumulated
+ * exponents are folded back into the edges, which happens whenever
+ * they grow large enough to cost precision.
+ */
+class Transition_Graph
+{
+    struct Edge {
+        std::size_t index;
+        double      value;
+        double      stamp_from; // accumulated decay of row node when written
+        double      stamp_to;   // accumulated decay of column node when written
+    };
+
+    std::vector<std::vector<Edge>> edges; // outgoing, per row node
+    std::vector<double>            decay; // accumulated exponent per node
+
+public:
+    explicit Transition_Graph(std::size_t number_of_nodes)
+    : edges(number_of_nodes)
+    , decay(number_of_nodes, .0)
+    {
+        assert(number_of_nodes > 0);
+    }
+
+    std::size_t size(void) const { return edges.size(); }
+
+    double value(std::size_t i, std::size_t k) const {
+        Edge const* e = find(i, k);
+        return (e != nullptr) ? current(i, *e) : .0;
+    }
+
+    bool exists(std::size_t i, std::size_t k) const { return value(i, k) > gmes_constants::transition_exist_treshold; }
+
+    /* set (i,k) to its initial validation */
+    void reset(std::size_t i, std::size_t k) {
+        assert(k < edges.size());
+        Edge* e = find(i, k);
+        if (e == nullptr) {
+            edges[i].push_back(Edge{k, .0, .0, .0});
+            e = &edges[i].back();
+        }
+        e->value      = gmes_constants::initial_transition_validation;
+        e->stamp_from = decay[i];
+        e->stamp_to   = decay[k];
+    }
+
+    /* multiply all transitions from and to node n by exp(-rate), O(1),
+       a negative rate (negative learning progress) lets them grow */
+    void decay_node(std::size_t n, double rate) {
+        const double max_decay = 1e4; // keeps the rounding of exponents below ~1e-12
+        decay.at(n) += rate;
+        if (std::abs(decay[n]) > max_decay) fold();
+    }
+
+    /* remove all transitions of row i */
+    void clear_from(std::size_t i) { edges.at(i).clear(); }
+
+    /* remove all transitions of column k */
+    void clear_to(std::size_t k) {
+        for (auto& row : edges)
+            row.erase(std::remove_if(row.begin(), row.end(), [k](Edge const& e) { return e.index == k; }), row.end());
+    }
+
+    std::size_t get_number_of_edges(void) const {
+        std::size_t count = 0;
+        for (auto const& row : edges) count += row.size();
+        return count;
+    }
+
+    /* write the pending decay into all edges and reset the timestamps */
+    void fold(void) {
+        for (std::size_t i = 0; i < edges.size(); ++i) {
+            for (auto& e : edges[i]) {
+                e.value = current(i, e);
+                e.stamp_from = e.stamp_to = .0;
+            }
+            edges[i].erase(std::remove_if(edges[i].begin(), edges[i].end(), [](Edge const& e) { return e.value == .0; }), edges[i].end());
+        }
+        std::fill(decay.begin(), decay.end(), .0);
+    }
+
+private:
+
+    double current(std::size_t i, Edge const& e) const {
+        return e.value * std::exp(-((decay[i] - e.stamp_from) + (decay[e.index] - e.stamp_to)));
+    }
+
+    Edge const* find(std::size_t i, std::size_t k) const {
+        for (auto const& e : edges.at(i))
+            if (e.index == k) return &e;
+        return nullptr;
+    }
+
+    Edge* find(std::size_t i, std::size_t k) {
+        for (auto& e : edges.at(i))
+            if (e.index == k) return &e;
+        return nullptr;
+    }
+};
+
+} // namespace learning
+
+#endif // TRANSITION_GRAPH_H_INCLUDED
@@ -0,0 +1,194 @@
+#ifndef POLE_BATCH_H_INCLUDED
+#define POLE_BATCH_H_INCLUDED
+
+#include <cmath>
+#include <vector>
+#include <memory>
+#include <cassert>
+#include <algorithm>
+#include <common/modules.h>
+#include <common/fast_math.h>
+
+#include <robots/joint.h>
+#include <robots/accel.h>
+#include <robots/robot.h>
+#include <robots/pole.h>
+
+namespace robots {
+
+/* N independent poles with the dynamics of 'pole', simulated at once.
+ *
+ * States and actions are kept in arrays (structure of arrays). The poles
+ * are integrated substep by substep in blocks, so the inner loops run over
+ * the poles without branches or calls, apart from sin(), which is
+ * vectorized in fast mode. In exact mode (libm) every pole follows the
+ * trajectory of a single 'pole'.
+ *
+ * Sweeps set the actions of all poles and read their angles and velocities
+ * (normalized like the joint's s_ang and s_vel) after each cycle. Existing
+ * code gets a Robot_Interface for each pole by get_instance(i), which
+ * simulates only its own pole on execute_cycle().
+ */
+class pole_batch
+{
+public:
+    class instance : public Robot_Interface
+    {
+        pole_batch&   batch;
+        std::size_t   index;
+        Jointvector_t joints;
+        Accelvector_t accels;
+
+    public:
+        instance(pole_batch& batch, std::size_t index)
+        : batch(batch)
+        , index(index)
+        , joints()
+        , accels() //empty
+        {
+            joints.reserve(1);
+            joints.emplace_back(0, Joint_Type_Normal, 0, "joint0", -1.0, +1.0, 0.0);
+        }
+
+        /* same as pole::execute_cycle() */
+        bool execute_cycle(void) override {
+            assert(std::abs(joints[0].motor.get()) <= 1.0);
+            batch.action[index] = joints[0].motor.get();
+            batch.simulate(index, index + 1);
+
+            joints[0].s_ang = batch.angle[index];
+            joints[0].s_vel = batch.velocity[index];
+            joints[0].motor = batch.force[index];
+            assert(std::abs(joints[0].s_ang) <= 1.0);
+
+            joints[0].motor.transfer();
+            joints[0].motor = .0;
+            return true;
+        }
+
+        std::size_t get_number_of_joints          (void) const override { return 1; }
+        std::size_t get_number_of_symmetric_joints(void) const override { return 0; }
+        std::size_t get_number_of_accel_sensors   (void) const override { return 0; }
+
+        const Jointvector_t& get_joints(void) const override { return joints; }
+              Jointvector_t& set_joints(void)       override { return joints; }
+
+        const Accelvector_t& get_accels(void) const override { return accels; }
+              Accelvector_t& set_accels(void)       override { return accels; }
+
+        double get_normalized_mechanical_power(void) const override { return batch.force[index] * batch.force[index]; }
+    };
+
+    explicit pole_batch(std::size_t number_of_poles, bool tilted = false, fast_math::Mode mode = fast_math::Mode::exact)
+    : theta(number_of_poles)
+    , theta_dot(number_of_poles)
+    , force(number_of_poles)
+    , action(number_of_poles)
+    , angle(number_of_poles)
+    , velocity(number_of_poles)
+    , instances(number_of_poles)
+    , math_mode(mode)
+    {
+        assert(number_of_poles > 0);
+        for (std::size_t i = 0; i < number_of_poles; ++i)
+            reset(i, tilted);
+    }
+
+    /* same as pole::reset_state() */
+    void reset(std::size_t i, bool tilted = false) {
+        assert(i < size());
+        theta_dot[i] = 0.0;
+        if (tilted)
+            theta[i] = M_PI + rand_sign() * random_value( deg_to_rad(2.)
+                                                        , deg_to_rad(5.) );
+        else
+            theta[i] = M_PI;
+        force [i] = .0;
+        action[i] = .0;
+    }
+
+    std::size_t size(void) const { return theta.size(); }
+
+    void set_math_mode(fast_math::Mode mode) { math_mode = mode; }
+
+    /* actions in [-1,+1], applied by the next cycle */
+          double* set_actions(void)       { return action.data(); }
+    const double* get_actions(void) const { return action.data(); }
+
+    const double* get_angles    (void) const { return angle.data();    }
+    const double* get_velocities(void) const { return velocity.data(); }
+    const double* get_forces    (void) const { return force.data();    }
+
+    double height(std::size_t i) const { return -cos(theta[i]); }
+
+    void execute_cycle(void) { simulate(0, size()); }
+
+    instance& get_instance(std::size_t i) {
+        if (not instances.at(i))
+            instances[i].reset(new instance(*this, i));
+        return *instances[i];
+    }
+
+private:
+
+    static const std::size_t substeps = 10;
+    static const std::size_t block    = 256; // poles per block, stays in L1 cache
+
+    /* same as pole::update_dynamics() and the conversion to the joint's
+       sensor values, for the poles [begin,end) */
+    void simulate(std::size_t begin, std::size_t end)
+    {
+        using namespace pole_constants;
+        double sin_theta[block];
+
+        for (std::size_t b = begin; b < end; b += block)
+        {
+            const std::size_t n = (end - b < block) ? end - b : block;
+            double* th = theta.data()     + b;
+            double* td = theta_dot.data() + b;
+            double* f  = force.data()     + b;
+            const double* a = action.data() + b;
+
+            for (std::size_t i = 0; i < n; ++i)
+                f[i] = force_mag * std::min(std::max(a[i], -1.0), 1.0);
+
+            for (std::size_t t = 0; t < substeps; ++t)
+            {
+                fast_math::sin(th, sin_theta, n, math_mode);
+                for (std::size_t i = 0; i < n; ++i)
+                {
+                    const double sgn = (td[i] > 0.0) ? 1.0 : ((td[i] < 0.0) ? -1.0 : 0.0);
+                    const double theta_dotdot = -0.2 * sgn                          /* dry friction                  */
+                                              - friction * td[i]                    /* fluid friction                */
+                                              - (gravity / length) * sin_theta[i]   /* torque induced by gravity     */
+                                              + f[i] * (length / mass);             /* torque induced by motor force */
+                    th[i] += td[i]        * dt;
+                    td[i] += theta_dotdot * dt;
+                }
+            }
+
+            double* ang = angle.data()    + b;
+            double* vel = velocity.data() + b;
+            for (std::size_t i = 0; i < n; ++i) {
+                ang[i] = wrap2(th[i]) / M_PI;
+                vel[i] = td[i] / (2*M_PI);
+            }
+            fast_math::tanh(vel, vel, n, math_mode);
+        }
+    }
+
+    std::vector<double> theta;     /* pole angles [rad] */
+    std::vector<double> theta_dot; /* pole angular velocities [rad/s] */
+    std::vector<double> force;     /* forces exerted to the hinge joints */
+    std::vector<double> action;
+    std::vector<double> angle;     /* normalized, as joint s_ang */
+    std::vector<double> velocity;  /* normalized, as joint s_vel */
+
+    std::vector<std::unique_ptr<instance>> instances;
+
+    fast_math::Mode math_mode;
+};
+
+} // namespace robots
+
+#endif // POLE_BATCH_H_INCLUDED
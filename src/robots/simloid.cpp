@@ -21,6 +21,7 @@ Simloid::Simloid( bool interlaced_mode,
                 , mtx()
                 , client()
                 , connection_established(open_connection())
+                , update_pending(false)
                 , record_frame(false)
                 , configuration(client.recv(5*network::constants::seconds_us), interlaced_mode)
                 , timestamp()
@@ -241,12 +242,57 @@ Simloid::update(void)
 
     write_motor_data();
     read_sensor_data();
+    update_derived_quantities();
+    return true;
+}
+
+bool
+Simloid::begin_update(void)
+{
+    common::lock_t lock(mtx);
+
+    if (!connection_established) {
+        wrn_msg("Cannot update sensor values. Not connected.");
+        return false;
+    }
+    assert(not update_pending);
+
+    write_motor_data();
+    update_pending = true;
+    return true;
+}
+
+bool
+Simloid::complete_update(void)
+{
+    common::lock_t lock(mtx);
+
+    if (!update_pending) return true;
+
+    std::string srv_msg;
+    if (not client.try_recv(srv_msg))
+        return false; // sensor frame not yet arrived
 
+    update_pending = false;
+
+    if (srv_msg.empty()) {
+        wrn_msg("Received no more bytes. Cancel reading sensory data.");
+        close_connection();
+        return true;
+    }
+
+    parse_sensor_data(srv_msg);
+    update_derived_quantities();
+    return true;
+}
+
+void
+Simloid::update_derived_quantities(void)
+{
     update_avg_position();
     update_avg_velocity();
     update_rotation_z();
     update_robot_velocity();
-    return true;
 }
 
 
@@ -316,18 +362,23 @@ void
 Simloid::read_sensor_data(void)
 {
     static std::string srv_msg;
-    unsigned charcount = 0;
 
     srv_msg = client.recv(60*network::constants::seconds_us);
 
-    unsigned len = srv_msg.length();
-
-    if (0 == len)
+    if (srv_msg.empty())
     {
         wrn_msg("Received no more bytes. Cancel reading sensory data.");
         close_connection();
         return;
     }
+    parse_sensor_data(srv_msg);
+}
+
+void
+Simloid::parse_sensor_data(const std::string& srv_msg)
+{
+    unsigned charcount = 0;
+    unsigned len = srv_msg.length();
 
     /* read time stamp */
     const char *server_message = srv_msg.c_str();
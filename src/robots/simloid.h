@@ -46,6 +46,7 @@ private:
 
     network::Socket_Client client;
     bool connection_established;
+    bool update_pending;
     bool record_frame;
     Robot_Configuration configuration;
 
@@ -74,6 +75,8 @@ private:
     void init_robot(void);
     void read_robot_configuration(void);
     void read_sensor_data(void);
+    void parse_sensor_data(const std::string& srv_msg);
+    void update_derived_quantities(void);
     void write_motor_data(void);
     void send_pause_command(void);
     void reset(void);
@@ -88,6 +91,15 @@ public:
     ~Simloid(void);
 
     bool update(void); //locking
+
+    /* split-phase update for event-driven use, e.g. with the Evaluation_Scheduler:
+     * send the motor data, wait on get_descriptor() to become readable
+     * and call complete_update() until it returns true. */
+    bool begin_update(void);    //locking
+    bool complete_update(void); //locking, non-blocking
+    bool is_update_pending(void) const { return update_pending; }
+    int  get_descriptor(void) const { return client.get_descriptor(); }
+
     bool idle(void); //locking
     bool is_connected(void) const { return connection_established; }
     void restore_state(void); //locking
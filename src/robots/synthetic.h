@@ -0,0 +1,214 @@
+#ifndef SYNTHETIC_H_INCLUDED
+#define SYNTHETIC_H_INCLUDED
+
+#include <cmath>
+#include <string>
+#include <vector>
+#include <cassert>
+#include <cstdint>
+
+#include <common/modules.h>
+#include <common/vector3.h>
+#include <common/robot_conf.h>
+#include <common/random_stream.h>
+#include <robots/joint.h>
+#include <robots/accel.h>
+#include <robots/robot.h>
+
+namespace robots {
+
+struct Synthetic_Parameters
+{
+    unsigned number_of_joints           = 8;
+    unsigned number_of_symmetric_joints = 0;    /* pairs (0,1), (2,3), ... */
+    unsigned number_of_accels           = 2;
+
+    double   stiffness = 4.0;   /* spring to the joint's default position */
+    double   damping   = 1.0;
+    double   coupling  = 2.0;   /* springs between neighboring joints     */
+    double   gain      = 20.0;  /* motor torque                           */
+    double   noise     = 0.0;   /* std. dev. of the torque noise          */
+    double   dt        = 0.01;  /* step size [s], 100 Hz like simloid     */
+    double   segment   = 0.1;   /* length of the body segments [m]        */
+    uint32_t seed      = 5489u;
+};
+
+/* In-process stand-in for Simloid, to run and profile the learning stack
+ * at high rates without the simulator.
+ *
+ * The joints form a chain of damped, coupled oscillators driven by the
+ * motors, with hard stops at the joint limits and seeded torque noise.
+ * The bodies are the links of a planar chain bent by the joint angles,
+ * the acceleration sensors sit on the bodies. Joints, accels and bodies
+ * come from a Robot_Configuration read from the same kind of description
+ * simloid sends, hence components see the layout of a simulated robot.
+ * A cycle is a single Euler step, noise from its own random stream.
+ */
+class Synthetic_Robot : public Robot_Interface
+{
+public:
+    explicit Synthetic_Robot(Synthetic_Parameters const& params = Synthetic_Parameters())
+    : params(params)
+    , configuration(make_description(params), /*interlaced=*/false)
+    , stream(params.seed)
+    , velocity(configuration.number_of_joints)
+    , body_velocity0(configuration.number_of_bodies)
+    , cycles(0)
+    {
+        assert(params.number_of_joints >= 2 * params.number_of_symmetric_joints);
+        assert(configuration.get_number_of_symmetric_joints() == params.number_of_symmetric_joints);
+        reset();
+    }
+
+    /* joints to their default positions at rest, restarts the noise */
+    void reset(void)
+    {
+        for (std::size_t i = 0; i < configuration.joints.size(); ++i) {
+            Joint_Model& j = configuration.joints[i];
+            j.s_ang = j.default_pos;
+            j.s_vel = .0;
+            j.s_cur = .0;
+            j.motor.reset();
+            velocity[i] = .0;
+        }
+        for (auto& a : configuration.accels)
+            a.reset();
+        stream.seed(params.seed);
+        update_bodies();
+        for (std::size_t b = 0; b < configuration.bodies.size(); ++b) {
+            configuration.bodies[b].velocity.zero();
+            body_velocity0[b].zero();
+        }
+        cycles = 0;
+    }
+
+    bool execute_cycle(void)
+    {
+        Jointvector_t& joints = configuration.joints;
+        const std::size_t N = joints.size();
+        const double dt = params.dt;
+
+        /* coupling with the not yet updated angles of the neighbors */
+        double left = joints[0].s_ang;
+        for (std::size_t i = 0; i < N; ++i)
+        {
+            Joint_Model& j = joints[i];
+            const double x = j.s_ang;
+            const double u = clip(j.motor.get());
+            const double right = (i + 1 < N) ? joints[i + 1].s_ang : x;
+
+            double torque = - params.stiffness * (x - j.default_pos)
+                            - params.damping   * velocity[i]
+                            + params.coupling  * (left - 2*x + right)
+                            + params.gain      * u;
+            if (params.noise > .0)
+                torque += stream.normal(params.noise);
+
+            velocity[i] += torque * dt;
+            j.s_ang += velocity[i] * dt;
+            if (j.s_ang < j.limit_lo) { j.s_ang = j.limit_lo; velocity[i] = .0; } /* joint stops */
+            if (j.s_ang > j.limit_hi) { j.s_ang = j.limit_hi; velocity[i] = .0; }
+            j.s_vel = clip(velocity[i]); /* sensor range like simloid */
+            j.s_cur = u;
+
+            left = x;
+        }
+
+        update_bodies();
+        update_accels();
+
+        for (auto& j : joints) {
+            j.motor.transfer();
+            j.motor = .0;
+        }
+        ++cycles;
+        return true;
+    }
+
+    std::size_t get_number_of_joints          (void) const { return configuration.number_of_joints;                 }
+    std::size_t get_number_of_symmetric_joints(void) const { return configuration.get_number_of_symmetric_joints(); }
+    std::size_t get_number_of_accel_sensors   (void) const { return configuration.number_of_accels;                 }
+    std::size_t get_number_of_bodies          (void) const { return configuration.number_of_bodies;                 }
+
+    const Jointvector_t& get_joints(void) const { return configuration.joints; }
+          Jointvector_t& set_joints(void)       { return configuration.joints; }
+
+    const Accelvector_t& get_accels(void) const { return configuration.accels; }
+          Accelvector_t& set_accels(void)       { return configuration.accels; }
+
+    const Bodyvector_t& get_bodies(void) const { return configuration.bodies; }
+
+    Robot_Configuration&       get_configuration(void)       { return configuration; }
+    Robot_Configuration const& get_configuration(void) const { return configuration; }
+
+    uint64_t get_cycles(void) const { return cycles; }
+
+    /* same as Simloid */
+    double get_normalized_mechanical_power(void) const
+    {
+        double power = .0;
+        for (auto& j: configuration.joints)
+            power += square(j.motor.get());
+        return power/configuration.number_of_joints;
+    }
+
+    /* robot description in the format of simloid's configuration message */
+    static std::string make_description(Synthetic_Parameters const& params)
+    {
+        const unsigned N = params.number_of_joints;
+        std::string msg = std::to_string(N + 1) + " " + std::to_string(N) + " " + std::to_string(params.number_of_accels) + "\n";
+
+        for (unsigned i = 0; i < N; ++i) {
+            const bool paired = i < 2 * params.number_of_symmetric_joints;
+            const unsigned type = (paired and i % 2 == 1) ? 1 : 0;
+            const unsigned sym  = paired ? (i ^ 1u) : i;
+            msg += std::to_string(i) + " " + std::to_string(type) + " " + std::to_string(sym)
+                 + " -5.0e-01 5.0e-01 0.0e+00 joint" + std::to_string(i) + "\n";
+        }
+        for (unsigned b = 0; b <= N; ++b)
+            msg += std::to_string(b) + " body" + std::to_string(b) + "\n";
+        return msg;
+    }
+
+private:
+
+    /* planar chain, upright at the default positions, base fixed at the origin */
+    void update_bodies(void)
+    {
+        Bodyvector_t& bodies = configuration.bodies;
+        Vector3 p(.0, .0, .0);
+        double phi = M_PI/2;
+        bodies[0].position = p;
+        for (std::size_t i = 0; i < configuration.joints.size(); ++i) {
+            phi += M_PI * configuration.joints[i].s_ang;
+            p.x += params.segment * cos(phi);
+            p.z += params.segment * sin(phi);
+            Body_Segment& b = bodies[i + 1];
+            b.velocity = (p - b.position) / params.dt;
+            b.position = p;
+        }
+    }
+
+    /* body accelerations and gravity, sensor k on body k+1 */
+    void update_accels(void)
+    {
+        Bodyvector_t& bodies = configuration.bodies;
+        for (std::size_t k = 0; k < configuration.accels.size(); ++k) {
+            const std::size_t b = (k + 1) % bodies.size();
+            configuration.accels[k].a = (bodies[b].velocity - body_velocity0[b]) / params.dt + Vector3(.0, .0, 9.81);
+        }
+        for (std::size_t b = 0; b < bodies.size(); ++b)
+            body_velocity0[b] = bodies[b].velocity;
+    }
+
+    const Synthetic_Parameters params;
+    Robot_Configuration        configuration;
+    common::Random_Stream      stream;
+    std::vector<double>        velocity;       /* joint velocities, unclipped */
+    std::vector<Vector3>       body_velocity0;
+    uint64_t                   cycles;
+};
+
+} // namespace robots
+
+#endif // SYNTHETIC_H_INCLUDED
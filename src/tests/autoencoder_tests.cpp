@@ -14,11 +14,11 @@ struct Test_Sensor_Space : public sensor_vector {
     : sensor_vector(2*joints.size() + 1)
     {
         for (robots::Joint_Model const& j : joints)
-            sensors.emplace_back(j.name + "_ang", [&j](){ return j.s_ang; });
+            add_sensor(j.name + "_ang", [&j](){ return j.s_ang; });
         for (robots::Joint_Model const& j : joints)
-            sensors.emplace_back(j.name + "_vel", [&j](){ return j.s_vel; });
+            add_sensor(j.name + "_vel", [&j](){ return j.s_vel; });
 
-        sensors.emplace_back("bias", [&](){ return 0.01; });
+        add_sensor("bias", [&](){ return 0.01; });
         assert(sensors.size() == 2*joints.size() + 1);
     }
 };
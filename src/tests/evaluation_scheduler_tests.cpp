@@ -0,0 +1,126 @@
+#include <tests/catch.hpp>
+
+#include <unistd.h>
+#include <fcntl.h>
+#include <set>
+#include <common/log_messages.h>
+#include <evolution/evaluation_scheduler.h>
+
+namespace local_tests {
+namespace evaluation_scheduler_tests {
+
+/* fake simulator connection: every step 'sends' a request by writing a byte
+ * into a pipe and waits for it to become readable, like waiting for the next
+ * sensor frame of a simloid */
+class Pipe_Evaluation : public Resumable_Evaluation_Interface
+{
+    int fds[2];
+    Fitness_Value* fitness;
+    const genome_t* genome;
+    unsigned steps;
+    const unsigned max_steps;
+    double sum;
+
+public:
+    std::vector<const Pipe_Evaluation*>* trace;
+
+    Pipe_Evaluation(unsigned max_steps) : fds(), fitness(), genome(), steps(), max_steps(max_steps), sum(), trace()
+    {
+        REQUIRE( 0 == pipe(fds) );
+        fcntl(fds[0], F_SETFL, fcntl(fds[0], F_GETFL, 0) | O_NONBLOCK);
+    }
+    ~Pipe_Evaluation() { close(fds[0]); close(fds[1]); }
+
+    void start(Fitness_Value& f, const genome_t& g, double) override {
+        fitness = &f; genome = &g; steps = 0; sum = .0;
+        REQUIRE( 1 == write(fds[1], "x", 1) );
+    }
+
+    Evaluation_Status resume(void) override {
+        char c;
+        if (1 != read(fds[0], &c, 1)) return Evaluation_Status::waiting;
+        if (trace) trace->push_back(this);
+        for (auto const& g : *genome) sum += g;
+        if (++steps == max_steps) {
+            fitness->set_value(sum);
+            return Evaluation_Status::finished;
+        }
+        REQUIRE( 1 == write(fds[1], "x", 1) );
+        return Evaluation_Status::waiting;
+    }
+
+    int get_descriptor(void) const override { return fds[0]; }
+    void prepare_generation(unsigned, unsigned) override {}
+    void prepare_evaluation(unsigned, unsigned) override {}
+};
+
+class Dummy_Blocking_Evaluation : public Evaluation_Interface
+{
+public:
+    bool evaluate(Fitness_Value& fitness, const genome_t& genome, double rand_value) override {
+        fitness.set_value(genome.at(0) + rand_value);
+        return true;
+    }
+    void prepare_generation(unsigned, unsigned) override {}
+    void prepare_evaluation(unsigned, unsigned) override {}
+};
+
+}} // namespace local_tests::evaluation_scheduler_tests
+
+TEST_CASE( "evaluation scheduler interleaves resumable evaluations", "[evolution]" )
+{
+    using namespace local_tests::evaluation_scheduler_tests;
+    const unsigned num_workers = 4, num_jobs = 11, max_steps = 50;
+
+    std::vector<std::unique_ptr<Pipe_Evaluation>> evals;
+    std::vector<Resumable_Evaluation_Interface*> workers;
+    std::vector<const Pipe_Evaluation*> trace;
+    for (unsigned i = 0; i < num_workers; ++i) {
+        evals.emplace_back(new Pipe_Evaluation(max_steps));
+        evals.back()->trace = &trace;
+        workers.push_back(evals.back().get());
+    }
+
+    std::vector<std::vector<double>> genomes(num_jobs);
+    std::vector<Fitness_Value> fitness(num_jobs);
+    for (unsigned j = 0; j < num_jobs; ++j) genomes[j] = { 1.0*j, 0.5 };
+
+    Evaluation_Scheduler scheduler(workers);
+    for (unsigned j = 0; j < num_jobs; ++j)
+        scheduler.add_job(fitness[j], genomes[j], 0.0);
+    REQUIRE( scheduler.get_number_of_jobs() == num_jobs );
+
+    REQUIRE( scheduler.run() );
+    REQUIRE( scheduler.get_number_of_jobs() == 0 );
+
+    for (unsigned j = 0; j < num_jobs; ++j) {
+        REQUIRE( fitness[j].get_number_of_evaluations() == 1 );
+        REQUIRE( fitness[j].get_value() == max_steps * (1.0*j + 0.5) );
+    }
+    /* all workers have been running concurrently from the start */
+    REQUIRE( trace.size() == num_jobs * max_steps );
+    std::set<const Pipe_Evaluation*> first_steps(trace.begin(), trace.begin() + num_workers);
+    REQUIRE( first_steps.size() == num_workers );
+}
+
+TEST_CASE( "blocking adapters", "[evolution]" )
+{
+    using namespace local_tests::evaluation_scheduler_tests;
+
+    /* resumable evaluation driven to completion by the blocking adapter */
+    Pipe_Evaluation resumable(20);
+    Blocking_Evaluation blocking(resumable);
+    Fitness_Value fit;
+    REQUIRE( blocking.evaluate(fit, {1.0, 2.0}, 0.0) );
+    REQUIRE( fit.get_value() == 60.0 );
+
+    /* existing blocking evaluation inside the scheduler */
+    Dummy_Blocking_Evaluation dummy;
+    Blocking_Evaluation_Adapter adapter(dummy);
+    Evaluation_Scheduler scheduler({&adapter});
+    std::vector<double> genome = {0.25};
+    Fitness_Value fit2;
+    scheduler.add_job(fit2, genome, 0.5);
+    REQUIRE( scheduler.run() );
+    REQUIRE( fit2.get_value() == 0.75 );
+}
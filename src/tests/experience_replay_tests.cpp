@@ -0,0 +1,290 @@
+#include <tests/catch.hpp>
+
+#include <common/modules.h>
+#include <common/stopwatch.h>
+#include <common/log_messages.h>
+#include <control/sensorspace.h>
+#include <learning/payload.h>
+#include <learning/predictor.h>
+#include <learning/expert_vector.h>
+#include <learning/experience_replay.h>
+
+namespace local_tests {
+namespace experience_replay_tests {
+
+using learning::Experience_Pool;
+using learning::Experience_Replay;
+
+void set_signals(VectorN& x, std::size_t t) {
+    for (std::size_t i = 0; i < x.size(); ++i)
+        x[i] = 0.5 * sin(0.01 * t * (1 + i % 7) + i);
+}
+
+/* replay as it was before: one heap block per sample, learning the list */
+struct Plain_Replay {
+    std::vector<VectorN> experience;
+    VectorN weights;
+
+    Plain_Replay(std::size_t size, VectorN const& x) : experience(size, x), weights(x) {}
+
+    void adapt(VectorN const& x, double rate) {
+        const std::size_t skip = random_index(experience.size());
+        for (std::size_t m = 0; m < weights.size(); ++m) {
+            double delta = .0;
+            for (std::size_t i = 0; i < experience.size(); ++i)
+                if (i != skip)
+                    delta += experience[i][m] - weights[m];
+            weights[m] += delta * rate / (experience.size() - 1);
+        }
+        for (std::size_t m = 0; m < weights.size(); ++m)
+            weights[m] += rate * (x[m] - weights[m]) / experience.size();
+        experience[skip] = x;
+    }
+
+    /* payload plus the usual allocator overhead of 16 bytes per block */
+    std::size_t bytes(void) const {
+        return experience.size() * (sizeof(VectorN) + 16 + weights.size() * sizeof(double));
+    }
+};
+
+}} // namespace local_tests::experience_replay_tests
+
+TEST_CASE( "experience pool hands out and recycles rows", "[experience]" )
+{
+    using namespace local_tests::experience_replay_tests;
+    auto pool = std::make_shared<Experience_Pool>(3);
+    Experience_Replay a(5, pool);
+    {
+        Experience_Replay b(5, pool);
+        REQUIRE( pool->capacity() == 10 );
+        REQUIRE( pool->rows_in_use() == 10 );
+        b.fill(VectorN{1.0, 2.0, 3.0});
+        a = b;
+        REQUIRE( a.sum(2) == 15.0 );
+    }
+    REQUIRE( pool->rows_in_use() == 5 );
+
+    Experience_Replay c(3, pool);
+    REQUIRE( pool->capacity() == 10 ); // recycled
+    for (std::size_t i = 0; i < c.size(); ++i)
+        for (std::size_t m = 0; m < c.dimension(); ++m)
+            REQUIRE( c[i][m] == 0.0 );
+
+    c.replace(1, VectorN{0.5, -0.5, 0.25});
+    REQUIRE( c.sum(0) ==  0.5 );
+    REQUIRE( c.sum(1) == -0.5 );
+    REQUIRE( a[4][1] == 2.0 );
+
+    /* moving keeps the samples */
+    auto other = std::make_shared<Experience_Pool>(3, Experience_Pool::Storage::int16);
+    c.move_to(other);
+    REQUIRE( pool->rows_in_use() == 5 );
+    REQUIRE( other->rows_in_use() == 3 );
+    REQUIRE( c[1][2] == Approx(0.25).epsilon(1e-4) );
+}
+
+TEST_CASE( "copied experience shares rows until written", "[experience]" )
+{
+    using namespace local_tests::experience_replay_tests;
+    srand(2345);
+    auto pool = std::make_shared<Experience_Pool>(4);
+    Experience_Replay a(10, pool), b(10, pool);
+    for (std::size_t i = 0; i < a.size(); ++i)
+        a.replace(i, random_vector(4, -1.0, 1.0));
+    REQUIRE( pool->rows_in_use() == 20 );
+
+    b = a;
+    REQUIRE( pool->rows_in_use() == 10 );
+    REQUIRE( b.shared_rows() == 10 );
+    for (std::size_t m = 0; m < 4; ++m)
+        REQUIRE( b.sum(m) == a.sum(m) );
+
+    /* first write detaches one row of the writer only */
+    const VectorN x = {0.1, 0.2, 0.3, 0.4};
+    const VectorN a3 = {a[3][0], a[3][1], a[3][2], a[3][3]};
+    b.replace(3, x);
+    REQUIRE( pool->rows_in_use() == 11 );
+    REQUIRE( b.shared_rows() == 9 );
+    REQUIRE( a.shared_rows() == 9 );
+    for (std::size_t m = 0; m < 4; ++m) {
+        REQUIRE( b[3][m] == x[m] );
+        REQUIRE( a[3][m] == a3[m] );
+        REQUIRE( close(b.sum(m) - a.sum(m), x[m] - a3[m], 1e-12) );
+    }
+
+    /* row 3 of 'a' is private now and written in place */
+    a.replace(3, x);
+    REQUIRE( pool->rows_in_use() == 11 );
+
+    b.fill(x);
+    REQUIRE( b.shared_rows() == 0 );
+    REQUIRE( a.shared_rows() == 0 );
+    REQUIRE( pool->rows_in_use() == 20 );
+}
+
+TEST_CASE( "quantized experience keeps exact sums", "[experience]" )
+{
+    using namespace local_tests::experience_replay_tests;
+    srand(1234);
+    const std::vector<double> range = {1.0, 1.0, 2.0, 0.5};
+    auto pool = std::make_shared<Experience_Pool>(range.size(), Experience_Pool::Storage::int16, range);
+    Experience_Replay replay(20, pool);
+
+    VectorN x(range.size());
+    for (std::size_t t = 0; t < 1000; ++t) {
+        for (std::size_t m = 0; m < x.size(); ++m)
+            x[m] = random_value(-1.2 * range[m], 1.2 * range[m]);
+        const std::size_t i = random_index(replay.size());
+        replay.replace(i, x);
+        for (std::size_t m = 0; m < x.size(); ++m) {
+            const double expected = clip(x[m], -range[m], range[m]);
+            REQUIRE( close(replay[i][m], expected, range[m] / 65534 + 1e-15) );
+        }
+    }
+    for (std::size_t m = 0; m < x.size(); ++m) {
+        double sum = .0;
+        for (std::size_t i = 0; i < replay.size(); ++i)
+            sum += replay[i][m];
+        REQUIRE( close(replay.sum(m), sum, 1e-12) );
+    }
+    REQUIRE( pool->bytes() == 20 * range.size() * sizeof(int16_t) );
+}
+
+TEST_CASE( "predictor with quantized experience learns like exact", "[experience][predictor]" )
+{
+    using namespace local_tests::experience_replay_tests;
+    const std::size_t M = 100, T = 3000;
+    VectorN x(16);
+    set_signals(x, 0);
+    sensor_vector sensors(x);
+
+    Predictor exact    { sensors, 0.1, 0.01, M };
+    Predictor quantized{ sensors, 0.1, 0.01, M };
+    quantized.share_experience(std::make_shared<Experience_Pool>(x.size(), Experience_Pool::Storage::int16));
+
+    double max_diff = .0;
+    for (std::size_t t = 1; t <= T; ++t) {
+        set_signals(x, t);
+        sensors.execute_cycle();
+        srand(t); exact.adapt();
+        srand(t); quantized.adapt();
+        for (std::size_t m = 0; m < x.size(); ++m)
+            max_diff = std::max(max_diff, std::abs(exact.get_weights()[m] - quantized.get_weights()[m]));
+    }
+    dbg_msg("max. weight difference: %e", max_diff);
+    REQUIRE( max_diff < 1e-4 );
+}
+
+TEST_CASE( "experts share one replay pool", "[experience][expert_vector]" )
+{
+    using namespace local_tests::experience_replay_tests;
+    const std::size_t Nmax = 7, M = 10;
+    VectorN x(5);
+    set_signals(x, 0);
+    sensor_vector sensors(x);
+    static_vector<Empty_Payload> payloads(Nmax);
+    Expert_Vector experts(Nmax, payloads, sensors, 0.1, 0.05, M);
+
+    auto const* pool = experts.get_experience_pool();
+    REQUIRE( pool != nullptr );
+    REQUIRE( pool->rows_in_use() == M ); // first expert only, others are constructed lazily
+    experts.preallocate(Nmax);
+    REQUIRE( pool->rows_in_use() == Nmax * M );
+    REQUIRE( pool->bytes() == Nmax * M * x.size() * sizeof(double) );
+    for (std::size_t i = 0; i < Nmax; ++i)
+        REQUIRE( &experts[i].get_predictor().get_experience().get_pool() == pool );
+
+    experts.share_experience(Experience_Pool::Storage::int16);
+    REQUIRE( experts.get_experience_pool()->bytes() == Nmax * M * x.size() * sizeof(int16_t) );
+
+    for (std::size_t t = 1; t < 100; ++t) {
+        set_signals(x, t);
+        sensors.execute_cycle();
+        experts[t % Nmax].set_predictor().adapt();
+    }
+    experts.copy(3, 1, false);
+    auto const& e1 = experts[1].get_predictor().get_experience();
+    auto const& e3 = experts[3].get_predictor().get_experience();
+    for (std::size_t i = 0; i < M; ++i)
+        for (std::size_t m = 0; m < x.size(); ++m)
+            REQUIRE( e1[i][m] == e3[i][m] );
+}
+
+TEST_CASE( "experience replay memory and timing", "[.][benchmark][experience]" )
+{
+    using namespace local_tests::experience_replay_tests;
+    const std::size_t experts = 50, M = 1000, T = 2000;
+
+    for (std::size_t dim : {16ul, 128ul, 500ul}) {
+        VectorN x(dim);
+        set_signals(x, 0);
+        sensor_vector sensors(x);
+
+        std::vector<Plain_Replay> plain(experts, Plain_Replay(M, x));
+        std::vector<std::unique_ptr<Predictor>> pooled, quantized;
+        auto pool   = std::make_shared<Experience_Pool>(dim, Experience_Pool::Storage::exact, std::vector<double>{}, experts * M);
+        auto pool16 = std::make_shared<Experience_Pool>(dim, Experience_Pool::Storage::int16, std::vector<double>{}, experts * M);
+        for (std::size_t e = 0; e < experts; ++e) {
+            pooled   .emplace_back(new Predictor(sensors, 0.1, 0.01, M));
+            quantized.emplace_back(new Predictor(sensors, 0.1, 0.01, M));
+            pooled   .back()->share_experience(pool);
+            quantized.back()->share_experience(pool16);
+        }
+
+        Stopwatch watch;
+        for (std::size_t t = 1; t <= T; ++t) {
+            set_signals(x, t);
+            plain[t % experts].adapt(x, 0.1);
+        }
+        const double t_plain = watch.get_time_passed_us() / 1000.0;
+
+        for (std::size_t t = 1; t <= T; ++t) {
+            set_signals(x, t);
+            sensors.execute_cycle();
+            pooled[t % experts]->adapt();
+        }
+        const double t_pooled = watch.get_time_passed_us() / 1000.0;
+
+        for (std::size_t t = 1; t <= T; ++t) {
+            set_signals(x, t);
+            sensors.execute_cycle();
+            quantized[t % experts]->adapt();
+        }
+        const double t_quantized = watch.get_time_passed_us() / 1000.0;
+
+        sts_msg("dim %3u, %u experts x %u samples: memory %7.1f / %7.1f / %7.1f MB (plain/pooled/int16),"
+                " %u steps %8.1f / %6.1f / %6.1f ms"
+               , dim, experts, M
+               , plain[0].bytes() * experts / 1e6, pool->bytes() / 1e6, pool16->bytes() / 1e6
+               , T, t_plain, t_pooled, t_quantized);
+    }
+}
+
+TEST_CASE( "expert cloning timing", "[.][benchmark][experience]" )
+{
+    using namespace local_tests::experience_replay_tests;
+    const std::size_t Nmax = 50, M = 1000, clones = 1000;
+
+    for (std::size_t dim : {16ul, 128ul, 500ul}) {
+        VectorN x(dim);
+        set_signals(x, 0);
+        sensor_vector sensors(x);
+        static_vector<Empty_Payload> payloads(Nmax);
+        Expert_Vector experts(Nmax, payloads, sensors, 0.1, 0.05, M);
+
+        /* private pools copy all samples */
+        Predictor a{ sensors, 0.1, 0.01, M }, b{ sensors, 0.1, 0.01, M };
+        Stopwatch watch;
+        for (std::size_t i = 0; i < clones; ++i)
+            a.copy(b);
+        const double t_copy = watch.get_time_passed_us() / double(clones);
+
+        for (std::size_t i = 0; i < clones; ++i) {
+            experts.copy(1 + i % (Nmax - 1), 0, false);
+            experts[0].adapt_weights(); // diverge
+        }
+        const double t_shared = watch.get_time_passed_us() / double(clones);
+
+        sts_msg("dim %3u, %u samples: clone %7.2f us (copy) %5.2f us (copy-on-write, incl. one adapt)", dim, M, t_copy, t_shared);
+    }
+}
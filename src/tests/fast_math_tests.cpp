@@ -0,0 +1,178 @@
+#include <tests/catch.hpp>
+
+#include <cfloat>
+#include <common/modules.h>
+#include <common/fast_math.h>
+
+namespace local_tests {
+namespace fast_math_tests {
+
+double relative_error(double value, double reference) {
+    if (value == reference) return .0;
+    return std::abs(value - reference) / std::abs(reference);
+}
+
+}} // namespace local_tests::fast_math_tests
+
+TEST_CASE( "vectorized exp matches libm", "[fast_math]" )
+{
+    using namespace local_tests::fast_math_tests;
+    const std::size_t N = 100001; // odd, so the scalar remainder is used too
+    VectorN x(N), y(N);
+    for (std::size_t i = 0; i < N; ++i)
+        x[i] = -708.0 + 1417.0 * i / (N - 1); // normal range of results
+
+    fast_math::exp(x.data(), y.data(), N);
+
+    double max_err = .0;
+    for (std::size_t i = 0; i < N; ++i) {
+        max_err = std::max(max_err, relative_error(y[i], std::exp(x[i])));
+        REQUIRE( close(y[i], fast_math::exp(x[i]), 2*DBL_EPSILON*y[i]) ); // array and scalar agree
+    }
+    REQUIRE( max_err < 2*DBL_EPSILON );
+
+    /* small arguments, as used for activations */
+    for (double v = -10.0; v <= 10.0; v += 0.001)
+        REQUIRE( relative_error(fast_math::exp(v), std::exp(v)) < 2*DBL_EPSILON );
+
+    /* special values */
+    VectorN s = { -INFINITY, -800.0, -745.0, .0, 709.7, 710.0, INFINITY, NAN };
+    fast_math::exp(s.data(), s.data(), s.size());
+    REQUIRE( s[0] == .0 );
+    REQUIRE( s[1] == .0 );
+    REQUIRE( s[2] > .0 );
+    REQUIRE( s[2] < 1e-320 ); // subnormal
+    REQUIRE( s[3] == 1.0 );
+    REQUIRE( relative_error(s[4], std::exp(709.7)) < 2*DBL_EPSILON );
+    REQUIRE( std::isinf(s[5]) );
+    REQUIRE( std::isinf(s[6]) );
+    REQUIRE( std::isnan(s[7]) );
+}
+
+namespace local_tests {
+namespace fast_math_tests {
+
+/* max. relative error of the array version over [lo,hi], scalar and array agree */
+template <typename Fast_t, typename Exact_t, typename Array_t>
+double max_error(double lo, double hi, Fast_t fast, Exact_t exact, Array_t array) {
+    const std::size_t N = 200001;
+    VectorN x(N), y(N);
+    for (std::size_t i = 0; i < N; ++i)
+        x[i] = lo + (hi - lo) * i / (N - 1);
+    array(x.data(), y.data(), N);
+
+    double max_err = .0;
+    for (std::size_t i = 0; i < N; ++i) {
+        REQUIRE( y[i] == fast(x[i]) );
+        max_err = std::max(max_err, relative_error(y[i], exact(x[i])));
+    }
+    return max_err;
+}
+
+}} // namespace local_tests::fast_math_tests
+
+TEST_CASE( "vectorized log, tanh, sigmoid and atanh match libm", "[fast_math]" )
+{
+    using namespace local_tests::fast_math_tests;
+
+    auto fast_log   = [](double x) { return fast_math::log(x); };
+    auto exact_log  = [](double x) { return std::log(x); };
+    auto array_log  = [](const double* x, double* y, std::size_t n) { fast_math::log(x, y, n); };
+    REQUIRE( max_error(1e-300, 1e300, fast_log, exact_log, array_log) < 2*DBL_EPSILON );
+    REQUIRE( max_error(0.5, 2.0, fast_log, exact_log, array_log) < 2*DBL_EPSILON );
+
+    /* activations of the networks */
+    auto fast_tanh  = [](double x) { return fast_math::tanh(x); };
+    auto exact_tanh = [](double x) { return std::tanh(x); };
+    auto array_tanh = [](const double* x, double* y, std::size_t n) { fast_math::tanh(x, y, n); };
+    REQUIRE( max_error(-20.0, 20.0, fast_tanh, exact_tanh, array_tanh) < 2*DBL_EPSILON );
+    REQUIRE( max_error(-1.0, 1.0, fast_tanh, exact_tanh, array_tanh) < 2*DBL_EPSILON );
+
+    auto fast_sigm  = [](double x) { return fast_math::sigmoid(x); };
+    auto exact_sigm = [](double x) { return 1.0 / (1.0 + std::exp(-x)); };
+    auto array_sigm = [](const double* x, double* y, std::size_t n) { fast_math::sigmoid(x, y, n); };
+    REQUIRE( max_error(-700.0, 700.0, fast_sigm, exact_sigm, array_sigm) < 3*DBL_EPSILON );
+
+    /* inverse transfer function, inputs in (-1,1) */
+    auto fast_atanh  = [](double x) { return fast_math::atanh(x); };
+    auto exact_atanh = [](double x) { return std::atanh(x); };
+    auto array_atanh = [](const double* x, double* y, std::size_t n) { fast_math::atanh(x, y, n); };
+    REQUIRE( max_error(-0.999999, 0.999999, fast_atanh, exact_atanh, array_atanh) < 2*DBL_EPSILON );
+    REQUIRE( max_error(-1e-6, 1e-6, fast_atanh, exact_atanh, array_atanh) < 2*DBL_EPSILON );
+
+    /* special values */
+    VectorN s = { .0, -1.0, INFINITY, NAN, 1e-310 };
+    fast_math::log(s.data(), s.data(), s.size());
+    REQUIRE( s[0] == -INFINITY );
+    REQUIRE( std::isnan(s[1]) );
+    REQUIRE( s[2] == INFINITY );
+    REQUIRE( std::isnan(s[3]) );
+    REQUIRE( relative_error(s[4], std::log(1e-310)) < 2*DBL_EPSILON ); // subnormal
+
+    VectorN t = { 1.0, -1.0, 1.5, INFINITY, -INFINITY, NAN };
+    VectorN u(t.size());
+    fast_math::atanh(t.data(), u.data(), t.size());
+    REQUIRE( u[0] ==  INFINITY );
+    REQUIRE( u[1] == -INFINITY );
+    REQUIRE( std::isnan(u[2]) );
+    fast_math::tanh(t.data(), u.data(), t.size());
+    REQUIRE( u[3] ==  1.0 );
+    REQUIRE( u[4] == -1.0 );
+    REQUIRE( std::isnan(u[5]) );
+}
+
+TEST_CASE( "vectorized sin matches libm", "[fast_math]" )
+{
+    using namespace local_tests::fast_math_tests;
+
+    /* absolute error, the relative one is unbounded near the zeros */
+    auto abs_error = [](double lo, double hi) {
+        const std::size_t N = 200001;
+        VectorN x(N), y(N);
+        for (std::size_t i = 0; i < N; ++i)
+            x[i] = lo + (hi - lo) * i / (N - 1);
+        fast_math::sin(x.data(), y.data(), N);
+        double max_err = .0;
+        for (std::size_t i = 0; i < N; ++i) {
+            REQUIRE( y[i] == fast_math::sin(x[i]) );
+            max_err = std::max(max_err, std::abs(y[i] - std::sin(x[i])));
+        }
+        return max_err;
+    };
+    REQUIRE( abs_error(-M_PI, M_PI) <= DBL_EPSILON );
+    REQUIRE( abs_error(-1e4, 1e4) <= DBL_EPSILON );
+    REQUIRE( abs_error(1e7, 1e8) <= DBL_EPSILON );
+
+    /* small arguments are exact to the last bits */
+    for (double v = 1e-300; v < 0.1; v *= 1.1)
+        REQUIRE( relative_error(fast_math::sin(v), std::sin(v)) < 2*DBL_EPSILON );
+
+    /* special values */
+    VectorN s = { .0, -.0, 1e9, -1e300, INFINITY, NAN };
+    VectorN u(s.size());
+    fast_math::sin(s.data(), u.data(), s.size());
+    REQUIRE( u[0] == 0.0 );
+    REQUIRE( std::signbit(u[1]) );
+    REQUIRE( u[2] == std::sin(1e9) );
+    REQUIRE( u[3] == std::sin(-1e300) );
+    REQUIRE( std::isnan(u[4]) );
+    REQUIRE( std::isnan(u[5]) );
+}
+
+TEST_CASE( "fast math mode selection", "[fast_math]" )
+{
+    VectorN x = random_vector(11, -3.0, 3.0), y(x.size()), z(x.size());
+
+    fast_math::tanh(x.data(), y.data(), x.size(), fast_math::Mode::exact);
+    fast_math::tanh(x.data(), z.data(), x.size(), fast_math::Mode::fast);
+    for (std::size_t i = 0; i < x.size(); ++i) {
+        REQUIRE( y[i] == std::tanh(x[i]) );
+        REQUIRE( z[i] == fast_math::tanh(x[i]) );
+    }
+
+    /* float arrays are evaluated element-wise */
+    std::vector<float> xf(x.begin(), x.end()), yf(x.size());
+    fast_math::exp(xf.data(), yf.data(), xf.size(), fast_math::Mode::fast);
+    for (std::size_t i = 0; i < x.size(); ++i)
+        REQUIRE( yf[i] == static_cast<float>(fast_math::exp(static_cast<double>(xf[i]))) );
+}
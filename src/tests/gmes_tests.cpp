@@ -0,0 +1,414 @@
+#include <tests/catch.hpp>
+
+#include <common/modules.h>
+#include <common/random_stream.h>
+#include <common/stopwatch.h>
+#include <common/thread_pool.h>
+#include <common/log_messages.h>
+#include <control/sensorspace.h>
+#include <learning/payload.h>
+#include <learning/expert_vector.h>
+#include <learning/gmes.h>
+
+namespace local_tests {
+namespace gmes_tests {
+
+/* synthetic input stream, switching between a few
+ * oscillatory regimes every 'period' cycles */
+class Synthetic_Stream : public sensor_vector {
+public:
+    Synthetic_Stream(std::size_t dim, std::size_t period = 250)
+    : sensor_vector(dim + 1), t(0), period(period), values(dim)
+    {
+        for (std::size_t i = 0; i < dim; ++i)
+            add_sensor("x" + std::to_string(i), [this, i](){ return values[i]; });
+        add_sensor("bias", [](){ return 0.1; });
+    }
+
+    void execute_cycle(void) {
+        const std::size_t regime = (t / period) % 4;
+        for (std::size_t i = 0; i < values.size(); ++i)
+            values[i] = 0.5 * sin(0.05 * t * (1 + regime) + i * (0.3 + 0.2 * regime));
+        ++t;
+        sensor_vector::execute_cycle();
+    }
+
+private:
+    std::size_t t;
+    const std::size_t period;
+    VectorN values;
+};
+
+struct Record {
+    std::vector<std::size_t> winners;
+    std::vector<double>      errors;
+    std::size_t              num_experts;
+};
+
+Record run_tdn_gmes(common::Thread_Pool* pool, std::size_t grain, std::size_t Nmax, std::size_t cycles, bool shared_delay_line = false, bool preallocate = false)
+{
+    srand(1337);
+    Synthetic_Stream stream(6);
+    static_vector<Empty_Payload> payloads(Nmax);
+    learning::FIR_type_synapse delay_line(stream.size(), /*taps*/3);
+    Expert_Vector experts = shared_delay_line
+                          ? Expert_Vector(Nmax, payloads, stream, delay_line, 0.2, /*experience*/1, /*hidden*/5)
+                          : Expert_Vector(Nmax, payloads, stream, 0.2, /*experience*/1, /*hidden*/5, /*taps*/3);
+    if (preallocate) experts.preallocate(Nmax);
+    GMES gmes(experts, 200.0, false);
+    if (pool) gmes.enable_parallel_prediction(*pool, grain);
+
+    Record rec{ {}, {}, 0 };
+    for (std::size_t t = 0; t < cycles; ++t) {
+        stream.execute_cycle();
+        delay_line.propagate(stream);
+        gmes.execute_cycle();
+        rec.winners.push_back(gmes.get_winner());
+        rec.errors .push_back(gmes.get_min_prediction_error());
+    }
+    rec.num_experts = gmes.get_number_of_experts();
+    return rec;
+}
+
+}} // namespace local_tests::gmes_tests
+
+TEST_CASE( "parallel prediction is bit-identical to serial", "[gmes]" )
+{
+    using namespace local_tests::gmes_tests;
+    const std::size_t Nmax = 13, cycles = 1500;
+
+    Record serial = run_tdn_gmes(nullptr, 1, Nmax, cycles);
+    REQUIRE( serial.num_experts > 1 );
+
+    for (std::size_t grain : {1ul, 3ul, 16ul}) {
+        common::Thread_Pool pool(4);
+        Record parallel = run_tdn_gmes(&pool, grain, Nmax, cycles);
+        REQUIRE( parallel.num_experts == serial.num_experts );
+        REQUIRE( parallel.winners == serial.winners );
+        REQUIRE( parallel.errors  == serial.errors ); // exact, not close
+    }
+}
+
+TEST_CASE( "experts sharing one delay line behave like experts with own ones", "[gmes]" )
+{
+    using namespace local_tests::gmes_tests;
+    const std::size_t Nmax = 13, cycles = 1500;
+
+    Record own = run_tdn_gmes(nullptr, 1, Nmax, cycles);
+    Record shared = run_tdn_gmes(nullptr, 1, Nmax, cycles, /*shared delay line =*/ true);
+    REQUIRE( shared.num_experts == own.num_experts );
+    REQUIRE( shared.winners == own.winners );
+    REQUIRE( shared.errors  == own.errors );
+
+    common::Thread_Pool pool(4);
+    Record parallel = run_tdn_gmes(&pool, 2, Nmax, cycles, true);
+    REQUIRE( parallel.winners == own.winners );
+    REQUIRE( parallel.errors  == own.errors );
+}
+
+TEST_CASE( "thread pool covers range exactly once", "[thread_pool]" )
+{
+    common::Thread_Pool pool(3);
+    for (std::size_t grain : {1ul, 2ul, 7ul, 100ul}) {
+        std::vector<unsigned> hits(97, 0);
+        pool.parallel_for(hits.size(), grain, [&hits](std::size_t begin, std::size_t end) {
+            for (std::size_t i = begin; i < end; ++i) ++hits[i];
+        });
+        for (auto h : hits) REQUIRE( h == 1 );
+    }
+}
+
+TEST_CASE( "parallel prediction scaling", "[.][benchmark][gmes]" )
+{
+    using namespace local_tests::gmes_tests;
+    const std::size_t Nmax = 50, cycles = 2000;
+    Stopwatch watch;
+
+    Record reference = run_tdn_gmes(nullptr, 1, Nmax, cycles);
+    const double t_serial = watch.get_time_passed_us() / 1000.0;
+    sts_msg("serial:              %8.1f ms", t_serial);
+
+    for (std::size_t threads = 2; threads <= std::max(2u, std::thread::hardware_concurrency()); threads *= 2)
+        for (std::size_t grain : {1ul, 4ul, 8ul}) {
+            common::Thread_Pool pool(threads);
+            watch.get_time_passed_us();
+            Record rec = run_tdn_gmes(&pool, grain, Nmax, cycles);
+            const double t = watch.get_time_passed_us() / 1000.0;
+            sts_msg("threads %2u grain %2u: %8.1f ms  speedup %4.2f", threads, grain, t, t_serial/t);
+            REQUIRE( rec.winners == reference.winners );
+        }
+}
+
+#include <learning/prototype_search.h>
+TEST_CASE( "prototype search finds nearest prototype", "[gmes][prototype_search]" )
+{
+    srand(4242);
+    const std::size_t N = 200, dim = 13;
+    std::vector<VectorN> protos(N);
+    for (auto& p : protos) p = random_vector(dim, -1.0, 1.0);
+
+    learning::Prototype_Search linear(N, dim), indexed(N, dim);
+    for (std::size_t i = 0; i < N; ++i) {
+        if (i % 7 == 3) continue; // some prototypes do not exist
+        linear .set(i, protos[i]);
+        indexed.set(i, protos[i]);
+    }
+    indexed.enable_index();
+
+    for (std::size_t t = 0; t < 500; ++t) {
+        VectorN x = random_vector(dim, -1.0, 1.0);
+
+        std::size_t brute = N;
+        double brute_d2 = INFINITY;
+        for (std::size_t i = 0; i < N; ++i) {
+            if (i % 7 == 3) continue;
+            const double d2 = squared_distance(x, protos[i]);
+            if (d2 < brute_d2) { brute_d2 = d2; brute = i; }
+        }
+
+        double d2_lin, d2_idx;
+        linear .set_input(x);
+        indexed.set_input(x);
+        REQUIRE( linear .nearest(d2_lin) == brute );
+        REQUIRE( indexed.nearest(d2_idx) == brute );
+        REQUIRE( close(d2_lin, brute_d2, 1e-12) );
+        REQUIRE( d2_lin == d2_idx );
+
+        /* move the winner towards the input, like adapt_weights does */
+        for (std::size_t k = 0; k < dim; ++k)
+            protos[brute][k] += 0.3 * (x[k] - protos[brute][k]);
+        linear .set(brute, protos[brute]);
+        indexed.set(brute, protos[brute]);
+    }
+}
+
+namespace local_tests {
+namespace gmes_tests {
+
+std::vector<std::size_t> run_prototype_gmes(int mode, std::size_t Nmax, std::size_t cycles, std::vector<VectorN>* activations = nullptr)
+{
+    srand(2323);
+    Synthetic_Stream stream(8, 100);
+    static_vector<Empty_Payload> payloads(Nmax);
+    Expert_Vector experts(Nmax, payloads, stream, 0.1, 0.05, /*experience*/10);
+    GMES gmes(experts, 35.0, true);
+    if (mode > 0) gmes.enable_prototype_search(/*use index =*/ mode > 1);
+
+    std::vector<std::size_t> winners;
+    for (std::size_t t = 0; t < cycles; ++t) {
+        stream.execute_cycle();
+        gmes.execute_cycle();
+        winners.push_back(gmes.get_winner());
+        if (activations != nullptr and t % 5 == 0) {
+            VectorN single(Nmax); // read one by one first
+            for (std::size_t n = 0; n < Nmax; n += 3) single[n] = gmes.get_activation(n);
+            activations->push_back(gmes.get_activations());
+            for (std::size_t n = 0; n < Nmax; n += 3) REQUIRE( single[n] == activations->back()[n] );
+        }
+    }
+    return winners;
+}
+
+}} // namespace local_tests::gmes_tests
+
+TEST_CASE( "gmes with prototype search selects same winners", "[gmes][prototype_search]" )
+{
+    using namespace local_tests::gmes_tests;
+    auto reference = run_prototype_gmes(0, 40, 3000);
+    REQUIRE( *std::max_element(reference.begin(), reference.end()) > 5 );
+    REQUIRE( run_prototype_gmes(1, 40, 3000) == reference );
+    REQUIRE( run_prototype_gmes(2, 40, 3000) == reference );
+}
+
+TEST_CASE( "gmes with prototype search has the same activations", "[gmes][prototype_search]" )
+{
+    using namespace local_tests::gmes_tests;
+    std::vector<VectorN> reference;
+    auto winners = run_prototype_gmes(0, 40, 1500, &reference);
+    for (int mode : {1, 2}) {
+        std::vector<VectorN> activations;
+        REQUIRE( run_prototype_gmes(mode, 40, 1500, &activations) == winners );
+        REQUIRE( activations.size() == reference.size() );
+        for (std::size_t t = 0; t < reference.size(); ++t)
+            for (std::size_t n = 0; n < 40; ++n)
+                REQUIRE( close(activations[t][n], reference[t][n], 1e-12) );
+    }
+}
+
+TEST_CASE( "prototype search timing", "[.][benchmark][prototype_search]" )
+{
+    const std::size_t N = 500, dim = 21, queries = 20000;
+    std::vector<VectorN> protos(N);
+    for (auto& p : protos) p = random_vector(dim, -1.0, 1.0);
+
+    learning::Prototype_Search linear(N, dim), indexed(N, dim);
+    for (std::size_t i = 0; i < N; ++i) { linear.set(i, protos[i]); indexed.set(i, protos[i]); }
+    indexed.enable_index();
+
+    std::vector<VectorN> xs(queries);
+    for (auto& x : xs) { x = protos[random_index(N)]; for (auto& v : x) v += random_value(-0.1, 0.1); }
+
+    Stopwatch watch;
+    std::size_t sum_brute = 0;
+    for (auto const& x : xs) {
+        std::size_t best = 0; double best_d2 = INFINITY;
+        for (std::size_t i = 0; i < N; ++i) { double d2 = squared_distance(x, protos[i]); if (d2 < best_d2) { best_d2 = d2; best = i; } }
+        sum_brute += best;
+    }
+    const double t_brute = watch.get_time_passed_us() / 1000.0;
+
+    std::size_t sum_lin = 0, sum_idx = 0, checks = 0;
+    double d2;
+    for (auto const& x : xs) { linear.set_input(x); sum_lin += linear.nearest(d2); }
+    const double t_lin = watch.get_time_passed_us() / 1000.0;
+    for (auto const& x : xs) { indexed.set_input(x); sum_idx += indexed.nearest(d2); checks += indexed.get_number_of_checks(); }
+    const double t_idx = watch.get_time_passed_us() / 1000.0;
+
+    sts_msg("%u queries, %u prototypes of dim %u", queries, N, dim);
+    sts_msg("separate vectors: %7.1f ms", t_brute);
+    sts_msg("contiguous+pds:   %7.1f ms", t_lin);
+    sts_msg("vp-tree:          %7.1f ms (%.1f distance checks per query)", t_idx, 1.0*checks/queries);
+    REQUIRE( sum_lin == sum_brute );
+    REQUIRE( sum_idx == sum_brute );
+}
+
+#include <learning/transition_graph.h>
+TEST_CASE( "sparse transition graph matches dense transitions", "[gmes][transitions]" )
+{
+    srand(777);
+    const std::size_t N = 17;
+    const double lr = 35.0;
+    std::vector<VectorN> dense(N, VectorN(N, .0)); // former expert[i].transition[k]
+    learning::Transition_Graph sparse(N);
+
+    std::size_t winner = 0, last_winner = 0;
+    for (std::size_t t = 0; t < 20000; ++t) {
+        last_winner = winner;
+        winner = random_index(N);
+
+        if (random_value() < 0.02) { // insertion
+            for (std::size_t n = 0; n < N; ++n) dense[winner][n] = dense[n][winner] = .0;
+            sparse.clear_from(winner);
+            sparse.clear_to(winner);
+            dense[winner][last_winner] = gmes_constants::initial_transition_validation;
+            sparse.reset(winner, last_winner);
+        }
+
+        const double progress = (random_value() < 0.5) ? .0 : random_value(0.0, 0.05);
+        for (std::size_t n = 0; n < N; ++n) {
+            dense[n][winner] *= exp(-lr * progress);
+            dense[winner][n] *= exp(-lr * progress);
+        }
+        sparse.decay_node(winner, lr * progress);
+        if (t % 1000 == 999) sparse.fold();
+
+        dense[winner][last_winner] = gmes_constants::initial_transition_validation;
+        sparse.reset(winner, last_winner);
+
+        if (t % 97 == 0)
+            for (std::size_t i = 0; i < N; ++i)
+                for (std::size_t k = 0; k < N; ++k) {
+                    REQUIRE( close(sparse.value(i, k), dense[i][k], 1e-12) );
+                    REQUIRE( sparse.exists(i, k) == (dense[i][k] > gmes_constants::transition_exist_treshold) );
+                }
+    }
+    REQUIRE( sparse.get_number_of_edges() < N*N );
+
+    /* folding the pending decay does not change the values */
+    std::vector<VectorN> before(N, VectorN(N));
+    for (std::size_t i = 0; i < N; ++i)
+        for (std::size_t k = 0; k < N; ++k)
+            before[i][k] = sparse.value(i, k);
+    sparse.fold();
+    for (std::size_t i = 0; i < N; ++i)
+        for (std::size_t k = 0; k < N; ++k)
+            REQUIRE( close(sparse.value(i, k), before[i][k], 1e-12) );
+}
+
+TEST_CASE( "lazy activations equal eagerly computed ones", "[gmes]" )
+{
+    using namespace local_tests::gmes_tests;
+    srand(2323);
+    const std::size_t Nmax = 20;
+    Synthetic_Stream stream(8, 100);
+    static_vector<Empty_Payload> payloads(Nmax);
+    Expert_Vector experts(Nmax, payloads, stream, 0.1, 0.05, /*experience*/10);
+    GMES gmes(experts, 35.0, true);
+
+    for (std::size_t t = 0; t < 1000; ++t) {
+        stream.execute_cycle();
+        gmes.execute_cycle();
+
+        if (t % 10 == 0) { // some cycles only read the winner
+            const double a = gmes.get_activation(gmes.get_winner());
+            const double e = experts[gmes.get_winner()].get_prediction_error();
+            REQUIRE( a == exp(-e*e/gmes_constants::perceptive_width) ); // exact math by default
+        }
+        if (t % 3 == 0) {
+            VectorN const& activations = gmes.get_activations();
+            for (std::size_t n = 0; n < Nmax; ++n) {
+                const double e = experts[n].get_prediction_error();
+                const double expected = experts[n].does_exists() ? exp(-e*e/gmes_constants::perceptive_width) : .0;
+                REQUIRE( activations[n] == expected );
+                REQUIRE( gmes.get_activation(n) == activations[n] );
+            }
+        }
+    }
+}
+
+TEST_CASE( "random scope draws from its stream and leaves rand() untouched", "[gmes]" )
+{
+    srand(77);
+    const double a0 = random_value(), a1 = random_index(100);
+    srand(77);
+    double s0, s1;
+    {
+        common::Random_Stream stream(3);
+        Random_Scope scope(stream);
+        s0 = random_value(-1.0, 1.0);
+        s1 = rand_norm_zero_mean(1.0);
+    }
+    common::Random_Stream reference(3);
+    REQUIRE( s0 == 2.0 * reference.uniform() - 1.0 );
+    REQUIRE( s1 == reference.normal(1.0) );
+
+    REQUIRE( random_value() == a0 );
+    REQUIRE( random_index(100) == a1 );
+}
+
+TEST_CASE( "experts are constructed on first use", "[gmes]" )
+{
+    using namespace local_tests::gmes_tests;
+    const std::size_t Nmax = 40;
+    std::vector<std::size_t> winners[2];
+    for (bool lazy : {true, false}) {
+        srand(4242);
+        Synthetic_Stream stream(8, 100);
+        static_vector<Empty_Payload> payloads(Nmax);
+        Expert_Vector experts(Nmax, payloads, stream, 0.1, 0.05, /*experience*/10);
+        REQUIRE( experts.get_number_of_constructed() == 1 );
+        if (not lazy) experts.preallocate(Nmax);
+
+        GMES gmes(experts, 35.0, true);
+        for (std::size_t t = 0; t < 1000; ++t) {
+            stream.execute_cycle();
+            gmes.execute_cycle();
+            winners[lazy].push_back(gmes.get_winner());
+        }
+        if (lazy) {
+            REQUIRE( experts.get_number_of_existing() < Nmax );
+            REQUIRE( experts.get_number_of_constructed() == experts.get_number_of_existing() );
+        } else
+            REQUIRE( experts.get_number_of_constructed() == Nmax );
+    }
+    REQUIRE( winners[0] == winners[1] );
+
+    /* time-delay networks draw random weights when constructed */
+    for (bool shared_delay_line : {true, false}) {
+        Record lazy = run_tdn_gmes(nullptr, 1, 13, 3000, shared_delay_line);
+        Record full = run_tdn_gmes(nullptr, 1, 13, 3000, shared_delay_line, /*preallocate=*/true);
+        REQUIRE( lazy.num_experts > 1 );
+        REQUIRE( lazy.winners == full.winners );
+        REQUIRE( lazy.errors  == full.errors );
+    }
+}
@@ -7,6 +7,9 @@
 #include <robots/joint.h>
 #include <control/controlparameter.h>
 #include <control/jointcontrol.h>
+#include <control/controlmixer.h>
+#include <robots/synthetic.h>
+#include <common/stopwatch.h>
 #include <tests/test_robot.h>
 
 
@@ -83,7 +86,7 @@ TEST_CASE( "Making Asymmetric keeps structure" , "[jointcontrol]") {
 
     const std::size_t num_sym_params = num_inputs*(num_joints-num_sym_joints);
 
-    control::Fully_Connected_Symmetric_Core core(robot);
+    control::Fully_Connected_Symmetric_Core<> core(robot);
     robot.set_random_inputs();
     core.prepare_inputs(robot);
 
@@ -145,3 +148,288 @@ TEST_CASE( "Making Asymmetric keeps structure" , "[jointcontrol]") {
     printf("\n____\nDONE\n");
 }
 
+
+namespace local_tests {
+namespace jointcontroller_tests {
+
+/* outputs as computed per joint and input, choosing x or y for each input */
+template <typename Core_t, typename T = typename Core_t::scalar_t>
+std::vector<T> const& reference_outputs(Core_t const& core, robots::Robot_Interface const& robot, bool is_symmetric, bool is_switched, std::vector<T>& result)
+{
+    result.assign(core.weights.size(), T(0));
+    for (std::size_t i = 0; i < result.size(); ++i) {
+        T a = T(0);
+        bool swap_inputs = is_switched != (is_symmetric and robot.get_joints()[i].type == robots::Joint_Type_Symmetric);
+        for (std::size_t k = 0; k < core.input.size(); ++k)
+            a += core.weights[i][k] * (swap_inputs ? core.input[k].y : core.input[k].x);
+        result[i] = a;
+    }
+    return result;
+}
+
+template <typename Core_t>
+void check_core_outputs(std::size_t num_joints, std::size_t num_sym_joints)
+{
+    Test_Robot robot(num_joints, num_sym_joints);
+    Core_t core(robot);
+    const std::size_t num_params = num_joints * control::get_number_of_inputs(robot);
+    core.apply_weights(robot, random_vector(num_params, -1.0, 1.0));
+    std::vector<typename Core_t::scalar_t> ref;
+
+    const std::vector<std::pair<bool,bool>> modes = {{false,false}, {true,false}, {false,true}};
+    for (std::size_t t = 0; t < 20; ++t) {
+        robot.set_random_inputs();
+        core.prepare_inputs(robot);
+        for (auto const& m : modes) {
+            core.update_outputs(robot, m.first, m.second);
+            REQUIRE( core.activation == reference_outputs(core, robot, m.first, m.second, ref) );
+        }
+        /* direct changes of the weights, e.g. by learning */
+        core.weights[t % num_joints][t % core.input.size()] += 0.25;
+        core.update_layout();
+    }
+
+    const std::size_t num_sym_params = control::get_number_of_inputs(robot) * (num_joints - num_sym_joints);
+    core.apply_symmetric_weights(robot, random_vector(num_sym_params, -1.0, 1.0));
+    core.update_outputs(robot, true, false);
+    REQUIRE( core.activation == reference_outputs(core, robot, true, false, ref) );
+}
+
+}} // namespace local_tests::jointcontroller_tests
+
+TEST_CASE( "symmetric core outputs are unchanged by the weight layout", "[jointcontrol]" )
+{
+    using namespace local_tests::jointcontroller_tests;
+    srand(2345);
+    for (auto const& s : std::vector<std::pair<unsigned, unsigned>>{{1,0}, {4,2}, {7,3}, {8,1}, {12,6}}) {
+        check_core_outputs<control::Fully_Connected_Symmetric_Core<>     >(s.first, s.second);
+        check_core_outputs<control::Fully_Connected_Symmetric_Core<float>>(s.first, s.second);
+    }
+}
+
+TEST_CASE( "symmetric core timing", "[.][benchmark][jointcontrol]" )
+{
+    using namespace local_tests::jointcontroller_tests;
+    const std::size_t T = 100000;
+    for (unsigned N : {4u, 8u, 16u, 32u}) {
+        Test_Robot robot(N, N/2);
+        control::Fully_Connected_Symmetric_Core<> core(robot);
+        core.apply_weights(robot, random_vector(N * control::get_number_of_inputs(robot), -1.0, 1.0));
+        robot.set_random_inputs();
+        core.prepare_inputs(robot);
+
+        std::vector<double> ref;
+        double check = .0;
+        Stopwatch watch;
+        for (std::size_t t = 0; t < T; ++t) {
+            core.update_outputs(robot, t % 2 == 0, false);
+            check += core.activation[0];
+        }
+        const double t_core = watch.get_time_passed_us();
+        for (std::size_t t = 0; t < T; ++t)
+            check -= reference_outputs(core, robot, t % 2 == 0, false, ref)[0];
+        const double t_ref = watch.get_time_passed_us();
+
+        sts_msg("%2u joints: %6.3f us per update (per joint loops %6.3f us), %e", N, t_core / T, t_ref / T, check);
+    }
+}
+
+namespace local_tests {
+namespace jointcontroller_tests {
+
+robots::Synthetic_Parameters mixer_robot(unsigned num_joints = 6) {
+    robots::Synthetic_Parameters params;
+    params.number_of_joints = num_joints;
+    params.number_of_symmetric_joints = num_joints / 3;
+    params.number_of_accels = 2;
+    params.noise = 0.5;
+    return params;
+}
+
+/* small random weights, outputs do not saturate */
+control::Control_Parameter random_controller(robots::Robot_Interface const& robot, double range) {
+    const std::size_t num_params = robot.get_number_of_joints() * control::get_number_of_inputs(robot);
+    return control::Control_Parameter(random_vector(num_params, -range, range), /*symmetric*/false);
+}
+
+void require_same_motors(robots::Robot_Interface const& a, robots::Robot_Interface const& b, double tol) {
+    for (std::size_t i = 0; i < a.get_number_of_joints(); ++i)
+        REQUIRE( close(a.get_joints()[i].motor.get(), b.get_joints()[i].motor.get(), tol) );
+}
+
+/* same state off the rest position */
+void move_both(robots::Synthetic_Robot& a, robots::Synthetic_Robot& b) {
+    a.reset();
+    b.reset();
+    for (std::size_t t = 0; t < 50; ++t) {
+        for (std::size_t i = 0; i < a.get_number_of_joints(); ++i) {
+            a.set_joints()[i].motor = 0.5 * std::sin(0.1 * t + i);
+            b.set_joints()[i].motor = 0.5 * std::sin(0.1 * t + i);
+        }
+        a.execute_cycle();
+        b.execute_cycle();
+    }
+}
+
+}} // namespace local_tests::jointcontroller_tests
+
+TEST_CASE( "control mixer runs only the active controller", "[jointcontrol]" )
+{
+    using namespace local_tests::jointcontroller_tests;
+    srand(1234);
+    robots::Synthetic_Robot robot_a(mixer_robot()), robot_b(mixer_robot());
+    control::Controlmixer mixer(robot_a, 5);
+    control::Jointcontrol single(robot_b);
+
+    std::vector<control::Control_Parameter> params;
+    for (std::size_t i = 0; i < mixer.size(); ++i) {
+        params.push_back(random_controller(robot_a, 0.5));
+        mixer.set_control_parameter(i, params.back());
+    }
+    robot_a.reset();
+    robot_b.reset();
+
+    for (std::size_t t = 0; t < 300; ++t) {
+        if (t % 50 == 0) {
+            mixer.set_active(t / 50 % mixer.size());
+            single.set_control_parameter(params[t / 50 % mixer.size()]);
+        }
+        mixer.execute_cycle();
+        single.execute_cycle();
+        for (std::size_t i = 0; i < robot_a.get_number_of_joints(); ++i)
+            REQUIRE( robot_a.get_joints()[i].motor.get() == robot_b.get_joints()[i].motor.get() );
+        robot_a.execute_cycle();
+        robot_b.execute_cycle();
+    }
+}
+
+TEST_CASE( "control mixer blends faded controllers in weight space", "[jointcontrol]" )
+{
+    using namespace local_tests::jointcontroller_tests;
+    srand(4321);
+    robots::Synthetic_Robot robot_a(mixer_robot()), robot_b(mixer_robot());
+    control::Controlmixer mixer(robot_a, 3), reference(robot_b, 3, /*exact*/true);
+    REQUIRE( reference.is_exact() );
+
+    for (std::size_t i = 0; i < mixer.size(); ++i) {
+        auto const& p = random_controller(robot_a, 0.02);
+        mixer.set_control_parameter(i, p);
+        reference.set_control_parameter(i, p);
+    }
+    robot_a.reset();
+    robot_b.reset();
+
+    /* no output saturates, blending gives the same */
+    for (std::size_t t = 0; t < 300; ++t) {
+        const float val = (t % 100) / 50.f - 0.5f; // includes the ends of the fade
+        mixer    .fade(t / 100, (t / 100 + 1) % 3, val);
+        reference.fade(t / 100, (t / 100 + 1) % 3, val);
+        mixer.execute_cycle();
+        reference.execute_cycle();
+        require_same_motors(robot_a, robot_b, 1e-6);
+        robot_a.execute_cycle();
+        robot_b.execute_cycle();
+    }
+
+    /* saturated outputs: blending is inexact, exact mode runs each controller */
+    auto const& strong = random_controller(robot_a, 5.0);
+    mixer.set_control_parameter(0, strong);
+    reference.set_control_parameter(0, strong);
+    mixer    .fade(0, 1, 0.5f);
+    reference.fade(0, 1, 0.5f);
+
+    move_both(robot_a, robot_b);
+    mixer.execute_cycle();
+    reference.execute_cycle();
+    double max_diff = .0;
+    for (std::size_t i = 0; i < robot_a.get_number_of_joints(); ++i)
+        max_diff = std::max(max_diff, std::abs(robot_a.get_joints()[i].motor.get() - robot_b.get_joints()[i].motor.get()));
+    REQUIRE( max_diff > 0.01 );
+
+    mixer.set_exact(true);
+    move_both(robot_a, robot_b);
+    mixer.execute_cycle();
+    reference.execute_cycle();
+    for (std::size_t i = 0; i < robot_a.get_number_of_joints(); ++i)
+        REQUIRE( robot_a.get_joints()[i].motor.get() == robot_b.get_joints()[i].motor.get() );
+}
+
+TEST_CASE( "control mixer blends anew when weights change through a held reference", "[jointcontrol]" )
+{
+    using namespace local_tests::jointcontroller_tests;
+    srand(2468);
+    robots::Synthetic_Robot robot_a(mixer_robot()), robot_b(mixer_robot());
+    control::Controlmixer mixer(robot_a, 2), reference(robot_b, 2, /*exact*/true);
+    for (std::size_t i = 0; i < mixer.size(); ++i) {
+        auto const& p = random_controller(robot_a, 0.02);
+        mixer.set_control_parameter(i, p);
+        reference.set_control_parameter(i, p);
+    }
+    control::Jointcontrol& held = mixer[1]; // taken before blending
+    robot_a.reset();
+    robot_b.reset();
+
+    mixer    .fade(0, 1, 0.3f);
+    reference.fade(0, 1, 0.3f);
+    for (std::size_t t = 0; t < 40; ++t) {
+        if (t == 20) { // same gains, other weights
+            auto const& p = random_controller(robot_a, 0.02);
+            held.set_control_parameter(p);
+            reference[1].set_control_parameter(p);
+        }
+        mixer.execute_cycle();
+        reference.execute_cycle();
+        require_same_motors(robot_a, robot_b, 1e-6);
+        robot_a.execute_cycle();
+        robot_b.execute_cycle();
+    }
+}
+
+TEST_CASE( "control mixer timing", "[.][benchmark][jointcontrol]" )
+{
+    using namespace local_tests::jointcontroller_tests;
+    const std::size_t T = 20000, M = 32;
+    robots::Synthetic_Robot robot(mixer_robot(16));
+    control::Controlmixer mixer(robot, M);
+    for (std::size_t i = 0; i < M; ++i)
+        mixer.set_control_parameter(i, random_controller(robot, 0.05));
+
+    Stopwatch watch;
+    mixer.set_active(3);
+    for (std::size_t t = 0; t < T; ++t) {
+        for (std::size_t i = 0; i < M; ++i) mixer[i].execute_cycle(); // all controllers, as before
+        robot.execute_cycle();
+    }
+    const double t_all = watch.get_time_passed_us();
+
+    for (std::size_t t = 0; t < T; ++t) {
+        mixer.execute_cycle();
+        robot.execute_cycle();
+    }
+    const double t_one = watch.get_time_passed_us();
+
+    for (std::size_t t = 0; t < T; ++t) {
+        mixer.fade(3, 4, float(t) / T);
+        mixer.execute_cycle();
+        robot.execute_cycle();
+    }
+    const double t_fade = watch.get_time_passed_us();
+
+    for (std::size_t t = 0; t < T; ++t) {
+        mixer.fade(3, 4, float(t / 10) * 10 / T); // gain steps every 10 cycles
+        mixer.execute_cycle();
+        robot.execute_cycle();
+    }
+    const double t_steps = watch.get_time_passed_us();
+
+    mixer.set_exact(true);
+    for (std::size_t t = 0; t < T; ++t) {
+        mixer.fade(3, 4, float(t) / T);
+        mixer.execute_cycle();
+        robot.execute_cycle();
+    }
+    const double t_exact = watch.get_time_passed_us();
+
+    sts_msg("%u controllers, 16 joints, us per cycle: all %.2f, one-hot %.2f, fading %.2f, fading in steps %.2f, fading exact %.2f"
+           , M, t_all / T, t_one / T, t_fade / T, t_steps / T, t_exact / T);
+}
@@ -2,9 +2,11 @@
 #include <vector>
 
 #include <common/modules.h>
+#include <common/stopwatch.h>
 #include <common/static_vector.h>
 #include <learning/payload.h>
 #include <learning/epsilon_greedy.h>
+#include <learning/boltzmann_softmax.h>
 
 
 class no_actions : public Action_Module_Interface {
@@ -77,6 +79,50 @@ TEST_CASE( "Epsilon Greedy" , "[learning]") {
 
 
 
+TEST_CASE( "state payloads are views of one Q tensor" , "[learning]") {
+    const unsigned num_states = 5;
+    const unsigned num_policies = 3;
+    const no_actions actions;
+    auto tensor = std::make_shared<learning::Q_Tensor>(actions, num_policies, 0.5, num_states);
+    static_vector<State_Payload> states(num_states, tensor);
+    REQUIRE( tensor->get_number_of_states() == num_states );
+
+    /* one contiguous block [state][policy][action] */
+    const std::size_t A = actions.get_number_of_actions();
+    for (unsigned s = 0; s < num_states; ++s)
+        for (unsigned p = 0; p < num_policies; ++p) {
+            REQUIRE( states[s].policies[p].qvalues.data() == tensor->q(0,0) + (s * num_policies + p) * A );
+            for (unsigned a = 0; a < A; ++a)
+                REQUIRE( close(states[s].policies[p].qvalues[a], 0.5, 0.03 + 1e-12) );
+        }
+
+    /* writes go through the views, the non-existing action is ignored */
+    states[2].policies[1].qvalues[3] = 2.0;
+    states[2].policies[1].qvalues[5] = 1.0;
+    REQUIRE( tensor->q(2,1)[3] == 2.0 );
+    REQUIRE( states[2].policies[1].get_argmax_q() == 5 );
+    states[2].policies[1].qvalues[3] = -1.0;
+    states[2].policies[1].qvalues[6] = -0.5;
+    REQUIRE( states[2].policies[1].get_argmin_q() == 6 );
+
+    /* tensor update over all policies */
+    const double alpha[] = {0.1, 0.2, 0.3};
+    std::vector<double> x(A, 1.0);
+    const double q42 = states[4].policies[2].qvalues[6];
+    states[4].update(alpha, x.data());
+    REQUIRE( states[4].policies[2].qvalues[6] == Approx(q42 + 0.3) );
+
+    /* copying a state copies values and traces, not the views */
+    states[0].eligibility_trace[4].reset();
+    states[1] = states[0];
+    REQUIRE( states[1].eligibility_trace[4].get() == 1.0 );
+    REQUIRE( states[1].get_traces() != states[0].get_traces() );
+    for (unsigned p = 0; p < num_policies; ++p)
+        for (unsigned a = 0; a < A; ++a)
+            if (actions.exists(a))
+                REQUIRE( close(states[1].policies[p].qvalues[a], states[0].policies[p].qvalues[a], 0.05 * std::abs(states[0].policies[p].qvalues[a]) + 1e-12) );
+}
+
 TEST_CASE( "select_from_distribution" ,"[eps_greedy]")
 {
     Action_Selection_Base::Vector_t selection_probabilities{5};
@@ -96,3 +142,145 @@ TEST_CASE( "select_from_distribution" ,"[eps_greedy]")
         REQUIRE( close(bins[i]/1000.0, selection_probabilities[i], 0.05) );
     }
 }
+
+namespace local_tests {
+namespace learning_tests {
+
+class all_actions : public Action_Module_Interface {
+    const std::size_t number_of_actions;
+public:
+    explicit all_actions(std::size_t n) : number_of_actions(n) {}
+    std::size_t get_number_of_actions          (void) const override { return number_of_actions; }
+    std::size_t get_number_of_actions_available(void) const override { return number_of_actions; }
+    bool exists(const std::size_t /*action_index*/)   const override { return true; }
+};
+
+/* the softmax and selection as they were: two passes and a linear scan */
+std::size_t plain_boltzmann(Policy const& policy, std::vector<double>& p) {
+    const double maxq = policy.qvalues.get_max();
+    double sum = .0;
+    for (std::size_t i = 0; i < p.size(); ++i) {
+        p[i] = std::exp(policy.qvalues[i] - maxq);
+        sum += p[i];
+    }
+    for (std::size_t i = 0; i < p.size(); ++i)
+        p[i] /= sum;
+    return select_from_distribution(p);
+}
+
+}} // namespace local_tests::learning_tests
+
+TEST_CASE( "select_from_cumulative equals select_from_distribution" ,"[boltzmann]")
+{
+    srand(1234);
+    for (std::size_t n : {1ul, 2ul, 5ul, 33ul}) {
+        std::vector<double> p = random_vector(n, 0.0, 1.0), c(n);
+        p[n/2] = 0.0; // impossible action
+        double sum = .0;
+        for (auto const& x : p) sum += x;
+        if (sum == 0.0) { p[0] = sum = 1.0; }
+        double acc = .0;
+        for (std::size_t i = 0; i < n; ++i) {
+            p[i] /= sum;
+            acc += p[i];
+            c[i] = acc;
+        }
+        for (unsigned t = 0; t < 1000; ++t) {
+            srand(t); const std::size_t i = select_from_distribution(p);
+            srand(t); const std::size_t j = select_from_cumulative(c);
+            REQUIRE( i == j );
+            REQUIRE( p[j] > 0.0 );
+        }
+    }
+}
+
+TEST_CASE( "boltzmann softmax selects like the plain softmax" ,"[boltzmann]")
+{
+    using namespace local_tests::learning_tests;
+    srand(2345);
+    const std::size_t S = 4, P = 2, A = 13;
+    all_actions actions(A);
+    static_vector<State_Payload> states(S, std::make_shared<learning::Q_Tensor>(actions, P, 0.0, S));
+    for (std::size_t s = 0; s < S; ++s)
+        for (std::size_t p = 0; p < P; ++p)
+            for (std::size_t a = 0; a < A; ++a)
+                states[s].policies[p].qvalues[a] = random_value(-2.0, 2.0);
+
+    for (auto mode : {fast_math::Mode::exact, fast_math::Mode::fast}) {
+        Boltzmann_Softmax boltzmann(states, actions, 0.1);
+        boltzmann.set_math_mode(mode);
+        std::vector<double> expected(A);
+        for (unsigned t = 0; t < 200; ++t) {
+            const std::size_t s = t % S, p = (t / S) % P;
+            if (t == 100) states[1].policies[0].qvalues[7] += 3.0; // invalidates
+            srand(t); const std::size_t a0 = plain_boltzmann(states[s].policies[p], expected);
+            srand(t); const std::size_t a1 = boltzmann.select_action(s, p);
+            for (std::size_t a = 0; a < A; ++a)
+                REQUIRE( close(boltzmann.get_distribution()[a], expected[a], 1e-14) );
+            if (a0 != a1) // only at the rounded edges of the bins
+                REQUIRE( std::min(a0, a1) + 1 == std::max(a0, a1) );
+        }
+    }
+}
+
+TEST_CASE( "action selection with concurrent reads selects like plain reads" ,"[boltzmann]")
+{
+    using namespace local_tests::learning_tests;
+    srand(3456);
+    const std::size_t S = 4, P = 2, A = 7;
+    all_actions actions(A);
+    static_vector<State_Payload> states(S, std::make_shared<learning::Q_Tensor>(actions, P, 0.0, S));
+    for (std::size_t s = 0; s < S; ++s)
+        for (std::size_t p = 0; p < P; ++p)
+            for (std::size_t a = 0; a < A; ++a)
+                states[s].policies[p].qvalues[a] = random_value(-2.0, 2.0);
+
+    Boltzmann_Softmax boltzmann(states, actions, 0.1), boltzmann_concurrent(states, actions, 0.1);
+    learning::Epsilon_Greedy greedy(states, actions, 0.1), greedy_concurrent(states, actions, 0.1);
+    boltzmann_concurrent.enable_concurrent_reads();
+    greedy_concurrent.enable_concurrent_reads();
+
+    for (unsigned t = 0; t < 200; ++t) {
+        const std::size_t s = t % S, p = (t / S) % P;
+        if (t % 50 == 0) states[s].policies[p].qvalues[t % A] += 1.0; // changed
+        srand(t); const std::size_t a0 = boltzmann.select_action(s, p);
+        srand(t); const std::size_t a1 = boltzmann_concurrent.select_action(s, p);
+        REQUIRE( a0 == a1 );
+        srand(t); const std::size_t g0 = greedy.select_action(s, p);
+        srand(t); const std::size_t g1 = greedy_concurrent.select_action(s, p);
+        REQUIRE( g0 == g1 );
+    }
+}
+
+TEST_CASE( "boltzmann softmax timing" ,"[.][benchmark][boltzmann]")
+{
+    using namespace local_tests::learning_tests;
+    const std::size_t S = 50, P = 3, T = 20000;
+    for (std::size_t A : {8ul, 64ul, 512ul}) {
+        srand(1234);
+        all_actions actions(A);
+        static_vector<State_Payload> states(S, std::make_shared<learning::Q_Tensor>(actions, P, 0.0, S));
+        Boltzmann_Softmax boltzmann(states, actions, 0.1);
+        boltzmann.set_math_mode(fast_math::Mode::fast);
+        std::vector<double> p(A);
+        std::size_t check = 0;
+
+        Stopwatch watch;
+        for (std::size_t t = 0; t < T; ++t)
+            check += plain_boltzmann(states[t % S].policies[t % P], p);
+        const double t_plain = watch.get_time_passed_us() / double(T);
+
+        for (std::size_t t = 0; t < T; ++t) {
+            states[t % S].policies[t % P].qvalues[t % A] += 1e-3; // Q-values changed
+            check += boltzmann.select_action(t % S, t % P);
+        }
+        const double t_changed = watch.get_time_passed_us() / double(T);
+
+        for (std::size_t t = 0; t < T; ++t)
+            check += boltzmann.select_action(t % S, t % P);
+        const double t_cached = watch.get_time_passed_us() / double(T);
+
+        sts_msg("%3u actions: %6.2f us (plain) %6.2f us (changed) %6.2f us (cached) per selection (%u)"
+               , A, t_plain, t_changed, t_cached, check % 2);
+    }
+}
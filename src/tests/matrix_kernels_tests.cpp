@@ -0,0 +1,135 @@
+#include <tests/catch.hpp>
+
+#include <cfloat>
+#include <common/modules.h>
+#include <common/stopwatch.h>
+#include <common/log_messages.h>
+#include <common/matrix_kernels.h>
+
+namespace local_tests {
+namespace matrix_kernels_tests {
+
+typedef common::Matrix<double> matrix_t;
+
+matrix_t random_matrix(std::size_t rows, std::size_t cols) {
+    matrix_t A(rows, cols);
+    for (std::size_t i = 0; i < rows; ++i)
+        for (std::size_t j = 0; j < cols; ++j)
+            A(i,j) = random_value(-1.0, 1.0);
+    return A;
+}
+
+/* plain loops, as the networks used them before */
+void scalar_gemv(matrix_t const& A, const double* x, double* y) {
+    for (std::size_t i = 0; i < A.rows(); ++i) {
+        double act = .0;
+        for (std::size_t j = 0; j < A.cols(); ++j)
+            act += A(i,j) * x[j];
+        y[i] = tanh(act);
+    }
+}
+
+void scalar_gemv_t(matrix_t const& A, const double* x, double* y) {
+    for (std::size_t j = 0; j < A.cols(); ++j) {
+        double act = .0;
+        for (std::size_t i = 0; i < A.rows(); ++i)
+            act += A(i,j) * x[i];
+        y[j] = act;
+    }
+}
+
+void scalar_rank1(matrix_t& A, double alpha, const double* u, const double* v) {
+    for (std::size_t i = 0; i < A.rows(); ++i)
+        for (std::size_t j = 0; j < A.cols(); ++j)
+            A(i,j) += alpha * u[i] * v[j];
+}
+
+}} // namespace local_tests::matrix_kernels_tests
+
+TEST_CASE( "dense kernels match scalar loops", "[matrix][kernels]" )
+{
+    using namespace local_tests::matrix_kernels_tests;
+    srand(1234);
+    sts_msg("Kernel instruction set: %s", common::kernel::instruction_set());
+
+    for (std::size_t rows : {1ul, 3ul, 8ul, 17ul})
+        for (std::size_t cols : {1ul, 2ul, 5ul, 9ul, 16ul, 31ul}) {
+            matrix_t A = random_matrix(rows, cols);
+            VectorN x = random_vector(cols, -1.0, 1.0);
+            VectorN u = random_vector(rows, -1.0, 1.0);
+
+            /* gemv only reorders the sums */
+            VectorN y0(rows), y1(rows);
+            scalar_gemv(A, x.data(), y0.data());
+            common::kernel::gemv(A, x.data(), y1.data(), common::kernel::tanh_fn());
+            for (std::size_t i = 0; i < rows; ++i)
+                REQUIRE( close(y0[i], y1[i], 8*cols*DBL_EPSILON) );
+
+            /* transposed product and rank-1 update are bit-identical */
+            VectorN z0(cols), z1(cols);
+            scalar_gemv_t(A, u.data(), z0.data());
+            common::kernel::gemv_t(A, u.data(), z1.data());
+            REQUIRE( z0 == z1 );
+
+            matrix_t B0 = A, B1 = A;
+            scalar_rank1(B0, 0.3, u.data(), x.data());
+            common::kernel::rank1_update(B1, 0.3, u.data(), x.data());
+            for (std::size_t i = 0; i < rows; ++i)
+                for (std::size_t j = 0; j < cols; ++j)
+                    REQUIRE( B0(i,j) == B1(i,j) );
+        }
+}
+
+TEST_CASE( "maximum and argmax kernels", "[matrix][kernels]" )
+{
+    srand(2345);
+    for (std::size_t n : {1ul, 2ul, 3ul, 4ul, 7ul, 8ul, 13ul, 64ul}) {
+        VectorN x = random_vector(n, -1.0, 1.0);
+        const std::size_t i = std::distance(x.begin(), std::max_element(x.begin(), x.end()));
+        REQUIRE( common::kernel::maximum(x.data(), n) == x[i] );
+        REQUIRE( common::kernel::argmax (x.data(), n) == i );
+
+        /* ties resolve to the first */
+        x.assign(n, 0.5);
+        REQUIRE( common::kernel::argmax(x.data(), n) == 0 );
+        x[n-1] = 1.0;
+        if (n > 2) x[n/2] = 1.0;
+        REQUIRE( common::kernel::argmax(x.data(), n) == (n > 2 ? n/2 : n-1) );
+    }
+}
+
+TEST_CASE( "dense kernels timing", "[.][benchmark][kernels]" )
+{
+    using namespace local_tests::matrix_kernels_tests;
+    srand(1234);
+    sts_msg("Kernel instruction set: %s", common::kernel::instruction_set());
+
+    for (std::size_t n : {16ul, 64ul, 256ul, 1024ul}) {
+        const std::size_t repetitions = std::max<std::size_t>(1, (1ul << 26) / (n*n));
+        const matrix_t A0 = random_matrix(n, n);
+        matrix_t A = A0;
+        VectorN x = random_vector(n, -0.1, 0.1), y(n), z(n);
+        double sum0 = .0, sum1 = .0;
+
+        Stopwatch watch;
+        for (std::size_t r = 0; r < repetitions; ++r) {
+            scalar_gemv(A, x.data(), y.data());
+            scalar_gemv_t(A, y.data(), z.data());
+            scalar_rank1(A, 1e-9, y.data(), x.data());
+            sum0 += z[r % n];
+        }
+        const double t_scalar = watch.get_time_passed_us() / 1000.0;
+
+        A = A0;
+        for (std::size_t r = 0; r < repetitions; ++r) {
+            common::kernel::gemv(A, x.data(), y.data(), common::kernel::tanh_fn());
+            common::kernel::gemv_t(A, y.data(), z.data());
+            common::kernel::rank1_update(A, 1e-9, y.data(), x.data());
+            sum1 += z[r % n];
+        }
+        const double t_kernel = watch.get_time_passed_us() / 1000.0;
+
+        sts_msg("%4ux%-4u x%6u: scalar %7.1f ms  kernel %7.1f ms  speedup %4.2f (%g %g)"
+               , n, n, repetitions, t_scalar, t_kernel, t_scalar/t_kernel, sum0, sum1);
+    }
+}
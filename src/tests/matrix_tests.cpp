@@ -0,0 +1,51 @@
+#include <tests/catch.hpp>
+
+#include <common/matrix.h>
+
+namespace local_tests {
+namespace matrix_tests {
+
+bool is_aligned(const void* ptr) { return reinterpret_cast<std::size_t>(ptr) % common::Matrix<>::alignment == 0; }
+
+}} // namespace local_tests::matrix_tests
+
+TEST_CASE( "aligned matrix layout and views", "[matrix]" )
+{
+    using namespace local_tests::matrix_tests;
+    common::Matrix<double> mat(3, 5);
+
+    REQUIRE( mat.rows() == 3 );
+    REQUIRE( mat.cols() == 5 );
+    REQUIRE( mat.size() == 3 );
+    REQUIRE( mat.stride() == 8 );
+    for (std::size_t i = 0; i < mat.rows(); ++i)
+        REQUIRE( is_aligned(mat.row(i).data()) );
+
+    for (std::size_t i = 0; i < mat.rows(); ++i)
+        for (std::size_t j = 0; j < mat.cols(); ++j)
+            mat(i,j) = 10.0*i + j;
+
+    REQUIRE( mat[2][3] == 23.0 );
+    REQUIRE( mat.row(1).size() == 5 );
+    REQUIRE( mat.row(1)[4] == 14.0 );
+    REQUIRE( mat.col(4).size() == 3 );
+    REQUIRE( mat.col(4)[2] == 24.0 );
+    REQUIRE( mat.data()[mat.stride() + 1] == 11.0 );
+    REQUIRE( mat.data()[mat.cols()] == 0.0 ); // padding
+
+    mat.col(0)[1] = -1.0;
+    REQUIRE( mat(1,0) == -1.0 );
+
+    REQUIRE_THROWS( mat.at(3,0) );
+    REQUIRE_THROWS( mat.at(0,5) );
+
+    /* copies are aligned too */
+    std::vector<common::Matrix<double>> copies(7, mat);
+    for (auto const& c : copies) {
+        REQUIRE( is_aligned(c.data()) );
+        REQUIRE( c(2,4) == 24.0 );
+    }
+    common::Matrix<float> small(2, 3);
+    REQUIRE( small.stride() == 8 );
+    REQUIRE( is_aligned(small.row(1).data()) );
+}
@@ -2,6 +2,11 @@
 
 #include <learning/predictor.h>
 #include <learning/motor_predictor.h>
+#include <learning/expert_vector.h>
+#include <learning/payload.h>
+#include <learning/gmes.h>
+#include <control/jointcontrol.h>
+#include <common/thread_pool.h>
 #include <common/log_messages.h>
 #include <tests/test_robot.h>
 
@@ -13,7 +18,7 @@ public:
     : sensor_vector(joints.size())
     {
         for (robots::Joint_Model const& j : joints)
-            sensors.emplace_back(j.name, [&j, sigma](){ return j.motor.get() + rand_norm_zero_mean(sigma); });
+            add_sensor(j.name, [&j, sigma](){ return j.motor.get() + rand_norm_zero_mean(sigma); });
     }
 };
 
@@ -167,3 +172,69 @@ TEST_CASE( "motor prediction error is reset on (re-)initialization", "[motor_pre
 }
 
 } // namespace local_tests
+
+TEST_CASE( "motor predictors with shared inputs predict like with own inputs", "[motor_predictor]" )
+{
+    using namespace local_tests;
+    srand(4711);
+    Test_Robot robot(6,2);
+    Test_Motor_Space motors(robot.get_joints(), 0.0);
+    control::Control_Parameter params = control::get_initial_parameter(robot,{0.,0.,0.}, false);
+    auto inputs = std::make_shared<learning::Motor_Inputs>(robot);
+
+    learning::Motor_Predictor own   { robot, motors, 0.1, 0.01, 1, params, /*noise=*/.01, /*seed=*/23 };
+    learning::Motor_Predictor shared{ robot, motors, 0.1, 0.01, 1, params, /*noise=*/.01, /*seed=*/23, inputs };
+    learning::Motor_Predictor other { robot, motors, 0.1, 0.01, 1, params, /*noise=*/.01, /*seed=*/24, inputs };
+
+    bool noise_differs = false;
+    for (unsigned i = 0; i < 100; ++i) {
+        robot.set_random_inputs();
+        motors.execute_cycle();
+        inputs->prepare(robot);
+        own.predict();
+        shared.predict();
+        other.predict();
+        REQUIRE( own.get_prediction() == shared.get_prediction() );
+        noise_differs |= (other.get_prediction() != shared.get_prediction());
+        own.adapt();
+        shared.adapt();
+    }
+    REQUIRE( noise_differs );
+}
+
+namespace local_tests {
+
+std::vector<std::size_t> run_motor_gmes(common::Thread_Pool* pool, std::size_t Nmax, std::size_t cycles)
+{
+    srand(1234);
+    reset_random_value_norm(); // independent of the tests before
+    Test_Robot robot(6,2);
+    Test_Motor_Space motors(robot.get_joints(), 0.0);
+    control::Control_Vector params = control::param_factory(robot, Nmax, "", {0.,0.,0.});
+    static_vector<Empty_Payload> payloads(Nmax);
+    Expert_Vector experts(Nmax, payloads, motors, 0.01, /*experience*/1, /*noise*/0.01, params, robot);
+    GMES gmes(experts, 2.0, false, Nmax);
+    if (pool) gmes.enable_parallel_prediction(*pool, 1);
+
+    std::vector<std::size_t> winners;
+    for (std::size_t t = 0; t < cycles; ++t) {
+        robot.set_random_inputs();
+        motors.execute_cycle();
+        gmes.execute_cycle();
+        winners.push_back(gmes.get_winner());
+    }
+    return winners;
+}
+
+} // namespace local_tests
+
+TEST_CASE( "motor experts predict concurrently and reproducibly", "[motor_predictor][gmes]" )
+{
+    using namespace local_tests;
+    const std::size_t Nmax = 8, cycles = 300;
+    auto serial = run_motor_gmes(nullptr, Nmax, cycles);
+    REQUIRE( serial == run_motor_gmes(nullptr, Nmax, cycles) );
+
+    common::Thread_Pool pool(4);
+    REQUIRE( serial == run_motor_gmes(&pool, Nmax, cycles) );
+}
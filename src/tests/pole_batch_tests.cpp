@@ -0,0 +1,109 @@
+#include <tests/catch.hpp>
+
+#include <vector>
+#include <memory>
+#include <common/modules.h>
+#include <common/stopwatch.h>
+#include <common/log_messages.h>
+#include <robots/pole.h>
+#include <robots/pole_batch.h>
+
+namespace local_tests {
+namespace pole_batch_tests {
+
+/* piecewise constant random torques */
+double action(std::size_t i, std::size_t t) { return std::sin(0.37 * i + 0.05 * (t / 7)) * ((t / 50 + i) % 3 == 0 ? 0.3 : 1.0); }
+
+}} // namespace local_tests::pole_batch_tests
+
+TEST_CASE( "batched poles follow the single pole", "[pole]" )
+{
+    using namespace local_tests::pole_batch_tests;
+    const std::size_t N = 261, T = 300; // more than a block, odd
+
+    std::vector<std::unique_ptr<robots::pole>> poles;
+    for (std::size_t i = 0; i < N; ++i)
+        poles.emplace_back(new robots::pole());
+    robots::pole_batch exact(N), fast(N, false, fast_math::Mode::fast);
+
+    double max_diff = .0;
+    for (std::size_t t = 0; t < T; ++t) {
+        for (std::size_t i = 0; i < N; ++i) {
+            poles[i]->set_joints()[0].motor = action(i, t);
+            exact.set_actions()[i] = action(i, t);
+            fast .set_actions()[i] = action(i, t);
+            poles[i]->execute_cycle();
+        }
+        exact.execute_cycle();
+        fast .execute_cycle();
+        for (std::size_t i = 0; i < N; ++i) {
+            auto const& joint = poles[i]->get_joints()[0];
+            REQUIRE( exact.get_angles()[i]     == joint.s_ang );
+            REQUIRE( exact.get_velocities()[i] == joint.s_vel );
+            REQUIRE( exact.height(i)           == poles[i]->height() );
+            max_diff = std::max(max_diff, std::abs(fast.get_angles()[i] - joint.s_ang));
+        }
+    }
+    dbg_msg("max. angle difference in fast mode: %e", max_diff);
+    REQUIRE( max_diff < 1e-9 );
+}
+
+TEST_CASE( "pole instances are robots", "[pole]" )
+{
+    using namespace local_tests::pole_batch_tests;
+    robots::pole_batch batch(5);
+    robots::pole single;
+    robots::Robot_Interface& robot = batch.get_instance(3);
+    REQUIRE( &robot == &batch.get_instance(3) );
+    REQUIRE( robot.get_number_of_joints() == 1 );
+
+    for (std::size_t t = 0; t < 200; ++t) {
+        robot .set_joints()[0].motor = action(3, t);
+        single.set_joints()[0].motor = action(3, t);
+        robot .execute_cycle();
+        single.execute_cycle();
+        REQUIRE( robot.get_joints()[0].s_ang == single.get_joints()[0].s_ang );
+        REQUIRE( robot.get_joints()[0].s_vel == single.get_joints()[0].s_vel );
+        REQUIRE( robot.get_joints()[0].motor.get() == 0.0 );
+        REQUIRE( robot.get_normalized_mechanical_power() == single.get_normalized_mechanical_power() );
+    }
+    /* the others did not move */
+    REQUIRE( batch.height(2) == 1.0 );
+    REQUIRE( batch.height(4) == 1.0 );
+}
+
+TEST_CASE( "batched poles timing", "[.][benchmark][pole]" )
+{
+    using namespace local_tests::pole_batch_tests;
+    const std::size_t T = 200;
+
+    for (std::size_t N : {16ul, 1000ul, 10000ul}) {
+        std::vector<std::unique_ptr<robots::Robot_Interface>> poles;
+        for (std::size_t i = 0; i < N; ++i)
+            poles.emplace_back(new robots::pole());
+        robots::pole_batch exact(N), fast(N, false, fast_math::Mode::fast);
+
+        Stopwatch watch;
+        for (std::size_t t = 0; t < T; ++t)
+            for (std::size_t i = 0; i < N; ++i) {
+                poles[i]->set_joints()[0].motor = 0.5;
+                poles[i]->execute_cycle();
+            }
+        const double t_single = watch.get_time_passed_us();
+
+        for (std::size_t t = 0; t < T; ++t) {
+            std::fill(exact.set_actions(), exact.set_actions() + N, 0.5);
+            exact.execute_cycle();
+        }
+        const double t_exact = watch.get_time_passed_us();
+
+        for (std::size_t t = 0; t < T; ++t) {
+            std::fill(fast.set_actions(), fast.set_actions() + N, 0.5);
+            fast.execute_cycle();
+        }
+        const double t_fast = watch.get_time_passed_us();
+
+        sts_msg("%5u poles: %6.2f / %6.2f / %6.2f million pole steps per second (single/batch/batch fast)"
+               , N, N * T / t_single, N * T / t_exact, N * T / t_fast);
+    }
+}
@@ -0,0 +1,146 @@
+#include <tests/catch.hpp>
+
+#include <cfloat>
+#include <common/modules.h>
+#include <common/matrix_kernels.h>
+#include <control/control_core.h>
+#include <learning/time_delay_network.h>
+#include <learning/forward_inverse_model.hpp>
+#include <tests/test_robot.h>
+
+/* single precision learners and controllers against the double path */
+
+namespace local_tests {
+namespace precision_tests {
+
+template <typename A_t, typename B_t>
+double max_difference(A_t const& a, B_t const& b) {
+    assert(a.size() == b.size());
+    double diff = .0;
+    for (std::size_t i = 0; i < a.size(); ++i)
+        diff = std::max(diff, std::abs(double(a[i]) - double(b[i])));
+    return diff;
+}
+
+VectorN sines(std::size_t size, std::size_t t) {
+    VectorN x(size);
+    for (std::size_t i = 0; i < size; ++i)
+        x[i] = 0.5 * sin(0.05 * t * (i + 1) + i);
+    return x;
+}
+
+}} // namespace local_tests::precision_tests
+
+TEST_CASE( "float kernels match double kernels", "[precision][kernels]" )
+{
+    using namespace local_tests::precision_tests;
+    srand(4711);
+    for (std::size_t n : {1ul, 7ul, 16ul, 33ul, 100ul}) {
+        common::Matrix<double> Ad(5, n);
+        common::Matrix<float>  Af(5, n);
+        for (std::size_t i = 0; i < 5; ++i)
+            for (std::size_t j = 0; j < n; ++j)
+                Af(i,j) = Ad(i,j) = random_value(-1.0, 1.0);
+
+        VectorN xd = random_vector(n, -1.0, 1.0), ud = random_vector(5, -1.0, 1.0), yd(5), zd(n);
+        std::vector<float> xf(xd.begin(), xd.end()), uf(ud.begin(), ud.end()), yf(5), zf(n);
+
+        common::kernel::gemv(Ad, xd.data(), yd.data(), common::kernel::tanh_fn());
+        common::kernel::gemv(Af, xf.data(), yf.data(), common::kernel::tanh_fn());
+        REQUIRE( max_difference(yd, yf) < 1e-6 * n );
+
+        common::kernel::gemv_t(Ad, ud.data(), zd.data());
+        common::kernel::gemv_t(Af, uf.data(), zf.data());
+        REQUIRE( max_difference(zd, zf) < 1e-6 );
+
+        common::kernel::rank1_update(Ad, 0.1, ud.data(), xd.data());
+        common::kernel::rank1_update(Af, 0.1, uf.data(), xf.data());
+        for (std::size_t i = 0; i < 5; ++i)
+            REQUIRE( max_difference(Ad.row(i), Af.row(i)) < 1e-6 );
+    }
+}
+
+TEST_CASE( "float time delay network learns like double", "[precision][Time Delay Network]" )
+{
+    using namespace local_tests::precision_tests;
+    const std::size_t inputs = 5, taps = 8, hidden = 7;
+
+    srand(1234);
+    learning::Timedelay_Network<>      tdn_d(inputs, inputs, hidden, taps, 0.1);
+    learning::Timedelay_Network<float> tdn_f(tdn_d);
+
+    for (std::size_t i = 0; i < hidden; ++i)
+        REQUIRE( max_difference(tdn_d.get_weights().hi.row(i), tdn_f.get_weights().hi.row(i)) < 1e-8 );
+
+    double err_d = .0, err_f = .0, max_diff = .0;
+    for (std::size_t t = 0; t < 5000; ++t) {
+        const VectorN x = sines(inputs, t), target = sines(inputs, t + 1);
+        tdn_d.propagate_and_shift(x);
+        tdn_f.propagate_and_shift(x);
+        max_diff = std::max(max_diff, max_difference(tdn_d.get_outputs(), tdn_f.get_outputs()));
+        if (t >= 4000) {
+            err_d += squared_distance(target, tdn_d.get_outputs());
+            err_f += squared_distance(target, VectorN(tdn_f.get_outputs().begin(), tdn_f.get_outputs().end()));
+        }
+        tdn_d.adapt(target, 0.05);
+        tdn_f.adapt(target, 0.05);
+    }
+    dbg_msg("max. output difference %e, errors %e (double) %e (float)", max_diff, err_d, err_f);
+    REQUIRE( max_diff < 1e-3 );
+    REQUIRE( err_f < 1.01 * err_d );
+}
+
+TEST_CASE( "float neural model learns like double", "[precision][neural_model]" )
+{
+    using namespace local_tests::precision_tests;
+    typedef learning::NeuralModel<learning::TanhTransfer<>>             Double_Model_t;
+    typedef learning::NeuralModel<learning::TanhTransfer<float>, float> Float_Model_t;
+    const std::size_t size_in = 6, size_out = 4;
+
+    srand(2345);
+    Double_Model_t model_d(size_in, size_out, 0.1);
+    Float_Model_t  model_f(model_d);
+
+    double max_diff = .0;
+    for (std::size_t t = 0; t < 3000; ++t) {
+        const VectorN x = sines(size_in, t);
+        VectorN target(size_out);
+        for (std::size_t i = 0; i < size_out; ++i)
+            target[i] = 0.5 * tanh(x[i] - x[i+1] + 0.5 * x[i+2]);
+
+        model_d.propagate(x);
+        model_f.propagate(x);
+        max_diff = std::max(max_diff, max_difference(model_d.get_outputs(), model_f.get_outputs()));
+        model_d.adapt(x, target, 0.001, 0.0);
+        model_f.adapt(x, target, 0.001, 0.0);
+    }
+    dbg_msg("max. output difference %e, errors %e (double) %e (float)", max_diff, model_d.get_error(), model_f.get_error());
+    REQUIRE( max_diff < 1e-3 );
+    REQUIRE( std::abs(model_d.get_error() - model_f.get_error()) < 1e-4 );
+    REQUIRE( max_difference(model_d.get_backprop_err(), model_f.get_backprop_err()) < 1e-4 );
+}
+
+TEST_CASE( "float symmetric core matches double", "[precision][control]" )
+{
+    using namespace local_tests::precision_tests;
+    srand(3456);
+    Test_Robot robot(6, 2);
+    const std::size_t num_params = robot.get_number_of_joints() * control::get_number_of_inputs(robot);
+    const std::vector<double> params = random_vector(num_params, -1.0, 1.0);
+
+    control::Fully_Connected_Symmetric_Core<>      core_d(robot);
+    control::Fully_Connected_Symmetric_Core<float> core_f(robot);
+    core_d.apply_weights(robot, params);
+    core_f.apply_weights(robot, params);
+
+    for (std::size_t t = 0; t < 100; ++t) {
+        robot.set_random_inputs();
+        core_d.prepare_inputs(robot);
+        core_f.prepare_inputs(robot);
+        for (bool symmetric : {false, true}) {
+            core_d.update_outputs(robot, symmetric, false);
+            core_f.update_outputs(robot, symmetric, false);
+            REQUIRE( max_difference(core_d.activation, core_f.activation) < 1e-5 );
+        }
+    }
+}
@@ -8,9 +8,18 @@
 class test_space : public sensor_vector {
 public:
     test_space(const double sigma) : sensor_vector(3) {
-        sensors.emplace_back("Foo", [sigma](){ return  0.42 + rand_norm_zero_mean(sigma); });
-        sensors.emplace_back("Bar", [sigma](){ return  0.37 + rand_norm_zero_mean(sigma); });
-        sensors.emplace_back("Baz", [sigma](){ return -0.23 + rand_norm_zero_mean(sigma); });
+        add_sensor("Foo", [sigma](){ return  0.42 + rand_norm_zero_mean(sigma); });
+        add_sensor("Bar", [sigma](){ return  0.37 + rand_norm_zero_mean(sigma); });
+        add_sensor("Baz", [sigma](){ return -0.23 + rand_norm_zero_mean(sigma); });
+    }
+};
+
+class signal_space : public sensor_vector {
+public:
+    signal_space(const std::size_t& t) : sensor_vector(3) {
+        add_sensor("Foo", [&t](){ return 0.5 * sin(0.10 * t); });
+        add_sensor("Bar", [&t](){ return 0.3 * cos(0.07 * t) + 0.2; });
+        add_sensor("Baz", [&t](){ return 0.4 * sin(0.03 * t + 1.0); });
     }
 };
 
@@ -57,6 +66,60 @@ TEST_CASE( "adapt with experience replay" , "[predictor]")
     dbg_msg("%6.4f %6.4f %6.4f", w[0], w[1], w[2]);
 }
 
+TEST_CASE( "experience replay with running sums equals replaying the list" , "[predictor]")
+{
+    /* deterministic inputs, so both runs see the same samples */
+    std::size_t t = 0;
+    signal_space sensors(t);
+    sensors.execute_cycle();
+
+    const std::size_t M = 50, T = 2000;
+    const double rate = 0.1;
+    srand(4711);
+    Predictor pred{ sensors, rate, 0.01, M };
+    std::vector<VectorN> weights;
+    for (t = 1; t <= T; ++t) {
+        sensors.execute_cycle();
+        pred.adapt();
+        weights.push_back(pred.get_weights());
+    }
+
+    /* reference: learn the whole replay list on every step */
+    t = 0;
+    sensors.execute_cycle();
+    srand(4711);
+    VectorN w = sensors.get();
+    std::vector<VectorN> experience(M, w);
+
+    for (t = 1; t <= T; ++t) {
+        sensors.execute_cycle();
+        const std::size_t skip = random_index(M);
+        for (std::size_t m = 0; m < w.size(); ++m) {
+            double delta = .0;
+            for (std::size_t i = 0; i < M; ++i)
+                if (i != skip)
+                    delta += experience[i][m] - w[m];
+            w[m] += delta * rate / (M - 1);
+        }
+        for (std::size_t m = 0; m < w.size(); ++m)
+            w[m] += rate * (sensors[m] - w[m]) / M;
+        experience[skip] = sensors.get();
+
+        for (std::size_t m = 0; m < w.size(); ++m)
+            REQUIRE( close(weights[t-1][m], w[m], 1e-12) );
+    }
+
+    auto const& replay = pred.get_experience();
+    for (std::size_t m = 0; m < w.size(); ++m) {
+        double sum = .0;
+        for (std::size_t i = 0; i < M; ++i) {
+            REQUIRE( replay[i][m] == experience[i][m] );
+            sum += experience[i][m];
+        }
+        REQUIRE( close(replay.sum(m), sum, 1e-12) );
+    }
+}
+
 TEST_CASE( "prediction error must be constant without learning step" )
 {
     srand((unsigned) time(0));
@@ -0,0 +1,414 @@
+#include <tests/catch.hpp>
+
+#include <thread>
+#include <atomic>
+#include <common/modules.h>
+#include <common/stopwatch.h>
+#include <common/log_messages.h>
+#include <common/random_stream.h>
+#include <control/spaces.h>
+#include <learning/sarsa.h>
+#include <learning/reward.h>
+#include <learning/payload.h>
+#include <learning/epsilon_greedy.h>
+#include <robots/pole.h>
+
+namespace local_tests {
+namespace sarsa_tests {
+
+class Test_Actions : public Action_Module_Interface {
+    const std::size_t number_of_actions;
+public:
+    explicit Test_Actions(std::size_t n) : number_of_actions(n) {}
+    std::size_t get_number_of_actions          (void) const override { return number_of_actions; }
+    std::size_t get_number_of_actions_available(void) const override { return number_of_actions; }
+    bool exists(const std::size_t /*action_index*/)   const override { return true; }
+};
+
+class Test_Rewards : public reward_base {
+public:
+    explicit Test_Rewards(std::size_t number_of_policies)
+    : reward_base(number_of_policies), values(number_of_policies, .0)
+    {
+        for (std::size_t i = 0; i < number_of_policies; ++i)
+            rewards.emplace_back("r" + std::to_string(i), [this, i](){ return values[i]; });
+    }
+    std::vector<double> values;
+};
+
+/* the dense learning step as it was: all traces, all Q-values */
+struct Dense_SARSA {
+    std::vector<std::vector<std::vector<double>>> q; // [s][pi][a]
+    std::vector<std::vector<double>>              e; // [s][a]
+    std::vector<double> rates;
+    float gamma, lambda;
+
+    Dense_SARSA(static_vector<State_Payload> const& states, std::vector<double> const& rates, float gamma, float lambda)
+    : q(states.size()), e(states.size()), rates(rates), gamma(gamma), lambda(lambda)
+    {
+        for (std::size_t s = 0; s < states.size(); ++s) {
+            for (std::size_t pi = 0; pi < states[s].policies.size(); ++pi)
+                q[s].emplace_back(states[s].policies[pi].qvalues.begin(), states[s].policies[pi].qvalues.end());
+            e[s].assign(q[s][0].size(), .0);
+        }
+    }
+
+    void step(reward_base const& rewards, std::size_t last_s, std::size_t last_a, std::size_t s, std::size_t a) {
+        std::vector<double> delta(rates.size());
+        for (std::size_t pi = 0; pi < rates.size(); ++pi)
+            delta[pi] = rewards.get_aggregated_last_reward(pi) + gamma * q[s][pi][a] - q[last_s][pi][last_a];
+        if (s != last_s)
+            for (auto& es : e) for (auto& x : es) x *= gamma*lambda;
+        e[last_s][last_a] = 1.0;
+        for (std::size_t i = 0; i < q.size(); ++i)
+            for (std::size_t j = 0; j < e[i].size(); ++j)
+                for (std::size_t pi = 0; pi < rates.size(); ++pi)
+                    q[i][pi][j] += rates[pi] * delta[pi] * e[i][j];
+    }
+};
+
+struct Setup {
+    Test_Actions                 actions;
+    Test_Rewards                 rewards;
+    static_vector<State_Payload> states;
+    learning::Epsilon_Greedy     selection;
+    std::vector<double>          rates;
+
+    Setup(std::size_t S, std::size_t A, std::size_t P)
+    : actions(A), rewards(P), states(S, std::make_shared<learning::Q_Tensor>(actions, P, 0.0, S)), selection(states, actions, 0.1), rates()
+    {
+        for (std::size_t pi = 0; pi < P; ++pi)
+            rates.push_back(0.05 * (pi + 1));
+    }
+};
+
+/* random walk over the states, staying a while in each */
+std::size_t next_state(std::size_t s, std::size_t S) {
+    return (random_value(0.0, 1.0) < 0.7) ? s : (s + S + random_int(-3, 3)) % S;
+}
+
+double max_q_difference(static_vector<State_Payload> const& states, Dense_SARSA const& dense) {
+    double diff = .0;
+    for (std::size_t s = 0; s < states.size(); ++s)
+        for (std::size_t pi = 0; pi < states[s].policies.size(); ++pi)
+            for (std::size_t a = 0; a < dense.e[s].size(); ++a)
+                diff = std::max(diff, std::abs(states[s].policies[pi].qvalues[a] - dense.q[s][pi][a]));
+    return diff;
+}
+
+/* an agent of its own on the pendulum: swing-up by discrete torques,
+   the states are a grid over angle and velocity */
+struct Pendulum_Agent {
+    static const std::size_t angle_bins = 20, velocity_bins = 10, number_of_actions = 5;
+
+    robots::pole                   pole;
+    control::pendulum_sensor_space sensors;
+    control::pendulum_reward_space rewards;
+    learning::Epsilon_Greedy       selection;
+    SARSA                          sarsa;
+
+    Pendulum_Agent( static_vector<State_Payload>& states, Action_Module_Interface const& actions
+                  , GMES const& gmes, std::vector<double> const& rates, uint32_t seed )
+    : pole()
+    , sensors(pole.get_joints())
+    , rewards(gmes, pole.get_joints())
+    , selection(states, actions, 0.1)
+    , sarsa(states, rewards, selection, number_of_actions, rates)
+    {
+        selection.set_random_stream(seed);
+        sarsa.enable_concurrent_learning();
+        sarsa.select_policy(1, false); // swing-up
+    }
+
+    static std::size_t number_of_states(void) { return angle_bins * velocity_bins; }
+
+    std::size_t get_state(void) const {
+        const double phi = std::atan2(sensors[0], -sensors[1]) / M_PI; // [-1,+1]
+        const std::size_t i = std::min(angle_bins    - 1, std::size_t((phi + 1.0) / 2.0 * angle_bins));
+        const std::size_t j = std::min(velocity_bins - 1, std::size_t((sensors[2] + 1.0) / 2.0 * velocity_bins));
+        return i * velocity_bins + j;
+    }
+
+    void act(std::size_t action) { pole.set_joints()[0].motor = -1.0 + 2.0 * action / (number_of_actions - 1); }
+
+    void execute_cycle(void) {
+        pole.execute_cycle();
+        sensors.execute_cycle();
+        rewards.execute_cycle();
+        sarsa.execute_cycle(get_state());
+        rewards.clear_aggregations();
+        act(sarsa.get_current_action());
+    }
+};
+
+}} // namespace local_tests::sarsa_tests
+
+TEST_CASE( "sparse traces learn like dense traces", "[sarsa]" )
+{
+    using namespace local_tests::sarsa_tests;
+    const std::size_t S = 200, A = 5, P = 3, T = 5000;
+
+    for (double cutoff : {0.0, sarsa_constants::TRACE_CUTOFF}) {
+        srand(4242);
+        Setup setup(S, A, P);
+        SARSA sarsa(setup.states, setup.rewards, setup.selection, A, setup.rates
+                   , sarsa_constants::GAMMA, sarsa_constants::LAMBDA, 0, 0, cutoff);
+        Dense_SARSA dense(setup.states, setup.rates, sarsa_constants::GAMMA, sarsa_constants::LAMBDA);
+
+        std::size_t s = 0, a = 0, max_active = 0;
+        for (std::size_t t = 0; t < T; ++t) {
+            for (auto& r : setup.rewards.values) r = random_value(-1.0, 1.0);
+            setup.rewards.execute_cycle();
+            const std::size_t last_s = s, last_a = a;
+            s = next_state(s, S);
+            a = random_index(A);
+            sarsa.execute_cycle(s, a);
+            dense.step(setup.rewards, last_s, last_a, s, a);
+            max_active = std::max(max_active, sarsa.get_number_of_active_states());
+            REQUIRE( sarsa.get_trace(last_s, last_a) == Approx(1.0) );
+        }
+        const double diff = max_q_difference(setup.states, dense);
+        dbg_msg("cutoff %e: max. Q difference %e, max. %u active states", cutoff, diff, max_active);
+        if (cutoff == 0.0)
+            REQUIRE( diff < 1e-9 );
+        else {
+            REQUIRE( diff < 1e-3 );
+            REQUIRE( max_active < S / 4 ); // cost per step is proportional to these
+        }
+        for (std::size_t i = 0; i < S; ++i) {
+            const bool active = cutoff == 0.0 or *std::max_element(dense.e[i].begin(), dense.e[i].end()) >= cutoff;
+            for (std::size_t j = 0; j < A; ++j)
+                REQUIRE( close(sarsa.get_trace(i, j), active ? dense.e[i][j] : 0.0, 1e-9) );
+        }
+    }
+}
+
+TEST_CASE( "traces copied to an inactive state survive renormalization", "[sarsa]" )
+{
+    using namespace local_tests::sarsa_tests;
+    const std::size_t S = 10, A = 3, P = 1;
+    srand(1900);
+    Setup setup(S, A, P);
+    SARSA sarsa(setup.states, setup.rewards, setup.selection, A, setup.rates);
+
+    auto max_abs_q = [&setup]() {
+        double q = .0;
+        for (std::size_t i = 0; i < S; ++i)
+            for (std::size_t a = 0; a < A; ++a) q = std::max(q, std::abs(setup.states[i].policies[0].qvalues[a]));
+        return q;
+    };
+
+    /* states 0..6 only, each step changes the state, hence decays the traces */
+    std::size_t s = 0;
+    for (std::size_t t = 0; t < 2500; ++t) {
+        if (t == 1900) {
+            REQUIRE( sarsa.get_trace(7, 0) == 0.0 );
+            setup.states.copy(7, 0); // clone, e.g. by GMES
+        }
+        setup.rewards.values[0] = random_value(-1.0, 1.0);
+        setup.rewards.execute_cycle();
+        s = (s + 1 + random_index(6)) % 7;
+        sarsa.execute_cycle(s, random_index(A));
+    }
+    const double before = max_abs_q();
+    REQUIRE( before < 10.0 );
+
+    for (std::size_t t = 0; t < 20; ++t) {
+        setup.rewards.values[0] = random_value(-1.0, 1.0);
+        setup.rewards.execute_cycle();
+        s = (t % 2 == 0) ? 7 : random_index(7);
+        sarsa.execute_cycle(s, random_index(A));
+        for (std::size_t a = 0; a < A; ++a)
+            REQUIRE( sarsa.get_trace(7, a) <= 1.0 );
+    }
+    REQUIRE( max_abs_q() < 10.0 );
+}
+
+TEST_CASE( "concurrent mode learns like the plain mode", "[sarsa]" )
+{
+    using namespace local_tests::sarsa_tests;
+    const std::size_t S = 50, A = 4, P = 2, T = 2000;
+
+    Setup plain(S, A, P), shared(S, A, P);
+    for (std::size_t i = 0; i < S; ++i)
+        for (std::size_t pi = 0; pi < P; ++pi)
+            for (std::size_t j = 0; j < A; ++j)
+                shared.states[i].policies[pi].qvalues[j] = plain.states[i].policies[pi].qvalues[j];
+    SARSA a(plain .states, plain .rewards, plain .selection, A, plain .rates);
+    SARSA b(shared.states, shared.rewards, shared.selection, A, shared.rates);
+    b.enable_concurrent_learning();
+    REQUIRE( b.is_concurrent() );
+
+    common::Random_Stream walk(3);
+    std::size_t s = 0;
+    for (std::size_t t = 0; t < T; ++t) {
+        for (std::size_t pi = 0; pi < P; ++pi)
+            plain.rewards.values[pi] = shared.rewards.values[pi] = walk.uniform(-1.0, 1.0);
+        plain.rewards.execute_cycle();
+        shared.rewards.execute_cycle();
+        s = (walk.uniform() < 0.7) ? s : (s + 1 + std::size_t(walk.uniform() * (S - 1))) % S;
+        const std::size_t action = std::size_t(walk.uniform() * A);
+        a.execute_cycle(s, action);
+        b.execute_cycle(s, action);
+        REQUIRE( a.get_trace(s, action) == b.get_trace(s, action) );
+    }
+
+    /* traces are the agent's own, the payloads' are untouched */
+    for (std::size_t i = 0; i < S; ++i)
+        for (std::size_t j = 0; j < A; ++j) {
+            for (std::size_t pi = 0; pi < P; ++pi)
+                REQUIRE( close(plain.states[i].policies[pi].qvalues[j], shared.states[i].policies[pi].qvalues[j], 1e-12) );
+            REQUIRE( shared.states[i].eligibility_trace[j].get() == 0.0 );
+        }
+}
+
+TEST_CASE( "concurrent agents learn into one Q tensor", "[sarsa]" )
+{
+    using namespace local_tests::sarsa_tests;
+    const std::size_t S = 100, A = 5, P = 2, T = 5000, N = 4;
+
+    srand(2121);
+    Setup setup(S, A, P); // shared states
+    auto const& q = setup.states[S/2].policies[1].qvalues;
+    const std::vector<double> q0(q.begin(), q.end());
+
+    std::vector<std::unique_ptr<Test_Rewards>>             rewards;
+    std::vector<std::unique_ptr<learning::Epsilon_Greedy>> selection;
+    std::vector<std::unique_ptr<SARSA>>                    agents;
+    for (std::size_t n = 0; n < N; ++n) {
+        rewards  .emplace_back(new Test_Rewards(P));
+        selection.emplace_back(new learning::Epsilon_Greedy(setup.states, setup.actions, 0.5));
+        selection.back()->set_random_stream(100 + n);
+        agents   .emplace_back(new SARSA(setup.states, *rewards.back(), *selection.back(), A, setup.rates));
+        agents.back()->enable_concurrent_learning();
+    }
+
+    std::vector<std::thread> threads;
+    for (std::size_t n = 0; n < N; ++n)
+        threads.emplace_back([&, n]() {
+            common::Random_Stream walk(n);
+            std::size_t s = (n * S) / N;
+            for (std::size_t t = 0; t < T; ++t) {
+                rewards[n]->values[0] = (s == S/2) ? 1.0 : 0.0;
+                rewards[n]->values[1] = walk.uniform(-1.0, 1.0);
+                rewards[n]->execute_cycle();
+                s = (s + S + (walk.uniform() < 0.5 ? 1 : -1)) % S;
+                agents[n]->execute_cycle(s);
+                rewards[n]->clear_aggregations();
+            }
+        });
+    for (auto& t : threads) t.join();
+
+    for (std::size_t i = 0; i < S; ++i)
+        for (std::size_t pi = 0; pi < P; ++pi)
+            for (std::size_t j = 0; j < A; ++j) {
+                REQUIRE( std::isfinite(setup.states[i].policies[pi].qvalues[j]) );
+                REQUIRE( setup.states[i].eligibility_trace[j].get() == 0.0 );
+            }
+    REQUIRE( not std::equal(q0.begin(), q0.end(), setup.states[S/2].policies[1].qvalues.begin()) );
+
+    /* states next to the rewarded one are valued by all agents */
+    REQUIRE( setup.states[S/2 - 1].policies[0].get_max_q() > 0.1 );
+    REQUIRE( setup.states[S/2 + 1].policies[0].get_max_q() > 0.1 );
+}
+
+TEST_CASE( "sparse traces timing", "[.][benchmark][sarsa]" )
+{
+    using namespace local_tests::sarsa_tests;
+    const std::size_t A = 10, P = 3, T = 2000;
+
+    for (std::size_t S : {50ul, 200ul, 1000ul}) {
+        srand(1234);
+        Setup setup(S, A, P);
+        SARSA sarsa(setup.states, setup.rewards, setup.selection, A, setup.rates);
+        Dense_SARSA dense(setup.states, setup.rates, sarsa_constants::GAMMA, sarsa_constants::LAMBDA);
+
+        std::vector<std::size_t> sequence(T + 1, 0);
+        for (std::size_t t = 1; t <= T; ++t)
+            sequence[t] = next_state(sequence[t-1], S);
+
+        Stopwatch watch;
+        for (std::size_t t = 1; t <= T; ++t) {
+            setup.rewards.execute_cycle();
+            dense.step(setup.rewards, sequence[t-1], t % A, sequence[t], (t + 1) % A);
+        }
+        const double t_dense = watch.get_time_passed_us() / double(T);
+        for (std::size_t t = 1; t <= T; ++t) {
+            setup.rewards.execute_cycle();
+            sarsa.execute_cycle(sequence[t], (t + 1) % A);
+        }
+        const double t_sparse = watch.get_time_passed_us() / double(T);
+        sts_msg("%4u states x %u actions x %u policies: %8.2f us (dense) %6.2f us (sparse) per step, %u active states"
+               , S, A, P, t_dense, t_sparse, sarsa.get_number_of_active_states());
+    }
+}
+
+TEST_CASE( "concurrent pendulum agents timing", "[.][benchmark][sarsa]" )
+{
+    using namespace local_tests::sarsa_tests;
+    typedef Pendulum_Agent Agent;
+    const std::size_t P = 3, evaluation_steps = 2000;
+    const std::vector<double> rates(P, 0.1);
+    const std::size_t max_agents = std::max(4u, std::thread::hardware_concurrency());
+    sts_msg("%u hardware threads", std::thread::hardware_concurrency());
+
+    /* idle GMES, intrinsic learning rewards are zero */
+    robots::pole dummy;
+    control::pendulum_sensor_space dummy_sensors(dummy.get_joints());
+    static_vector<Empty_Payload> payloads(2);
+    Expert_Vector experts(2, payloads, dummy_sensors, 0.1, 0.05, 1);
+    GMES gmes(experts, 35.0, true);
+    Test_Actions actions(Agent::number_of_actions);
+
+    for (std::size_t N = 1; N <= max_agents; N *= 2) {
+        /* optimistic initial values, the swing-up reward is sparse */
+        srand(4711);
+        static_vector<State_Payload> states(Agent::number_of_states(), std::make_shared<learning::Q_Tensor>(actions, P, 1.0 / (1.0 - sarsa_constants::GAMMA), Agent::number_of_states()));
+        std::vector<std::unique_ptr<Agent>> agents;
+        for (std::size_t n = 0; n < N; ++n)
+            agents.emplace_back(new Agent(states, actions, gmes, rates, 1000 + n));
+
+        /* greedy swing-up of a fresh pendulum, mean reward */
+        auto evaluate = [&]() {
+            Agent eval(states, actions, gmes, rates, 1);
+            double sum = .0;
+            for (std::size_t t = 0; t < evaluation_steps; ++t) {
+                eval.pole.execute_cycle();
+                eval.sensors.execute_cycle();
+                eval.rewards.execute_cycle();
+                sum += eval.rewards.get_current_reward(1);
+                const double* q = states[eval.get_state()].get_qvalues(1); // written by the agents
+                double row[Agent::number_of_actions];
+                for (std::size_t a = 0; a < Agent::number_of_actions; ++a)
+                    row[a] = learning::Q_Tensor::load(q + a);
+                eval.act(learning::Q_Tensor::argmax(row, actions));
+            }
+            return sum / evaluation_steps;
+        };
+
+        std::atomic<bool> running(true);
+        std::vector<std::atomic<std::size_t>> steps(N);
+        for (auto& n : steps) n = 0;
+        std::vector<std::thread> threads;
+        for (std::size_t n = 0; n < N; ++n)
+            threads.emplace_back([&, n]() {
+                while (running.load(std::memory_order_relaxed)) {
+                    agents[n]->execute_cycle();
+                    steps[n].fetch_add(1, std::memory_order_relaxed);
+                }
+            });
+
+        Stopwatch watch;
+        double wall_time = .0;
+        for (double checkpoint : {0.25, 0.5, 1.0, 2.0}) {
+            std::this_thread::sleep_for(std::chrono::microseconds(std::size_t(1e6 * (checkpoint - wall_time))));
+            wall_time += watch.get_time_passed_us() / 1e6;
+            std::size_t total = 0;
+            for (auto const& n : steps) total += n;
+            sts_msg("%2u agents %4.2f s: %8u steps, greedy swing-up reward %5.3f", N, wall_time, total, evaluate());
+            wall_time += watch.get_time_passed_us() / 1e6;
+        }
+        running = false;
+        for (auto& t : threads) t.join();
+    }
+}
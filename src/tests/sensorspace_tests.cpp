@@ -0,0 +1,173 @@
+#include <tests/catch.hpp>
+
+#include <vector>
+#include <cstdint>
+#include <string>
+#include <functional>
+#include <common/modules.h>
+#include <common/stopwatch.h>
+#include <common/log_messages.h>
+#include <common/static_vector.h>
+#include <control/sensorspace.h>
+#include <control/jointcontrol.h>
+#include <learning/payload.h>
+#include <learning/expert_vector.h>
+#include <learning/gmes.h>
+#include <learning/state_layer.h>
+#include <learning/time_state_space.h>
+#include <robots/synthetic.h>
+
+namespace local_tests {
+namespace sensorspace_tests {
+
+/* same as the motor layer's motor space */
+class Motor_Space : public sensor_vector {
+public:
+    Motor_Space(const robots::Jointvector_t& joints)
+    : sensor_vector(joints.size())
+    {
+        for (robots::Joint_Model const& j : joints)
+            add_sensor(j.name, [&j](){ return clip(j.motor.get()); });
+    }
+};
+
+/* counts the element-wise reads and copies of a sensor space */
+template <typename Space_t>
+class Counting : public Space_t {
+public:
+    template <typename... Args>
+    Counting(Args const&... args) : Space_t(args...) {}
+
+    double operator[] (std::size_t index) const override { ++reads; return Space_t::operator[](index); }
+    VectorN get(void) const override { ++copies; return Space_t::get(); }
+
+    mutable std::size_t reads = 0;
+    mutable std::size_t copies = 0;
+};
+
+/* sensors can be added at any time */
+class sensor_vector_with_signals : public sensor_vector {
+public:
+    void add(std::string const& name, std::function<double()> lambda) { add_sensor(name, lambda); }
+};
+
+robots::Synthetic_Parameters layer_robot(void) {
+    robots::Synthetic_Parameters params;
+    params.number_of_joints = 12;
+    params.number_of_symmetric_joints = 4;
+    params.number_of_accels = 2;
+    params.noise = 0.5;
+    return params;
+}
+
+}} // namespace local_tests::sensorspace_tests
+
+TEST_CASE( "sensor space snapshots equal the element-wise values", "[sensorspace]" )
+{
+    using namespace local_tests::sensorspace_tests;
+    robots::Synthetic_Robot robot(layer_robot());
+    control::Jointcontrol control(robot);
+    control.set_control_parameter(control::get_initial_parameter(robot, {1.0, 0.0, 1.0}, false));
+
+    learning::State_Space statespace(robot.get_joints());
+    Motor_Space motorspace(robot.get_joints());
+    learning::Time_State_Space<3> timespace(robot);
+
+    /* before the first cycle */
+    REQUIRE( statespace.values().size() == statespace.size() );
+    REQUIRE( timespace.values().size() == timespace.size() );
+    REQUIRE( timespace.values()[timespace.size() - 1] == 0.1 ); // bias
+    for (std::size_t i = 0; i < timespace.size() - 1; ++i)
+        REQUIRE( timespace.values()[i] == 0.0 );
+
+    for (std::size_t t = 0; t < 100; ++t) {
+        control.execute_cycle();
+        robot.execute_cycle();
+        statespace.execute_cycle();
+        motorspace.execute_cycle();
+        timespace.execute_cycle();
+
+        auto const s = statespace.values();
+        auto const m = motorspace.values();
+        auto const x = timespace.values();
+        REQUIRE( s.size() == statespace.size() );
+        REQUIRE( m.size() == motorspace.size() );
+        REQUIRE( x.size() == timespace.size() );
+        for (std::size_t i = 0; i < s.size(); ++i) REQUIRE( s[i] == statespace[i] );
+        for (std::size_t i = 0; i < m.size(); ++i) REQUIRE( m[i] == motorspace[i] );
+        for (std::size_t i = 0; i < x.size(); ++i) REQUIRE( x[i] == timespace[i] );
+
+        /* same values on repeated reads within a cycle */
+        REQUIRE( statespace.values().data() == s.data() );
+    }
+    REQUIRE( reinterpret_cast<std::uintptr_t>(statespace.values().data()) % 32 == 0 );
+}
+
+TEST_CASE( "sensor space snapshot follows added sensors", "[sensorspace]" )
+{
+    using namespace local_tests::sensorspace_tests;
+    double a = 0.5, b = -0.25;
+    sensor_vector_with_signals space;
+    space.add("a", [&a](){ return a; });
+    REQUIRE( space.values().size() == 1 );
+    space.execute_cycle();
+    REQUIRE( space.values()[0] == 0.5 );
+
+    space.add("b", [&b](){ return b; });
+    REQUIRE( space.values().size() == 2 );
+    REQUIRE( space.values()[1] == 0.0 ); // not yet evaluated
+    space.execute_cycle();
+    REQUIRE( space.values()[1] == -0.25 );
+}
+
+TEST_CASE( "state and motor layer timing", "[.][benchmark][sensorspace]" )
+{
+    using namespace local_tests::sensorspace_tests;
+    const std::size_t T = 2000, N = 20;
+
+    {   /* as the state layer */
+        srand(1111);
+        robots::Synthetic_Robot robot(layer_robot());
+        control::Jointcontrol control(robot);
+        control.set_control_parameter(control::get_initial_parameter(robot, {1.0, 0.0, 1.0}, false));
+        static_vector<Empty_Payload> payloads(N);
+        Counting<learning::State_Space> statespace(robot.get_joints());
+        learning::FIR_type_synapse delay_line(statespace.size(), /*taps*/3);
+        Expert_Vector experts(N, payloads, statespace, delay_line, 0.01, /*experience*/1, /*hidden*/5);
+        GMES gmes(experts, 20.0, false);
+        statespace.reads = statespace.copies = 0;
+
+        Stopwatch watch;
+        for (std::size_t t = 0; t < T; ++t) {
+            control.execute_cycle();
+            robot.execute_cycle();
+            statespace.execute_cycle();
+            delay_line.propagate(statespace.values());
+            gmes.execute_cycle();
+        }
+        sts_msg("state layer: %.2f us per cycle, %.1f virtual reads and %.3f copies per cycle, %u experts"
+               , watch.get_time_passed_us() / double(T), statespace.reads / double(T), statespace.copies / double(T), gmes.get_number_of_experts());
+    }
+    {   /* as the motor layer */
+        srand(2222);
+        robots::Synthetic_Robot robot(layer_robot());
+        control::Jointcontrol control(robot);
+        control.set_control_parameter(control::get_initial_parameter(robot, {1.0, 0.0, 1.0}, false));
+        control::Control_Vector params = control::param_factory(robot, N, "", {1.0, 0.0, 1.0});
+        static_vector<Empty_Payload> payloads(N);
+        Counting<Motor_Space> motorspace(robot.get_joints());
+        Expert_Vector experts(N, payloads, motorspace, 0.01, /*experience*/1, /*noise*/0.005, params, robot);
+        GMES gmes(experts, 1.0, false, N);
+        motorspace.reads = motorspace.copies = 0;
+
+        Stopwatch watch;
+        for (std::size_t t = 0; t < T; ++t) {
+            control.execute_cycle();
+            robot.execute_cycle();
+            motorspace.execute_cycle();
+            gmes.execute_cycle();
+        }
+        sts_msg("motor layer: %.2f us per cycle, %.1f virtual reads and %.3f copies per cycle, %u experts"
+               , watch.get_time_passed_us() / double(T), motorspace.reads / double(T), motorspace.copies / double(T), gmes.get_number_of_experts());
+    }
+}
@@ -0,0 +1,162 @@
+#include <tests/catch.hpp>
+
+#include <vector>
+#include <common/modules.h>
+#include <common/stopwatch.h>
+#include <common/log_messages.h>
+#include <control/jointcontrol.h>
+#include <control/controlparameter.h>
+#include <robots/synthetic.h>
+
+namespace local_tests {
+namespace synthetic_robot_tests {
+
+void set_motors(robots::Robot_Interface& robot, std::size_t t) {
+    auto& joints = robot.set_joints();
+    for (std::size_t i = 0; i < joints.size(); ++i)
+        joints[i].motor = 0.8 * std::sin(0.05 * t + i);
+}
+
+}} // namespace local_tests::synthetic_robot_tests
+
+TEST_CASE( "synthetic robot matches its configuration", "[synthetic]" )
+{
+    robots::Synthetic_Parameters params;
+    params.number_of_joints = 7;
+    params.number_of_symmetric_joints = 3;
+    params.number_of_accels = 4;
+    robots::Synthetic_Robot robot(params);
+
+    REQUIRE( robot.get_number_of_joints()           == 7 );
+    REQUIRE( robot.get_number_of_symmetric_joints() == 3 );
+    REQUIRE( robot.get_number_of_accel_sensors()    == 4 );
+    REQUIRE( robot.get_number_of_bodies()           == 8 );
+    REQUIRE( robot.get_joints().size() == 7 );
+    REQUIRE( robot.get_accels().size() == 4 );
+    REQUIRE( robot.get_bodies().size() == 8 );
+
+    auto const& joints = robot.get_joints();
+    for (std::size_t i = 0; i < 6; i += 2) {
+        REQUIRE( joints[i  ].type == robots::Joint_Type_Normal    );
+        REQUIRE( joints[i+1].type == robots::Joint_Type_Symmetric );
+        REQUIRE( joints[i  ].symmetric_joint == i+1 );
+        REQUIRE( joints[i+1].symmetric_joint == i   );
+    }
+    REQUIRE( joints[6].type == robots::Joint_Type_Normal );
+
+    /* upright chain at rest */
+    auto const& bodies = robot.get_bodies();
+    REQUIRE( bodies[7].position.z == Approx(0.7) );
+    REQUIRE( std::abs(bodies[7].position.x) < 1e-12 );
+}
+
+TEST_CASE( "synthetic robot moves with its motors", "[synthetic]" )
+{
+    robots::Synthetic_Robot robot;
+
+    /* no motors, no noise: stays at rest */
+    for (std::size_t t = 0; t < 100; ++t)
+        robot.execute_cycle();
+    for (auto const& j : robot.get_joints()) {
+        REQUIRE( j.s_ang == 0.0 );
+        REQUIRE( j.s_vel == 0.0 );
+    }
+    REQUIRE( robot.get_accels()[0].a.z == Approx(9.81) );
+
+    /* one joint driven, the neighbors follow by coupling, the others less */
+    for (std::size_t t = 0; t < 200; ++t) {
+        robot.set_joints()[3].motor = 0.5;
+        robot.execute_cycle();
+        REQUIRE( robot.get_joints()[3].motor.get() == 0.0 );
+        REQUIRE( robot.get_joints()[3].s_cur == 0.5 );
+    }
+    auto const& joints = robot.get_joints();
+    REQUIRE( joints[3].s_ang > 0.1 );
+    REQUIRE( joints[3].s_ang <= joints[3].limit_hi );
+    REQUIRE( joints[2].s_ang > 0.0 );
+    REQUIRE( joints[4].s_ang > 0.0 );
+    REQUIRE( joints[2].s_ang > joints[0].s_ang );
+    REQUIRE( robot.get_cycles() == 300 );
+
+    /* full torque, ends at the joint stop */
+    for (std::size_t t = 0; t < 500; ++t) {
+        robot.set_joints()[3].motor = -1.0;
+        robot.execute_cycle();
+        for (auto const& j : joints)
+            REQUIRE( std::abs(j.s_ang) <= 0.5 );
+    }
+    REQUIRE( joints[3].s_ang == joints[3].limit_lo );
+    REQUIRE( joints[3].s_vel == 0.0 );
+
+    robot.reset();
+    REQUIRE( joints[3].s_ang == 0.0 );
+    REQUIRE( robot.get_cycles() == 0 );
+}
+
+TEST_CASE( "synthetic robot is reproducible by seed", "[synthetic]" )
+{
+    using namespace local_tests::synthetic_robot_tests;
+    robots::Synthetic_Parameters params;
+    params.number_of_accels = 3;
+    params.noise = 1.0;
+    robots::Synthetic_Robot a(params), b(params);
+    params.seed += 1;
+    robots::Synthetic_Robot c(params);
+
+    auto run = [](robots::Synthetic_Robot& robot) {
+        std::vector<double> trajectory;
+        for (std::size_t t = 0; t < 300; ++t) {
+            set_motors(robot, t);
+            robot.execute_cycle();
+            for (auto const& j : robot.get_joints()) {
+                trajectory.push_back(j.s_ang);
+                trajectory.push_back(j.s_vel);
+            }
+            for (auto const& s : robot.get_accels())
+                trajectory.push_back(s.a.x);
+        }
+        return trajectory;
+    };
+
+    const std::vector<double> ta = run(a);
+    REQUIRE( ta == run(b) );
+    REQUIRE( ta != run(c) );
+
+    a.reset();
+    REQUIRE( ta == run(a) );
+}
+
+TEST_CASE( "synthetic robot timing", "[.][benchmark][synthetic]" )
+{
+    using namespace local_tests::synthetic_robot_tests;
+    const std::size_t T = 200000;
+
+    for (unsigned N : {4u, 8u, 16u, 32u})
+    {
+        robots::Synthetic_Parameters params;
+        params.number_of_joints = N;
+        params.number_of_symmetric_joints = N/4;
+        params.number_of_accels = 2;
+        params.noise = 0.1;
+        robots::Synthetic_Robot robot(params);
+
+        control::Jointcontrol control(robot);
+        control.set_control_parameter(control::get_initial_parameter(robot, {1.0, 0.0, 1.0}, false));
+
+        Stopwatch watch;
+        for (std::size_t t = 0; t < T; ++t) {
+            set_motors(robot, t);
+            robot.execute_cycle();
+        }
+        const double t_robot = watch.get_time_passed_us();
+
+        for (std::size_t t = 0; t < T; ++t) {
+            control.execute_cycle();
+            robot.execute_cycle();
+        }
+        const double t_control = watch.get_time_passed_us();
+
+        sts_msg("%2u joints: %7.0f cycles/s robot only, %7.0f cycles/s with joint control"
+               , N, T / t_robot * 1e6, T / t_control * 1e6);
+    }
+}
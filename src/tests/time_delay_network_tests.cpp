@@ -14,13 +14,13 @@ struct TD_Sensor_Space : public sensor_vector {
     : sensor_vector(3*joints.size() + 1)
     {
         for (robots::Joint_Model const& j : joints)
-            sensors.emplace_back(j.name + "_ang", [&j](){ return j.s_ang; });
+            add_sensor(j.name + "_ang", [&j](){ return j.s_ang; });
         for (robots::Joint_Model const& j : joints)
-            sensors.emplace_back(j.name + "_vel", [&j](){ return j.s_vel; });
+            add_sensor(j.name + "_vel", [&j](){ return j.s_vel; });
         for (robots::Joint_Model const& j : joints)
-            sensors.emplace_back(j.name + "_mot", [&j](){ return j.motor.get_backed(); });
+            add_sensor(j.name + "_mot", [&j](){ return j.motor.get_backed(); });
 
-        sensors.emplace_back("bias", [&](){ return 0.13; });
+        add_sensor("bias", [&](){ return 0.13; });
         assert(sensors.size() == 3*joints.size() + 1);
     }
 };
@@ -75,6 +75,35 @@ TEST_CASE( "FIR Synapse Test" , "[Time Delay Network]")
 }
 
 
+TEST_CASE( "FIR Synapse shared delay line" , "[Time Delay Network]")
+{
+    Test_Robot robot(2,0);
+    robot.set_random_inputs();
+    TD_Sensor_Space inputs{robot.get_joints()};
+
+    const unsigned num_taps = 4;
+    learning::FIR_type_synapse own(inputs.size(), num_taps);
+    learning::FIR_type_synapse line(inputs.size(), num_taps);
+    learning::FIR_type_synapse view(&line), view_of_view(&view);
+
+    REQUIRE( view.is_shared() );
+    REQUIRE( view.size() == own.size() );
+
+    for (unsigned t = 0; t < 10; ++t) {
+        robot.set_random_inputs();
+        inputs.execute_cycle();
+        own .propagate(inputs);
+        line.propagate(inputs);
+        view.propagate(inputs); // no effect, owner shifts
+
+        const std::vector<double> expected(own.get().begin(), own.get().end());
+        REQUIRE( line.get() == expected );
+        REQUIRE( view.get() == expected );
+        REQUIRE( view_of_view.data() == line.data() ); // read in place, no copies
+    }
+}
+
+
 TEST_CASE( "time delay network construction" , "[Time Delay Network]")
 {
     srand(time(0)); // set random seed
@@ -83,7 +112,7 @@ TEST_CASE( "time delay network construction" , "[Time Delay Network]")
     robot.set_random_inputs();
     TD_Sensor_Space inputs{robot.get_joints()};
     const double random_range = 0.1;
-    learning::Timedelay_Network tdn(inputs.size(), inputs.size(), 3, 10, random_range);
+    learning::Timedelay_Network<> tdn(inputs.size(), inputs.size(), 3, 10, random_range);
 
     auto const& outputs = tdn.get_outputs();
     REQUIRE( outputs.size() == inputs.size() );
@@ -125,7 +154,7 @@ TEST_CASE( "time delay network construction" , "[Time Delay Network]")
 
 
     /** check that autoencoder is copyable **/
-    learning::Timedelay_Network tdn2 = tdn;
+    learning::Timedelay_Network<> tdn2 = tdn;
 }
 
 
@@ -140,7 +169,7 @@ TEST_CASE( "time delay network learning", "[Time Delay Network]")
     const unsigned number_of_taps = 10;
 
     const double learning_rate = 0.02;
-    learning::Timedelay_Network tdn(inputs.size(), inputs.size(), 3, number_of_taps, 0.1);
+    learning::Timedelay_Network<> tdn(inputs.size(), inputs.size(), 3, number_of_taps, 0.1);
 
     SECTION( "vector_tanh computes tanh element-wise") {
         std::vector<double> vec = {1.1, -5.0, 10.0};
@@ -209,3 +238,21 @@ TEST_CASE( "time delay network learning", "[Time Delay Network]")
 }} // namespace local_tests
 
 
+
+TEST_CASE( "time delay network with fast tanh", "[Time Delay Network][fast_math]" )
+{
+    srand(2468);
+    learning::Timedelay_Network<> exact(4, 4, 6, 5, 0.1);
+    learning::Timedelay_Network<> fast(exact);
+    fast.set_math_mode(fast_math::Mode::fast);
+
+    for (std::size_t t = 0; t < 1000; ++t) {
+        VectorN x = { sin(0.1*t), cos(0.1*t), sin(0.03*t), 0.5 };
+        exact.propagate_and_shift(x);
+        fast .propagate_and_shift(x);
+        for (std::size_t i = 0; i < x.size(); ++i)
+            REQUIRE( close(exact.get_outputs()[i], fast.get_outputs()[i], 1e-12) );
+        exact.adapt(x, 0.05);
+        fast .adapt(x, 0.05);
+    }
+}